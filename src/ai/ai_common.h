@@ -6,6 +6,7 @@
 #define BATTLESHIP_GAME_AI_COMMON_H
 
 #include "core/game/ship.h"
+#include "utils/fixed_vector.h"
 
 struct ShipPlacementInfo{
   ShipType type;
@@ -18,4 +19,7 @@ struct ShipPlacementInfo{
     head_location(head_location),
     direction(direction){};
 };
+
+// where every ship of a fleet goes
+typedef FixedVector<ShipPlacementInfo, kShipNum> ShipPlacingPlanList;
 #endif //BATTLESHIP_GAME_AI_COMMON_H
@@ -5,44 +5,84 @@
 #ifndef BATTLESHIP_GAME_ATTACK_LOCATION_UNIT_H
 #define BATTLESHIP_GAME_ATTACK_LOCATION_UNIT_H
 
-#include <memory>
-#include <vector>
+#include <string>
 #include "core/game/game_common.h"
 #include "ai/random_unit.h"
 #include "ai/probability_board.h"
+#include "ai/monte_carlo_sampler.h"
+#include "utils/fixed_vector.h"
 
 enum class StrategyAttack{
   kRandom,
   kDFS,
   kProbabilitySimple,
-  kDFSProbability
+  kDFSProbability,
+  kMonteCarlo
 };
 
-class AttackLocationUnit{
+static const std::size_t kStrategyAttackNum = 5;
+
+static std::string StrategyAttackToString(const StrategyAttack strategy){
+  switch(strategy){
+    case StrategyAttack::kRandom:{
+      return "random";
+    }
+    case StrategyAttack::kDFS:{
+      return "dfs";
+    }
+    case StrategyAttack::kProbabilitySimple:{
+      return "probability";
+    }
+    case StrategyAttack::kDFSProbability:{
+      return "dfs_probability";
+    }
+    case StrategyAttack::kMonteCarlo:{
+      return "monte_carlo";
+    }
+    default:{
+      return "unknown";
+    }
+  }
+}
+
+// return false if the name does not match any strategy
+static bool StrategyAttackFromString(const std::string & name, StrategyAttack* strategy){
+  if(name == "random") *strategy = StrategyAttack::kRandom;
+  else if(name == "dfs") *strategy = StrategyAttack::kDFS;
+  else if(name == "probability") *strategy = StrategyAttack::kProbabilitySimple;
+  else if(name == "dfs_probability") *strategy = StrategyAttack::kDFSProbability;
+  else if(name == "monte_carlo") *strategy = StrategyAttack::kMonteCarlo;
+  else return false;
+  return true;
+}
+
+template<typename Rules>
+class BasicAttackLocationUnit{
 public:
-  AttackLocationUnit(ImagineBoard & enemy_board):
+  typedef BasicBitBoard<Rules::kCellNum> BitBoard;
+  typedef BasicImagineBoard<Rules> ImagineBoard;
+  typedef BasicFleetConstraint<Rules> FleetConstraint;
+  typedef BasicProbabilityBoard<Rules> ProbabilityBoard;
+  typedef BasicMonteCarloSampler<Rules> MonteCarloSampler;
+  static const std::size_t kDim = Rules::kDim;
+
+  BasicAttackLocationUnit(ImagineBoard & enemy_board):
     ref_enemy_board_(enemy_board),
     probability_board_(enemy_board){
+    probability_board_.EnableEndgameSolver(EndgameSetting());
   }
 
-  void UpdateProbabilityBoard(){
+  // takes over the state of a unit of the same game, it keeps attacking its own enemy board
+  BasicAttackLocationUnit & operator=(const BasicAttackLocationUnit & other){
+    target_location_stack_ = other.target_location_stack_;
+    probability_board_ = other.probability_board_;
+    monte_carlo_sampler_ = other.monte_carlo_sampler_;
+    return *this;
+  }
 
-#ifdef AI_DEBUG
-    // verify the correctness of partial update algorithm
+  // called once per shot, after the shot is on the enemy board
+  void UpdateProbabilityBoard(){
     probability_board_.UpdateProbabilityByLastAttackLocation();
-    ProbabilityBoard new_prob_board(ref_enemy_board_);
-    for(size_t i = 0; i < kDim * kDim; ++i){
-      Logger(std::to_string(i) + "," + std::to_string(probability_board_.GetProbability(i)) + "->" + std::to_string(new_prob_board.GetProbability(i)));
-      assert(probability_board_.GetProbability(i) == new_prob_board.GetProbability(i));
-    }
-#endif
-
-    // if we use probability strategy for every move,
-    // we can UpdateProbabilityByLastAttackLocation
-    // or else we need to recalculate probability every time
-
-    //probability_board_.UpdateProbabilityByLastAttackLocation();
-    probability_board_.RecalculateProbability();
   }
 
   std::size_t NextAttackLocation(const StrategyAttack & strategy){
@@ -59,6 +99,9 @@ public:
       case StrategyAttack ::kDFSProbability:{
         return NextAttackLocationDFSAndProbability();
       }
+      case StrategyAttack ::kMonteCarlo:{
+        return NextAttackLocationMonteCarlo();
+      }
       default:{
         assert(false);
       }
@@ -72,16 +115,20 @@ private:
   ImagineBoard & ref_enemy_board_;
 
   // for DFS strategy
-  std::vector<size_t> target_location_stack_;
+  // a hit pushes at most four locations and there are at most kDim * kDim hits
+  FixedVector<size_t, 4 * kDim * kDim> target_location_stack_;
 
   // for Probability strategy
   ProbabilityBoard probability_board_;
 
+  // for Monte Carlo strategy
+  MonteCarloSampler monte_carlo_sampler_;
+
   // attack strategies
   std::size_t NextAttackLocationRandom(){
-    auto locations = ref_enemy_board_.GetUnAttackedLocations();
-    size_t rand = RandomUnit::GetRandomSizeT(0, locations.size() - 1);
-    return locations[rand];
+    BitBoard locations = ref_enemy_board_.GetUnAttackedMask();
+    size_t rand = RandomUnit::GetRandomSizeT(0, locations.Count() - 1);
+    return locations.NthSetBit(rand);
   }
 
   // if the last fire success and there is no ship sink
@@ -92,9 +139,10 @@ private:
   // this is essentially a DFS search.
   std::size_t NextAttackLocationDFS(){
     if(ref_enemy_board_.last_attack_success_ && ref_enemy_board_.last_attack_sink_ship_type_ == ShipType::kNotAShip){
-      std::vector<size_t> new_targets = ref_enemy_board_.GetSurroundingFourUnAttacked(ref_enemy_board_.last_attack_location_);
       // append to the end of the stack
-      target_location_stack_.insert(target_location_stack_.end(), new_targets.begin(), new_targets.end());
+      for(size_t location : ref_enemy_board_.GetSurroundingFourUnAttacked(ref_enemy_board_.last_attack_location_)){
+        target_location_stack_.push_back(location);
+      }
     }
 
     while(!target_location_stack_.empty()){
@@ -120,9 +168,10 @@ private:
   // the combination attack of DFS and probability
   std::size_t NextAttackLocationDFSAndProbability(){
     if(ref_enemy_board_.last_attack_success_ && ref_enemy_board_.last_attack_sink_ship_type_ == ShipType::kNotAShip){
-      std::vector<size_t> new_targets = ref_enemy_board_.GetSurroundingFourUnAttacked(ref_enemy_board_.last_attack_location_);
       // append to the end of the stack
-      target_location_stack_.insert(target_location_stack_.end(), new_targets.begin(), new_targets.end());
+      for(size_t location : ref_enemy_board_.GetSurroundingFourUnAttacked(ref_enemy_board_.last_attack_location_)){
+        target_location_stack_.push_back(location);
+      }
     }
 
     while(!target_location_stack_.empty()){
@@ -134,7 +183,30 @@ private:
     return NextAttackLocationProbabilitySimple();
   }
 
+  // Monte Carlo attack
+  // sample whole fleet layouts that agree with every hit, miss and sink so far,
+  // and fire at the un-attacked location the most layouts put a ship on.
+  // falls back to the probability board if no layout made it within the budget.
+  std::size_t NextAttackLocationMonteCarlo(){
+    size_t occupancy[kDim * kDim];
+    size_t samples = monte_carlo_sampler_.Sample(FleetConstraint::FromEnemyBoard(ref_enemy_board_), occupancy);
+
+    size_t highest = 0;
+    FixedVector<size_t, kDim * kDim> highest_locations;
+    ref_enemy_board_.GetUnAttackedMask().ForEach([&](size_t location){
+      if(occupancy[location] > highest){
+        highest = occupancy[location];
+        highest_locations.clear();
+      }
+      if(occupancy[location] == highest && highest > 0) highest_locations.emplace_back(location);
+    });
+
+    if(samples == 0 || highest_locations.empty()) return NextAttackLocationProbabilitySimple();
+    return highest_locations[RandomUnit::GetRandomSizeT(0, highest_locations.size() - 1)];
+  }
 
 };
 
+typedef BasicAttackLocationUnit<ClassicRules> AttackLocationUnit;
+
 #endif //BATTLESHIP_GAME_ATTACK_LOCATION_UNIT_H
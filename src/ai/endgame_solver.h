@@ -0,0 +1,306 @@
+//
+// Exact count of the enemy fleet layouts left, for positions late in a game.
+//
+
+#ifndef BATTLESHIP_GAME_ENDGAME_SOLVER_H
+#define BATTLESHIP_GAME_ENDGAME_SOLVER_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "core/game/game_common.h"
+#include "core/game/bitboard.h"
+#include "ai/fleet_constraint.h"
+#include "utils/fixed_vector.h"
+
+struct EndgameSetting{
+  // solve once the alive types have at most this many fitting placements in total
+  size_t placement_threshold = 60;
+  // give up on a position with more sub-problems than this
+  size_t state_budget = 50000;
+};
+
+// Ships are placed one at a time in a fixed order, the ships of one type at increasing placement
+// indexes so every layout is met once. What is left to place only depends on the locations taken,
+// the ship to place next, the last placement index of its type and how many ships of its type lie
+// fully on hits so far, so that is the key of the transposition table holding the number of
+// layouts completing a sub-problem. A second pass pushes the number of ways to reach every
+// sub-problem forward and adds (ways in) * (layouts out) to the locations of every placement taken.
+// The table lives in a workspace of the thread kept from one solve to the next, so once it has
+// grown to the budget solving allocates nothing.
+template<typename Rules>
+class BasicEndgameSolver{
+public:
+  typedef BasicBitBoard<Rules::kCellNum> BitBoard;
+  typedef BasicPlacementMasks<Rules> PlacementMasks;
+  typedef BasicFleetConstraint<Rules> FleetConstraint;
+  static const std::size_t kDim = Rules::kDim;
+  static const std::size_t kShipNum = Rules::kShipNum;
+
+  explicit BasicEndgameSolver(const EndgameSetting & setting = EndgameSetting()):
+    setting_(setting){
+  }
+
+  const EndgameSetting & GetSetting() const{
+    return setting_;
+  }
+
+  // layouts_per_location[i] = layouts agreeing with the constraint that put a ship on i.
+  // false if the position has more sub-problems than the budget, has no layout at all,
+  // or has more layouts than a double counts exactly.
+  bool Solve(const FleetConstraint & constraint, size_t* layouts_per_location, double* layout_num = nullptr){
+    Prepare(constraint);
+
+    State root;
+    double total = Count(root);
+    if(over_budget_ || total == 0 || total > kMaxExactCount) return false;
+
+    // the forward pass goes through the sub-problems by cursor
+    size_t layer_begin[kShipNum + 2] = {};
+    for(std::uint32_t slot : workspace_->finished){
+      layer_begin[workspace_->slots[slot].state.cursor + 1] += 1;
+    }
+    for(size_t cursor = 0; cursor <= kShipNum; ++cursor){
+      layer_begin[cursor + 1] += layer_begin[cursor];
+    }
+    workspace_->by_cursor.resize(workspace_->finished.size());
+    size_t layer_end[kShipNum + 1];
+    std::memcpy(layer_end, layer_begin, sizeof(layer_end));
+    for(std::uint32_t slot : workspace_->finished){
+      workspace_->by_cursor[layer_end[workspace_->slots[slot].state.cursor]++] = slot;
+    }
+
+    double layouts[kDim * kDim] = {};
+    Find(root)->ways_in = 1;
+    for(size_t cursor = 0; cursor < kShipNum; ++cursor){
+      for(size_t k = layer_begin[cursor]; k < layer_begin[cursor + 1]; ++k){
+        const Slot & slot = workspace_->slots[workspace_->by_cursor[k]];
+        double ways_in = slot.entry.ways_in;
+        if(ways_in == 0) continue;
+        ForEachChild(slot.state, [this, ways_in, &layouts](const BitBoard & mask, const State & child){
+          Entry & entry = *Find(child);
+          if(entry.layouts_out == 0) return;
+          entry.ways_in += ways_in;
+          double through = ways_in * entry.layouts_out;
+          mask.ForEach([through, &layouts](size_t location){
+            layouts[location] += through;
+          });
+        });
+      }
+    }
+
+    for(size_t i = 0; i < kDim * kDim; ++i){
+      layouts_per_location[i] = static_cast<size_t>(layouts[i]);
+    }
+    if(layout_num != nullptr) *layout_num = total;
+    return true;
+  }
+
+private:
+  // every integer up to 2^53 is exact in a double
+  static constexpr double kMaxExactCount = 9007199254740992.0;
+
+  struct State{
+    BitBoard taken;
+    std::uint32_t cursor = 0;
+    // the ship before the cursor is of the same type: its placement index,
+    // and the ships of the type fully on hits so far. 0 otherwise.
+    std::uint32_t last = 0;
+    std::uint32_t on_hits_num = 0;
+
+    bool operator==(const State & other) const{
+      return cursor == other.cursor && last == other.last && on_hits_num == other.on_hits_num && taken == other.taken;
+    }
+  };
+
+  struct StateHash{
+    size_t operator()(const State & state) const{
+      std::uint64_t hash = (static_cast<std::uint64_t>(state.cursor) << 48)
+                           ^ (static_cast<std::uint64_t>(state.last) << 16) ^ state.on_hits_num;
+      for(size_t i = 0; i < BitBoard::kWordNum; ++i){
+        hash = (hash ^ state.taken.GetWord(i)) * 0x9E3779B97F4A7C15ULL;
+        hash ^= hash >> 29;
+      }
+      return static_cast<size_t>(hash);
+    }
+  };
+
+  struct Entry{
+    double layouts_out = 0;
+    double ways_in = 0;
+  };
+
+  struct Candidate{
+    BitBoard mask;
+    bool on_hits;
+  };
+
+  // the table is open addressed and probed linearly. a slot is in use iff it carries the stamp
+  // of the solve, so a new solve empties the table by taking a new stamp.
+  struct Slot{
+    State state;
+    Entry entry;
+    std::uint32_t stamp = 0;
+  };
+
+  struct Workspace{
+    std::vector<Slot> slots;
+    std::uint32_t stamp = 0;
+    // the slots of the sub-problems in the order they were counted, then sorted by cursor
+    std::vector<std::uint32_t> finished;
+    std::vector<std::uint32_t> by_cursor;
+  };
+
+  EndgameSetting setting_;
+
+  FleetConstraint constraint_;
+  // the type of every ship in placing order, and the locations the ships from a cursor on cover
+  ShipType order_[kShipNum];
+  size_t cells_from_[kShipNum + 1];
+  // placements of a type keeping off the misses
+  FixedVector<Candidate, 2 * kDim * kDim> candidates_[kShipTypeNum];
+
+  Workspace* workspace_ = nullptr;
+  bool over_budget_ = false;
+
+  static Workspace & ThreadWorkspace(){
+    thread_local Workspace workspace;
+    return workspace;
+  }
+
+  // make room for the budget and empty the table
+  void ResetWorkspace(){
+    workspace_ = &ThreadWorkspace();
+    size_t slot_num = 1024;
+    while(slot_num < setting_.state_budget * 2) slot_num *= 2;
+    if(workspace_->slots.size() < slot_num){
+      workspace_->slots.assign(slot_num, Slot());
+      workspace_->stamp = 0;
+    }
+    workspace_->stamp += 1;
+    if(workspace_->stamp == 0){
+      // wrapped around, forget the stamps of long ago
+      for(Slot & slot : workspace_->slots){
+        slot.stamp = 0;
+      }
+      workspace_->stamp = 1;
+    }
+    // the sub-problems open on the stack can still finish past the budget
+    workspace_->finished.reserve(setting_.state_budget + kShipNum + 1);
+    workspace_->finished.clear();
+    workspace_->by_cursor.reserve(setting_.state_budget + kShipNum + 1);
+  }
+
+  // the slot holding the state, or the empty slot it would go to
+  size_t Probe(const State & state) const{
+    size_t mask = workspace_->slots.size() - 1;
+    size_t i = StateHash()(state) & mask;
+    while(workspace_->slots[i].stamp == workspace_->stamp && !(workspace_->slots[i].state == state)){
+      i = (i + 1) & mask;
+    }
+    return i;
+  }
+
+  Entry* Find(const State & state){
+    Slot & slot = workspace_->slots[Probe(state)];
+    return slot.stamp == workspace_->stamp ? &slot.entry : nullptr;
+  }
+
+  void Prepare(const FleetConstraint & constraint){
+    const PlacementMasks & masks = PlacementMasks::Get();
+    const Direction directions[2] = {kVertical, kHorisontal};
+    constraint_ = constraint;
+
+    size_t cursor = 0;
+    for(ShipType type : GetShipTypeList()){
+      for(size_t i = 0; i < Rules::GetNumFromType(type); ++i){
+        order_[cursor] = type;
+        cursor += 1;
+      }
+      candidates_[type].clear();
+      for(Direction direction : directions){
+        masks.LegalHeads(type, direction).ForEach([&](size_t head){
+          const BitBoard & mask = masks.Mask(type, head, direction);
+          if(mask.Intersects(constraint.missed)) return;
+          Candidate candidate;
+          candidate.mask = mask;
+          candidate.on_hits = !mask.AndNot(constraint.hits).Any();
+          candidates_[type].push_back(candidate);
+        });
+      }
+    }
+    cells_from_[kShipNum] = 0;
+    for(size_t i = kShipNum; i-- > 0;){
+      cells_from_[i] = cells_from_[i + 1] + GetSizeFromType(order_[i]);
+    }
+
+    ResetWorkspace();
+    over_budget_ = false;
+  }
+
+  // f(mask, child) for every placement of the ship at the cursor that can still lead to a layout
+  template<typename F>
+  void ForEachChild(const State & state, F f) const{
+    ShipType type = order_[state.cursor];
+    bool same_as_last = state.cursor > 0 && order_[state.cursor - 1] == type;
+    size_t same_after = 0;
+    for(size_t i = state.cursor + 1; i < kShipNum && order_[i] == type; ++i){
+      same_after += 1;
+    }
+
+    const FixedVector<Candidate, 2 * kDim * kDim> & candidates = candidates_[type];
+    for(size_t index = same_as_last ? state.last + 1 : 0; index < candidates.size(); ++index){
+      const Candidate & candidate = candidates[index];
+      if(candidate.mask.Intersects(state.taken)) continue;
+
+      // a ship fully on hits is a sunk one, and the ships of the type left have to make up the rest
+      size_t on_hits_num = (same_as_last ? state.on_hits_num : 0) + (candidate.on_hits ? 1 : 0);
+      if(on_hits_num > constraint_.sunk_num[type]) continue;
+      if(constraint_.sunk_num[type] - on_hits_num > same_after) continue;
+
+      State child;
+      child.taken = state.taken | candidate.mask;
+      child.cursor = state.cursor + 1;
+      if(same_after > 0){
+        child.last = static_cast<std::uint32_t>(index);
+        child.on_hits_num = static_cast<std::uint32_t>(on_hits_num);
+      }
+      // the ships left have to cover every hit left
+      if(constraint_.hits.AndNot(child.taken).Count() > cells_from_[child.cursor]) continue;
+      f(candidate.mask, child);
+    }
+  }
+
+  double Count(const State & state){
+    Entry* found = Find(state);
+    if(found != nullptr) return found->layouts_out;
+    if(workspace_->finished.size() >= setting_.state_budget){
+      over_budget_ = true;
+      return 0;
+    }
+
+    double layouts_out = 0;
+    if(state.cursor == kShipNum){
+      layouts_out = constraint_.hits.AndNot(state.taken).Any() ? 0 : 1;
+    }else{
+      ForEachChild(state, [this, &layouts_out](const BitBoard &, const State & child){
+        layouts_out += Count(child);
+      });
+    }
+    if(over_budget_) return 0;
+
+    // the children are in by now, and an insert moves no other slot
+    size_t i = Probe(state);
+    Slot & slot = workspace_->slots[i];
+    slot.state = state;
+    slot.entry = Entry();
+    slot.entry.layouts_out = layouts_out;
+    slot.stamp = workspace_->stamp;
+    workspace_->finished.push_back(static_cast<std::uint32_t>(i));
+    return layouts_out;
+  }
+};
+
+typedef BasicEndgameSolver<ClassicRules> EndgameSolver;
+
+#endif //BATTLESHIP_GAME_ENDGAME_SOLVER_H
@@ -0,0 +1,36 @@
+//
+// What every enemy fleet layout has to agree with, as seen on the enemy board.
+//
+
+#ifndef BATTLESHIP_GAME_FLEET_CONSTRAINT_H
+#define BATTLESHIP_GAME_FLEET_CONSTRAINT_H
+
+#include "core/game/game_common.h"
+#include "core/game/bitboard.h"
+#include "core/game/imagine_board.h"
+
+// A layout covers every hit, keeps off every miss, and has exactly the sunk number of ships
+// of every type lying fully on hits (a ship fully on hits is a sunk ship and the other way round).
+// Copied off the enemy board, so whoever works on it shares nothing with the game.
+template<typename Rules>
+struct BasicFleetConstraint{
+  typedef BasicBitBoard<Rules::kCellNum> BitBoard;
+
+  BitBoard hits;
+  BitBoard missed;
+  size_t sunk_num[kShipTypeNum];
+
+  static BasicFleetConstraint FromEnemyBoard(BasicImagineBoard<Rules> & enemy_board){
+    BasicFleetConstraint constraint;
+    constraint.hits = enemy_board.GetHitMask();
+    constraint.missed = enemy_board.GetMissedMask();
+    for(ShipType type : GetShipTypeList()){
+      constraint.sunk_num[type] = Rules::GetNumFromType(type) - enemy_board.GetAliveShipNumber(type);
+    }
+    return constraint;
+  }
+};
+
+typedef BasicFleetConstraint<ClassicRules> FleetConstraint;
+
+#endif //BATTLESHIP_GAME_FLEET_CONSTRAINT_H
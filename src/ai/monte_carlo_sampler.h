@@ -0,0 +1,248 @@
+//
+// Samples whole enemy fleet layouts that agree with everything seen on the enemy board.
+//
+
+#ifndef BATTLESHIP_GAME_MONTE_CARLO_SAMPLER_H
+#define BATTLESHIP_GAME_MONTE_CARLO_SAMPLER_H
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include "core/game/game_common.h"
+#include "core/game/bitboard.h"
+#include "ai/fleet_constraint.h"
+#include "ai/random_unit.h"
+#include "utils/thread_pool.h"
+
+struct MonteCarloSetting{
+  // wall time one attack decision may spend sampling
+  std::chrono::microseconds budget = std::chrono::microseconds(1000);
+  // draws every batch makes even past the budget, so a busy pool still decides on something
+  size_t min_draws_per_batch = 16;
+  // 0 means one batch per worker of the pool
+  size_t batch_num = 0;
+};
+
+// one complete fleet
+template<typename Rules>
+struct BasicSampledLayout{
+  typedef BasicBitBoard<Rules::kCellNum> BitBoard;
+  static const std::size_t kShipNum = Rules::kShipNum;
+
+  size_t ship_num = 0;
+  ShipType types[kShipNum];
+  BitBoard masks[kShipNum];
+  BitBoard occupied;
+
+  void Place(ShipType type, const BitBoard & mask){
+    types[ship_num] = type;
+    masks[ship_num] = mask;
+    ship_num += 1;
+    occupied |= mask;
+  }
+};
+
+typedef BasicSampledLayout<ClassicRules> SampledLayout;
+
+// shared by the samplers of every rules, the batches of concurrent decisions just queue up
+struct MonteCarloPool{
+  static ThreadPool & Get(){
+    static ThreadPool pool;
+    return pool;
+  }
+};
+
+// Draws layouts that agree with a FleetConstraint. Unlike the probability board,
+// ships of a layout don't overlap and hits have to be explained.
+template<typename Rules>
+class BasicMonteCarloSampler{
+public:
+  typedef BasicBitBoard<Rules::kCellNum> BitBoard;
+  typedef BasicPlacementMasks<Rules> PlacementMasks;
+  typedef BasicFleetConstraint<Rules> FleetConstraint;
+  typedef BasicSampledLayout<Rules> SampledLayout;
+  static const std::size_t kDim = Rules::kDim;
+  static const std::size_t kShipNum = Rules::kShipNum;
+
+  explicit BasicMonteCarloSampler(const MonteCarloSetting & setting = MonteCarloSetting()):
+    setting_(setting){
+  }
+
+  // draw layouts on the pool until the budget runs out,
+  // occupancy[i] counts the layouts with a ship on i. returns the number of layouts.
+  size_t Sample(const FleetConstraint & constraint, size_t* occupancy) const{
+    ThreadPool & pool = MonteCarloPool::Get();
+    size_t batch_num = setting_.batch_num > 0 ? setting_.batch_num : pool.GetThreadNum();
+    std::unique_ptr<size_t[]> up_batch_occupancy(new size_t[batch_num * kDim * kDim]());
+    std::unique_ptr<size_t[]> up_batch_samples(new size_t[batch_num]());
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + setting_.budget;
+
+    {
+      TaskGroup group(pool);
+      for(size_t b = 0; b < batch_num; ++b){
+        size_t* batch_occupancy = up_batch_occupancy.get() + b * kDim * kDim;
+        size_t* batch_samples = up_batch_samples.get() + b;
+        size_t min_draws = setting_.min_draws_per_batch;
+        // batches draw from generators seeded by the caller's, so a seeded game stays seeded
+        std::uint64_t seed = RandomUnit::Engine()();
+        group.Submit([&constraint, deadline, min_draws, seed, batch_occupancy, batch_samples](){
+          *batch_samples = RunBatch(constraint, deadline, min_draws, seed, batch_occupancy);
+        });
+      }
+      group.Wait();
+    }
+
+    size_t samples = 0;
+    std::memset(occupancy, 0, sizeof(size_t) * kDim * kDim);
+    for(size_t b = 0; b < batch_num; ++b){
+      samples += up_batch_samples[b];
+      for(size_t i = 0; i < kDim * kDim; ++i){
+        occupancy[i] += up_batch_occupancy[b * kDim * kDim + i];
+      }
+    }
+    return samples;
+  }
+
+  // Draw one layout, false if the draw is rejected.
+  // First the hits are explained: the lowest uncovered hit tries the placements of the ships left
+  // that cover it in random order, backtracking out of dead ends, until no hit is left.
+  // Then the rest of the fleet, longest first, picks uniformly among the placements on free
+  // locations; like PlaceOneType, a draw that runs out of spots there is thrown away.
+  template<typename Engine>
+  static bool SampleLayout(const FleetConstraint & constraint, Engine & engine, SampledLayout* layout){
+    const PlacementMasks & masks = PlacementMasks::Get();
+    const Direction directions[2] = {kVertical, kHorisontal};
+    *layout = SampledLayout();
+    size_t remaining[kShipTypeNum];
+    size_t on_hits_num[kShipTypeNum];
+    for(ShipType type : GetShipTypeList()){
+      remaining[type] = Rules::GetNumFromType(type);
+      on_hits_num[type] = 0;
+    }
+
+    size_t node_budget = kCoverNodeBudget;
+    if(!CoverHits(constraint, constraint.hits, engine, layout, remaining, on_hits_num, &node_budget)) return false;
+
+    for(size_t type = 0; type < kShipTypeNum; ++type){
+      size_t size = GetSizeFromType(static_cast<ShipType>(type));
+      for(; remaining[type] > 0; --remaining[type]){
+        BitBoard blocked = constraint.missed | layout->occupied;
+        BitBoard fit_heads[2];
+        size_t fit_num = 0;
+        for(Direction direction : directions){
+          size_t step = direction == kVertical ? kDim : 1;
+          BitBoard blocked_heads;
+          for(size_t i = 0; i < size; ++i){
+            blocked_heads |= blocked.ShiftTowardsLow(i * step);
+          }
+          fit_heads[DirectionIndex(direction)] = masks.LegalHeads(static_cast<ShipType>(type), direction).AndNot(blocked_heads);
+          fit_num += fit_heads[DirectionIndex(direction)].Count();
+        }
+        if(fit_num == 0) return false;
+
+        size_t pick = std::uniform_int_distribution<size_t>(0, fit_num - 1)(engine);
+        Direction direction = kVertical;
+        size_t vertical_num = fit_heads[DirectionIndex(kVertical)].Count();
+        if(pick >= vertical_num){
+          direction = kHorisontal;
+          pick -= vertical_num;
+        }
+        size_t head = fit_heads[DirectionIndex(direction)].NthSetBit(pick);
+        layout->Place(static_cast<ShipType>(type), masks.Mask(static_cast<ShipType>(type), head, direction));
+      }
+    }
+    return true;
+  }
+
+private:
+  // placements CoverHits() may try for one draw before giving up on it
+  static const size_t kCoverNodeBudget = 256;
+
+  MonteCarloSetting setting_;
+
+  // Cover the lowest uncovered hit with a ship left, then the rest recursively.
+  // A ship lying fully on hits is a sunk one, any other ship is alive, so a placement is only tried
+  // if its type can still end up with exactly the sunk number of ships fully on hits.
+  template<typename Engine>
+  static bool CoverHits(const FleetConstraint & constraint, const BitBoard & uncovered, Engine & engine,
+                        SampledLayout* layout, size_t* remaining, size_t* on_hits_num, size_t* node_budget){
+    if(!uncovered.Any()){
+      for(size_t type = 0; type < kShipTypeNum; ++type){
+        if(on_hits_num[type] != constraint.sunk_num[type]) return false;
+      }
+      return true;
+    }
+
+    const PlacementMasks & masks = PlacementMasks::Get();
+    const Direction directions[2] = {kVertical, kHorisontal};
+    size_t target = uncovered.NthSetBit(0);
+    BitBoard blocked = constraint.missed | layout->occupied;
+
+    const BitBoard* candidates[kShipTypeNum * 2 * 5];
+    ShipType candidate_types[kShipTypeNum * 2 * 5];
+    size_t candidate_num = 0;
+    for(size_t type = 0; type < kShipTypeNum; ++type){
+      if(remaining[type] == 0) continue;
+      size_t size = GetSizeFromType(static_cast<ShipType>(type));
+      size_t sunk_left = constraint.sunk_num[type] - on_hits_num[type];
+      for(Direction direction : directions){
+        size_t step = direction == kVertical ? kDim : 1;
+        for(size_t i = 0; i < size && i * step <= target; ++i){
+          size_t head = target - i * step;
+          if(!masks.InBound(static_cast<ShipType>(type), head, direction)) continue;
+          const BitBoard & mask = masks.Mask(static_cast<ShipType>(type), head, direction);
+          if(!mask.Test(target) || mask.Intersects(blocked)) continue;
+          bool sunk = !mask.AndNot(constraint.hits).Any();
+          // a sunk one needs room in the sunk number, an alive one must leave enough ships to sink
+          if(sunk ? sunk_left == 0 : remaining[type] - 1 < sunk_left) continue;
+          candidates[candidate_num] = &mask;
+          candidate_types[candidate_num] = static_cast<ShipType>(type);
+          candidate_num += 1;
+        }
+      }
+    }
+
+    // try the candidates in random order
+    SampledLayout before = *layout;
+    for(size_t n = candidate_num; n > 0; --n){
+      if(*node_budget == 0) return false;
+      *node_budget -= 1;
+
+      size_t pick = std::uniform_int_distribution<size_t>(0, n - 1)(engine);
+      const BitBoard & mask = *candidates[pick];
+      ShipType type = candidate_types[pick];
+      candidates[pick] = candidates[n - 1];
+      candidate_types[pick] = candidate_types[n - 1];
+
+      bool sunk = !mask.AndNot(constraint.hits).Any();
+      layout->Place(type, mask);
+      remaining[type] -= 1;
+      if(sunk) on_hits_num[type] += 1;
+      if(CoverHits(constraint, uncovered.AndNot(mask), engine, layout, remaining, on_hits_num, node_budget)) return true;
+      *layout = before;
+      remaining[type] += 1;
+      if(sunk) on_hits_num[type] -= 1;
+    }
+    return false;
+  }
+
+  static size_t RunBatch(const FleetConstraint & constraint, std::chrono::steady_clock::time_point deadline,
+                         size_t min_draws, std::uint64_t seed, size_t* occupancy){
+    Xoshiro256 engine(seed);
+    SampledLayout layout;
+    size_t samples = 0;
+    for(size_t draws = 0; draws < min_draws || std::chrono::steady_clock::now() < deadline; ++draws){
+      if(!SampleLayout(constraint, engine, &layout)) continue;
+      samples += 1;
+      layout.occupied.ForEach([occupancy](size_t location){
+        occupancy[location] += 1;
+      });
+    }
+    return samples;
+  }
+};
+
+typedef BasicMonteCarloSampler<ClassicRules> MonteCarloSampler;
+
+#endif //BATTLESHIP_GAME_MONTE_CARLO_SAMPLER_H
@@ -5,20 +5,48 @@
 #ifndef BATTLESHIP_GAME_PROBABILITY_BOARD_H
 #define BATTLESHIP_GAME_PROBABILITY_BOARD_H
 
-#include <vector>
 #include "core/game/game_common.h"
 #include "core/game/imagine_board.h"
 #include "ai/ai_common.h"
-
-class ProbabilityBoard{
+#include "ai/probability_kernel.h"
+#include "ai/random_unit.h"
+#include "ai/fleet_constraint.h"
+#include "ai/endgame_solver.h"
+#include "utils/fixed_vector.h"
+
+template<typename Rules>
+class BasicProbabilityBoard{
 public:
-  ProbabilityBoard(ImagineBoard& ref_enemy_board):
+  typedef BasicBitBoard<Rules::kCellNum> BitBoard;
+  typedef BasicPlacementMasks<Rules> PlacementMasks;
+  typedef BasicImagineBoard<Rules> ImagineBoard;
+  typedef BasicFleetConstraint<Rules> FleetConstraint;
+  typedef BasicEndgameSolver<Rules> EndgameSolver;
+  typedef BasicProbabilityKernel<Rules> ProbabilityKernel;
+  static const std::size_t kDim = Rules::kDim;
+
+  BasicProbabilityBoard(ImagineBoard& ref_enemy_board):
     ref_enemy_board_(ref_enemy_board){
     std::memset(probability_board_, 0, sizeof(size_t) * kDim * kDim);
     InitProbability();
   }
 
-  size_t GetProbability(size_t location){
+  // takes over the state of a board of the same game, it keeps following its own enemy board
+  BasicProbabilityBoard & operator=(const BasicProbabilityBoard & other){
+    std::memcpy(probability_board_, other.probability_board_, sizeof(probability_board_));
+    std::memcpy(miss_count_, other.miss_count_, sizeof(miss_count_));
+    std::memcpy(coverage_, other.coverage_, sizeof(coverage_));
+    std::memcpy(fit_num_, other.fit_num_, sizeof(fit_num_));
+    seen_missed_ = other.seen_missed_;
+    use_endgame_solver_ = other.use_endgame_solver_;
+    endgame_solver_ = other.endgame_solver_;
+    highest_probability_ = other.highest_probability_;
+    lowest_probability_ = other.lowest_probability_;
+    highest_probability_locations_ = other.highest_probability_locations_;
+    return *this;
+  }
+
+  size_t GetProbability(size_t location) const{
     return probability_board_[location];
   }
 
@@ -41,10 +69,28 @@ public:
 
   // recalculate probability of the entire board
   void RecalculateProbability(){
+    size_t alive_num[kShipTypeNum];
+    for(ShipType type : GetShipTypeList()){
+      alive_num[type] = ref_enemy_board_.GetAliveShipNumber(type);
+    }
+    ProbabilityKernel::Accumulate(ref_enemy_board_.GetMissedMask(), alive_num, probability_board_);
+    ResetPlacementCounts();
+
+    RemoveProbabilityAttackedLocations();
+    if(use_endgame_solver_) TrySolveEndgame();
+    UpdateStats();
+    for(auto loca : highest_probability_locations_){
+      LogProbability(loca, highest_probability_);
+    }
+
+  }
+
+  // recalculate by trying every ship at every location in every direction,
+  // the reference RecalculateProbability() has to match bit by bit
+  void RecalculateProbabilityNaive(){
     std::memset(probability_board_, 0, sizeof(size_t) * kDim * kDim);
     // TODO: iterate through directions can be further simplified
-    std::vector<ShipType> types = GetShipTypeList();
-    for(ShipType type : types){
+    for(ShipType type : GetShipTypeList()){
       if(ref_enemy_board_.GetAliveShipNumber(type) > 0){
         for(size_t i = 0; i < kDim * kDim; ++i){
           if(ref_enemy_board_.DoesShipFit(type, i, Direction::kVertical)){
@@ -56,80 +102,71 @@ public:
         }
       }
     }
+    ResetPlacementCounts();
 
     RemoveProbabilityAttackedLocations();
     UpdateStats();
-    for(auto loca : highest_probability_locations_){
-      Logger(std::to_string(loca) + "," + std::to_string(highest_probability_));
-    }
-
   }
 
-  // Update probabilities caused by changing of one location
+  // Bring the probabilities up to date with the shots since the last update.
+  // A hit changes no placement, a miss blocks the placements covering it, a sink lowers the
+  // weight of its type; only the blocked placements are touched, the enemy board is only read.
+  // Ends up exactly where RecalculateProbability() would.
   void UpdateProbabilityByLastAttackLocation(){
-    Logger("last attacked: " + std::to_string(ref_enemy_board_.last_attack_location_));
-    Logger("last attacked: " + std::to_string(ref_enemy_board_.last_attack_success_));
-    Logger("last attacked: " + std::to_string(ref_enemy_board_.last_attack_sink_ship_type_));
-
-    size_t location = ref_enemy_board_.last_attack_location_;
-    unsigned char & ref_state = ref_enemy_board_.states_[location];
-    // we update probabilities surround the last attack position
-    // iff the last movement is not success
-    if(!ref_enemy_board_.last_attack_success_){
-      std::vector<ShipPlacementInfo> placements = GetImpactedPlacement(location);
-
-      //Logger("last attacked: " + std::to_string(location));
-      Logger("impacted placements:");
-
-
-      for(auto placement : placements){
-        Logger("type: " + std::to_string(placement.type) + ", location: " + std::to_string(placement.head_location) + ", direction: " + std::to_string(placement.direction));
-
-        //TODO: this direct mofication of enemy board has potential HUGE multi-threading issue
-        // turn ATTACKED off
-        ref_state &= ~ImagineBoard::ATTACKED;
-        bool old_fit = ref_enemy_board_.DoesShipFit(placement.type, placement.head_location, placement.direction);
-        // turn ATTACKED back on
-        ref_state |= ImagineBoard::ATTACKED;
-        bool new_fit = ref_enemy_board_.DoesShipFit(placement.type, placement.head_location, placement.direction);
-        if(old_fit && !new_fit){
-          DecrementProbablity(placement.type, placement.head_location, placement.direction, ref_enemy_board_.GetAliveShipNumber(placement.type));
-        }
-      }
-    }
-
-    // we update probabilities of whole board,
-    // iff the last movement is success and we sink a ship
-    ShipType last_attack_sink_type = ref_enemy_board_.last_attack_sink_ship_type_;
-    if(ref_enemy_board_.last_attack_success_ && last_attack_sink_type != ShipType::kNotAShip){
-      // TODO: need a better way to update here
-      RecalculateProbability();
-      /*
-      for(size_t i = 0; i < kDim * kDim; ++i){
-        if(ref_enemy_board_.DoesShipFit(last_attack_sink_type, i, Direction::kVertical)){
-          DecrementProbablity(last_attack_sink_type, i, Direction::kVertical, 1);
-        }
-        if(ref_enemy_board_.DoesShipFit(last_attack_sink_type, i, Direction::kHorisontal)){
-          DecrementProbablity(last_attack_sink_type, i, Direction::kHorisontal, 1);
+    const PlacementMasks & masks = PlacementMasks::Get();
+    const Direction directions[2] = {kVertical, kHorisontal};
+    BitBoard missed = ref_enemy_board_.GetMissedMask();
+
+    // a placement leaves the coverage of its type with its first miss
+    missed.AndNot(seen_missed_).ForEach([this, &masks, &directions](size_t location){
+      for(size_t type = 0; type < kShipTypeNum; ++type){
+        size_t size = GetSizeFromType(static_cast<ShipType>(type));
+        for(Direction direction : directions){
+          size_t d = DirectionIndex(direction);
+          size_t step = direction == kVertical ? kDim : 1;
+          for(size_t i = 0; i < size && i * step <= location; ++i){
+            size_t head = location - i * step;
+            if(!masks.InBound(static_cast<ShipType>(type), head, direction)) continue;
+            const BitBoard & mask = masks.Mask(static_cast<ShipType>(type), head, direction);
+            if(!mask.Test(location)) continue;
+
+            miss_count_[type][head][d] += 1;
+            if(miss_count_[type][head][d] > 1) continue;
+            fit_num_[type] -= 1;
+            mask.ForEach([this, type](size_t covered){
+              coverage_[type][covered] -= 1;
+            });
+          }
         }
       }
-       */
-    }
+    });
+    seen_missed_ = missed;
 
-    // TODO: need a better way to remove probability for one movement
-    //RemoveProbabilityLastAttackedLocation()
-    RemoveProbabilityAttackedLocations();
+    ComposeProbability();
+    if(use_endgame_solver_) TrySolveEndgame();
     UpdateStats();
-
     for(auto loca : highest_probability_locations_){
-      Logger(std::to_string(loca) + "," + std::to_string(highest_probability_));
+      LogProbability(loca, highest_probability_);
     }
+  }
+
+  // Once few enough placements fit, replace the counts by the number of whole fleet layouts
+  // with a ship on every location, as counted by the endgame solver.
+  void EnableEndgameSolver(const EndgameSetting & setting){
+    use_endgame_solver_ = true;
+    endgame_solver_ = EndgameSolver(setting);
+  }
 
+  // layouts_per_location[i]: fleet layouts agreeing with the enemy board that put a ship on i
+  void SetExactProbability(const size_t* layouts_per_location){
+    for(size_t i = 0; i < kDim * kDim; ++i){
+      probability_board_[i] = ref_enemy_board_.LocationAttacked(i) ? 0 : layouts_per_location[i];
+    }
   }
 
   void RemoveProbabilityAttackedLocations(){
     for(size_t i = 0; i < kDim * kDim; ++i){
-      if(ref_enemy_board_.states_[i] & ImagineBoard::ATTACKED){
+      if(ref_enemy_board_.LocationAttacked(i)){
         probability_board_[i] = 0;
       }
     }
@@ -144,10 +181,22 @@ private:
   ImagineBoard& ref_enemy_board_;
   size_t probability_board_[kDim * kDim];
 
+  // what the incremental update works from, as of the last update
+  // miss_count_: missed locations under every placement, the placement fits iff it is 0
+  // coverage_: fitting placements of a type covering a location
+  // fit_num_: fitting placements of a type
+  unsigned char miss_count_[kShipTypeNum][kDim * kDim][2];
+  std::uint16_t coverage_[kShipTypeNum][kDim * kDim];
+  size_t fit_num_[kShipTypeNum];
+  BitBoard seen_missed_;
+
+  bool use_endgame_solver_ = false;
+  EndgameSolver endgame_solver_;
+
   // prob board stats
   size_t highest_probability_ = 0;
   size_t lowest_probability_ = 0;
-  std::vector<size_t> highest_probability_locations_;
+  FixedVector<size_t, kDim * kDim> highest_probability_locations_;
 
 
   void IncrementProbablity(ShipType type, size_t head_location, Direction direction, size_t increment){
@@ -186,39 +235,6 @@ private:
 
   }
 
-  void DecrementProbablity(ShipType type, size_t head_location, Direction direction, size_t decrement){
-    assert(head_location < kDim * kDim);
-
-    // TODO: possible code duplication
-    std::size_t size = GetSizeFromType(type);
-    std::size_t row = head_location / kDim;
-    std::size_t col = head_location % kDim;
-
-    switch(direction){
-      case kVertical:{
-        // boundary check
-        assert(row + size - 1 < kDim);
-        for(std::size_t i = 0; i < size; i++){
-          probability_board_[head_location + i * kDim] -= decrement;
-        }
-        break;
-      }
-      case kHorisontal:{
-        // boundary check
-        assert(col + size - 1 < kDim);
-        for(std::size_t i = 0; i < size; i++){
-          probability_board_[head_location + i] -= decrement;
-        }
-        break;
-      }
-      default:{
-        assert(false);
-      }
-    }
-
-  }
-
-
   void UpdateStats(){
     lowest_probability_ = probability_board_[0];
     highest_probability_ = 0; // can't be probability_board_[0]
@@ -239,72 +255,64 @@ private:
     }
   }
 
-  std::vector<ShipPlacementInfo> GetImpactedPlacement(size_t location){
-    std::vector<ShipPlacementInfo> res;
-    // TODO: iterate through directions can be further simplified
-
-    std::vector<ShipType> types = GetShipTypeList();
-    for(ShipType type : types){
-      for(size_t i = 0; i < GetSizeFromType(type); ++i){
-        size_t candidate = location - i;
-        if(!OutOfBound(type,candidate,Direction::kHorisontal)
-           && IsSameLine(candidate, location, Direction::kHorisontal)){
-          res.emplace_back(ShipPlacementInfo(type, candidate, Direction::kHorisontal));
-        }
-
-        candidate = location - i * kDim;
-        if(!OutOfBound(type,candidate,Direction::kVertical)
-           && IsSameLine(candidate, location, Direction::kVertical)){
-          res.emplace_back(ShipPlacementInfo(type, candidate, Direction::kVertical));
-        }
+  // count the misses under every placement and the fitting placements over every location
+  void ResetPlacementCounts(){
+    const PlacementMasks & masks = PlacementMasks::Get();
+    const Direction directions[2] = {kVertical, kHorisontal};
+    BitBoard missed = ref_enemy_board_.GetMissedMask();
+
+    std::memset(miss_count_, 0, sizeof(miss_count_));
+    std::memset(coverage_, 0, sizeof(coverage_));
+    std::memset(fit_num_, 0, sizeof(fit_num_));
+    for(size_t type = 0; type < kShipTypeNum; ++type){
+      for(Direction direction : directions){
+        size_t d = DirectionIndex(direction);
+        masks.LegalHeads(static_cast<ShipType>(type), direction).ForEach([&](size_t head){
+          const BitBoard & mask = masks.Mask(static_cast<ShipType>(type), head, direction);
+          miss_count_[type][head][d] = static_cast<unsigned char>((mask & missed).Count());
+          if(miss_count_[type][head][d] > 0) return;
+          fit_num_[type] += 1;
+          mask.ForEach([this, type](size_t covered){
+            coverage_[type][covered] += 1;
+          });
+        });
       }
     }
-
-    return res;
+    seen_missed_ = missed;
   }
 
-  bool IsSameLine(size_t head_location_a, size_t head_location_b, Direction direction){
-    std::size_t row_a = head_location_a / kDim;
-    std::size_t col_a = head_location_a % kDim;
-    std::size_t row_b = head_location_b / kDim;
-    std::size_t col_b = head_location_b % kDim;
-    switch(direction){
-      case kVertical:{
-        return col_a == col_b;
-      }
-      case kHorisontal:{
-        return row_a == row_b;
-      }
-      default:{
-        assert(false);
+  // probability of an un-attacked location: the fitting placements covering it,
+  // weighted by the alive ships of their type
+  void ComposeProbability(){
+    size_t alive_num[kShipTypeNum];
+    for(size_t type = 0; type < kShipTypeNum; ++type){
+      alive_num[type] = ref_enemy_board_.GetAliveShipNumber(static_cast<ShipType>(type));
+    }
+    for(size_t i = 0; i < kDim * kDim; ++i){
+      size_t probability = 0;
+      for(size_t type = 0; type < kShipTypeNum; ++type){
+        probability += alive_num[type] * coverage_[type][i];
       }
+      probability_board_[i] = probability;
     }
+    RemoveProbabilityAttackedLocations();
   }
 
+  void TrySolveEndgame(){
+    size_t placement_num = 0;
+    for(size_t type = 0; type < kShipTypeNum; ++type){
+      if(ref_enemy_board_.GetAliveShipNumber(static_cast<ShipType>(type)) > 0) placement_num += fit_num_[type];
+    }
+    if(placement_num > endgame_solver_.GetSetting().placement_threshold) return;
 
-  // TODO: this boundary check function can be applied to game board, and imagine_board etc.
-  bool OutOfBound(ShipType type, size_t head_location, Direction direction){
-    if(head_location >= kDim * kDim) return true;
-
-    std::size_t size = GetSizeFromType(type);
-    std::size_t row = head_location / kDim;
-    std::size_t col = head_location % kDim;
-
-    switch(direction){
-      case kVertical:{
-        if(row + size - 1 < kDim) return false;
-        else return true;
-      }
-      case kHorisontal:{
-        if(col + size - 1 < kDim) return false;
-        else return true;
-      }
-      default:{
-        assert(false);
-      }
+    size_t layouts_per_location[kDim * kDim];
+    if(endgame_solver_.Solve(FleetConstraint::FromEnemyBoard(ref_enemy_board_), layouts_per_location)){
+      SetExactProbability(layouts_per_location);
     }
   }
 
 };
 
+typedef BasicProbabilityBoard<ClassicRules> ProbabilityBoard;
+
 #endif //BATTLESHIP_GAME_PROBABILITY_BOARD_H
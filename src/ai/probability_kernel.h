@@ -0,0 +1,230 @@
+//
+// Table driven kernel that builds the probability (placement density) histogram.
+//
+
+#ifndef BATTLESHIP_GAME_PROBABILITY_KERNEL_H
+#define BATTLESHIP_GAME_PROBABILITY_KERNEL_H
+
+#include <cstdint>
+#include <cstring>
+#include "core/game/game_common.h"
+#include "core/game/bitboard.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// For every ship type and direction, the heads where the ship fits are the legal heads
+// whose ship cells hold no miss, i.e. legal & ~(miss >> 0 | miss >> step | ...),
+// the same shifted misses serve every type.
+// A placement with head h covers h + i * step for every i < size, so per direction
+// cells[i][h] = sum of the weights of the fitting types longer than i, and a location j
+// gets cells[i][j - i * step] for every i. That is counting every fitting placement
+// one by one, without touching a placement: 2 directions * 5 shifted 16-bit lane rows.
+template<typename Rules>
+class BasicProbabilityKernel{
+public:
+  typedef BasicBitBoard<Rules::kCellNum> BitBoard;
+  typedef BasicPlacementMasks<Rules> PlacementMasks;
+  static const std::size_t kDim = Rules::kDim;
+  static const std::size_t kLaneNum = BitBoard::kWordNum * BitBoard::kWordBits;
+
+  // probability[i] = sum of alive_num[type] over every placement of an alive type that
+  // covers i and no missed location. writes all kDim * kDim entries.
+  static void Accumulate(const BitBoard & missed, const std::size_t* alive_num, std::size_t* probability){
+#if defined(__AVX2__) || defined(__SSE2__)
+    AccumulateSimd(missed, alive_num, probability);
+#else
+    AccumulateScalar(missed, alive_num, probability);
+#endif
+  }
+
+  static void AccumulateScalar(const BitBoard & missed, const std::size_t* alive_num, std::size_t* probability){
+    FitHeads fit;
+    fit.Build(missed, alive_num);
+
+    std::uint16_t cells[2][kMaxShipSize][kPad + kLaneNum];
+    std::memset(cells, 0, sizeof(cells));
+    for(std::size_t d = 0; d < 2; ++d){
+      for(std::size_t t = 0; t < fit.type_num[d]; ++t){
+        std::uint16_t weight = fit.weight[d][t];
+        std::size_t size = fit.size[d][t];
+        fit.heads[d][t].ForEach([&cells, d, weight, size](std::size_t head){
+          for(std::size_t i = 0; i < size; ++i){
+            cells[d][i][kPad + head] += weight;
+          }
+        });
+      }
+    }
+
+    for(std::size_t j = 0; j < kDim * kDim; ++j){
+      std::size_t sum = 0;
+      for(std::size_t i = 0; i < kMaxShipSize; ++i){
+        sum += cells[DirectionIndex(kVertical)][i][kPad + j - i * kDim];
+        sum += cells[DirectionIndex(kHorisontal)][i][kPad + j - i];
+      }
+      probability[j] = sum;
+    }
+  }
+
+  static void AccumulateSimd(const BitBoard & missed, const std::size_t* alive_num, std::size_t* probability){
+#if defined(__AVX2__) || defined(__SSE2__)
+    FitHeads fit;
+    fit.Build(missed, alive_num);
+
+#if defined(__AVX2__)
+    typedef __m256i Vec;
+#else
+    typedef __m128i Vec;
+#endif
+    const std::size_t kVecLanes = sizeof(Vec) / sizeof(std::uint16_t);
+
+    // the cell rows of both directions, with zero lanes in front of location 0
+    alignas(32) std::uint16_t cells[2][kMaxShipSize][kPad + kLaneNum];
+    for(std::size_t d = 0; d < 2; ++d){
+      for(std::size_t i = 0; i < kMaxShipSize; ++i){
+        for(std::size_t j = 0; j < kPad; j += kVecLanes){
+          Store(cells[d][i] + j, Zero());
+        }
+      }
+      for(std::size_t j = 0; j < kLaneNum; j += kVecLanes){
+        // walk the cells from the tail, every type joins at its own tail cell
+        Vec running = Zero();
+        std::size_t t = 0;
+        for(std::size_t i = kMaxShipSize; i-- > 0;){
+          for(; t < fit.type_num[d] && fit.size[d][t] == i + 1; ++t){
+            running = Add(running, Expand(fit.heads[d][t], fit.weight[d][t], j));
+          }
+          Store(cells[d][i] + kPad + j, running);
+        }
+      }
+    }
+
+    alignas(32) std::uint16_t histogram[kLaneNum];
+    for(std::size_t j = 0; j < kLaneNum; j += kVecLanes){
+      Vec acc = Zero();
+      for(std::size_t i = 0; i < kMaxShipSize; ++i){
+        acc = Add(acc, LoadUnaligned(cells[DirectionIndex(kVertical)][i] + kPad + j - i * kDim));
+        acc = Add(acc, LoadUnaligned(cells[DirectionIndex(kHorisontal)][i] + kPad + j - i));
+      }
+      Store(histogram + j, acc);
+    }
+    for(std::size_t i = 0; i < kDim * kDim; ++i){
+      probability[i] = histogram[i];
+    }
+#else
+    AccumulateScalar(missed, alive_num, probability);
+#endif
+  }
+
+private:
+  static const std::size_t kMaxShipSize = 5;
+  // zero lanes in front of the cells, so a head `i * step` before location 0 reads as no head.
+  // rounded up to keep the rows aligned.
+  static const std::size_t kPad = ((kMaxShipSize - 1) * kDim + 15) / 16 * 16;
+
+  // fitting heads of every alive type per direction, longest type first
+  struct FitHeads{
+    BitBoard heads[2][kShipTypeNum];
+    std::size_t size[2][kShipTypeNum];
+    std::uint16_t weight[2][kShipTypeNum];
+    std::size_t type_num[2] = {0, 0};
+
+    void Build(const BitBoard & missed, const std::size_t* alive_num){
+      const PlacementMasks & placement_masks = PlacementMasks::Get();
+      const Direction directions[2] = {kVertical, kHorisontal};
+
+      // blocked[d][k]: heads whose first k ship cells hold a miss, shared by every type
+      BitBoard blocked[2][kMaxShipSize + 1];
+      for(Direction direction : directions){
+        std::size_t d = DirectionIndex(direction);
+        std::size_t step = direction == kVertical ? kDim : 1;
+        for(std::size_t k = 1; k <= kMaxShipSize; ++k){
+          blocked[d][k] = blocked[d][k - 1] | missed.ShiftTowardsLow((k - 1) * step);
+        }
+      }
+
+      std::size_t max_per_location = 0;
+      // ShipType goes from the longest to the shortest
+      for(std::size_t type = 0; type < kShipTypeNum; ++type){
+        if(alive_num[type] == 0) continue;
+        std::size_t ship_size = GetSizeFromType(static_cast<ShipType>(type));
+        assert(ship_size <= kMaxShipSize);
+        assert(type == 0 || GetSizeFromType(static_cast<ShipType>(type - 1)) >= ship_size);
+        // a location is covered by at most 2 * size placements of the type
+        max_per_location += alive_num[type] * 2 * ship_size;
+        for(Direction direction : directions){
+          std::size_t d = DirectionIndex(direction);
+          heads[d][type_num[d]] = placement_masks.LegalHeads(static_cast<ShipType>(type), direction).AndNot(blocked[d][ship_size]);
+          size[d][type_num[d]] = ship_size;
+          weight[d][type_num[d]] = static_cast<std::uint16_t>(alive_num[type]);
+          type_num[d] += 1;
+        }
+      }
+      // the 16-bit lanes can't count past this
+      assert(max_per_location < (1 << 16));
+    }
+  };
+
+#if defined(__AVX2__)
+  static __m256i Zero(){
+    return _mm256_setzero_si256();
+  }
+
+  static __m256i Add(__m256i a, __m256i b){
+    return _mm256_add_epi16(a, b);
+  }
+
+  static void Store(std::uint16_t* lanes, __m256i v){
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+  }
+
+  static __m256i LoadUnaligned(const std::uint16_t* lanes){
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes));
+  }
+
+  // lane k = bit (first + k) of mask ? weight : 0, by comparing a broadcast of the mask
+  // bits against one bit per lane
+  static __m256i Expand(const BitBoard & mask, std::uint16_t weight, std::size_t first){
+    const __m256i bit_select = _mm256_setr_epi16(
+      0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080,
+      0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000, static_cast<short>(0x8000));
+    std::uint64_t word = mask.GetWord(first / BitBoard::kWordBits);
+    short bits = static_cast<short>(word >> (first % BitBoard::kWordBits));
+    __m256i selected = _mm256_and_si256(_mm256_set1_epi16(bits), bit_select);
+    return _mm256_and_si256(_mm256_cmpeq_epi16(selected, bit_select), _mm256_set1_epi16(static_cast<short>(weight)));
+  }
+#elif defined(__SSE2__)
+  static __m128i Zero(){
+    return _mm_setzero_si128();
+  }
+
+  static __m128i Add(__m128i a, __m128i b){
+    return _mm_add_epi16(a, b);
+  }
+
+  static void Store(std::uint16_t* lanes, __m128i v){
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+  }
+
+  static __m128i LoadUnaligned(const std::uint16_t* lanes){
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+  }
+
+  // lane k = bit (first + k) of mask ? weight : 0, by comparing a broadcast of the mask
+  // bits against one bit per lane
+  static __m128i Expand(const BitBoard & mask, std::uint16_t weight, std::size_t first){
+    const __m128i bit_select = _mm_setr_epi16(0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080);
+    std::uint64_t word = mask.GetWord(first / BitBoard::kWordBits);
+    short bits = static_cast<short>((word >> (first % BitBoard::kWordBits)) & 0xFF);
+    __m128i selected = _mm_and_si128(_mm_set1_epi16(bits), bit_select);
+    return _mm_and_si128(_mm_cmpeq_epi16(selected, bit_select), _mm_set1_epi16(static_cast<short>(weight)));
+  }
+#endif
+};
+
+typedef BasicProbabilityKernel<ClassicRules> ProbabilityKernel;
+
+#endif //BATTLESHIP_GAME_PROBABILITY_KERNEL_H
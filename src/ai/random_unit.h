@@ -5,44 +5,131 @@
 #ifndef BATTLESHIP_GAME_RANDOM_UNIT_H
 #define BATTLESHIP_GAME_RANDOM_UNIT_H
 
-#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <random>
-#include <ctime>
-#include <memory>
+#include "core/game/game_common.h"
 
-// please use a unique pointer outside this function to handle new allocated memory
+// xoshiro256** by Blackman and Vigna, 32 bytes of state and a few cycles per number.
+// usable with the <random> distributions and std::shuffle.
+class Xoshiro256{
+public:
+  typedef std::uint64_t result_type;
+
+  explicit Xoshiro256(std::uint64_t seed = 0){
+    Seed(seed);
+  }
+
+  // spread the seed over the state with splitmix64, so any seed (0 too) is fine
+  void Seed(std::uint64_t seed){
+    for(std::uint64_t & word : state_){
+      seed += 0x9E3779B97F4A7C15ULL;
+      std::uint64_t z = seed;
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      word = z ^ (z >> 31);
+    }
+  }
+
+  static constexpr result_type min(){
+    return 0;
+  }
+
+  static constexpr result_type max(){
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()(){
+    std::uint64_t result = Rotl(state_[1] * 5, 7) * 9;
+    std::uint64_t t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = Rotl(state_[3], 45);
+    return result;
+  }
+
+  // uniform in [0, n), n > 0, by Lemire's multiply and reject
+  std::uint64_t Below(std::uint64_t n){
+    unsigned __int128 product = static_cast<unsigned __int128>((*this)()) * n;
+    std::uint64_t low = static_cast<std::uint64_t>(product);
+    if(low < n){
+      std::uint64_t threshold = (0 - n) % n;
+      while(low < threshold){
+        product = static_cast<unsigned __int128>((*this)()) * n;
+        low = static_cast<std::uint64_t>(product);
+      }
+    }
+    return static_cast<std::uint64_t>(product >> 64);
+  }
+
+private:
+  std::uint64_t state_[4];
+
+  static std::uint64_t Rotl(std::uint64_t x, int k){
+    return (x << k) | (x >> (64 - k));
+  }
+};
+
+// Every thread draws from its own generator, seeded from std::random_device on first use.
+// Seed() makes what the calling thread draws from then on repeatable.
 class RandomUnit{
 public:
+  static void Seed(std::uint64_t seed){
+    Engine().Seed(seed);
+  }
+
+  // a seed of its own for every stream (game, batch, ...) of one run seed
+  static std::uint64_t DeriveSeed(std::uint64_t seed, std::uint64_t stream){
+    return Xoshiro256(seed ^ (stream * 0xD1B54A32D192ED03ULL))();
+  }
+
+  // the generator of the calling thread, to hand to the <random> distributions
+  static Xoshiro256 & Engine(){
+    thread_local Xoshiro256 engine(SeedFromDevice());
+    return engine;
+  }
 
-  static size_t* NewRandomSequenceArray(size_t dim){
-    std::unique_ptr<size_t[]> up_new_rand_seq(new size_t[dim]);
+  // res[0, dim) is a random permutation of 0, 1, ..., dim - 1
+  static void FillRandomSequence(size_t* res, size_t dim){
     for(size_t i = 0; i < dim; i++){
-      up_new_rand_seq[i] = i;
+      res[i] = i;
     }
-    std::random_device rd;
-    std::mt19937 engine(rd());
-    std::shuffle(up_new_rand_seq.get(), up_new_rand_seq.get() + dim, engine);
-    return up_new_rand_seq.release();
+    Shuffle(res, dim);
   }
 
-  static Direction* NewRandomDirectionArray(size_t size){
-    std::unique_ptr<Direction[]> up_new_rand_dir(new Direction[size]);
+  // res[0, size) alternates between the two directions, then gets shuffled
+  static void FillRandomDirections(Direction* res, size_t size){
     bool toggle = true;
     for(size_t i = 0; i < size; i++){
-      up_new_rand_dir[i] = toggle ? Direction::kHorisontal : Direction::kVertical;
+      res[i] = toggle ? Direction::kHorisontal : Direction::kVertical;
       toggle = !toggle;
     }
-    std::random_device rd;
-    std::mt19937 engine(rd());
-    std::shuffle(up_new_rand_dir.get(), up_new_rand_dir.get() + size, engine);
-    return up_new_rand_dir.release();
+    Shuffle(res, size);
+  }
+
+  // Fisher-Yates
+  template<typename T>
+  static void Shuffle(T* first, size_t size){
+    Xoshiro256 & engine = Engine();
+    for(size_t i = size; i > 1; --i){
+      size_t j = static_cast<size_t>(engine.Below(i));
+      T temp = first[i - 1];
+      first[i - 1] = first[j];
+      first[j] = temp;
+    }
   }
 
   static size_t GetRandomSizeT(size_t inclusive_low, size_t inclusive_hi){
+    return inclusive_low + static_cast<size_t>(Engine().Below(static_cast<std::uint64_t>(inclusive_hi - inclusive_low) + 1));
+  }
+
+private:
+  static std::uint64_t SeedFromDevice(){
     std::random_device rd;
-    std::mt19937 mt(rd());
-    std::uniform_int_distribution<size_t> dist(inclusive_low, inclusive_hi);
-    return dist(mt);
+    return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
   }
 };
 
@@ -5,8 +5,7 @@
 #ifndef BATTLESHIP_GAME_SHIP_PLACEMENT_UNIT_H
 #define BATTLESHIP_GAME_SHIP_PLACEMENT_UNIT_H
 
-#include <vector>
-#include <memory>
+#include <string>
 #include "ai/random_unit.h"
 #include "ai/ai_common.h"
 #include "core/game/board.h"
@@ -17,11 +16,37 @@ enum class StrategyPlaceShip{
   kRandom
 };
 
-class ShipPlacementUnit{
+static std::string StrategyPlaceShipToString(const StrategyPlaceShip strategy){
+  switch(strategy){
+    case StrategyPlaceShip::kFixed:{
+      return "fixed";
+    }
+    case StrategyPlaceShip::kRandom:{
+      return "random";
+    }
+    default:{
+      return "unknown";
+    }
+  }
+}
+
+// return false if the name does not match any strategy
+static bool StrategyPlaceShipFromString(const std::string & name, StrategyPlaceShip* strategy){
+  if(name == "fixed") *strategy = StrategyPlaceShip::kFixed;
+  else if(name == "random") *strategy = StrategyPlaceShip::kRandom;
+  else return false;
+  return true;
+}
+
+template<typename Rules>
+class BasicShipPlacementUnit{
 public:
-  ShipPlacementUnit(){}
+  typedef FixedVector<ShipPlacementInfo, Rules::kShipNum> ShipPlacingPlanList;
+  static const std::size_t kDim = Rules::kDim;
 
-  std::vector<ShipPlacementInfo> ShipPlacingPlan(const StrategyPlaceShip & strategy){
+  BasicShipPlacementUnit(){}
+
+  ShipPlacingPlanList ShipPlacingPlan(const StrategyPlaceShip & strategy){
     switch(strategy){
       case StrategyPlaceShip::kFixed:{
         return ShipPlacingPlanFixed();
@@ -36,27 +61,26 @@ public:
 
   }
 private:
-  Board trial_board_;
+  BasicBoard<Rules> trial_board_;
 
   // ship placement strategies
-  std::vector<ShipPlacementInfo> ShipPlacingPlanFixed(){
-    std::vector<ShipPlacementInfo> ret;
-    ret.emplace_back(ShipPlacementInfo(ShipType::kCarrier, 0, Direction::kVertical));
-    ret.emplace_back(ShipPlacementInfo(ShipType::kBattleShip, 1, Direction::kVertical));
-    ret.emplace_back(ShipPlacementInfo(ShipType::kBattleShip, 2, Direction::kVertical));
-    ret.emplace_back(ShipPlacementInfo(ShipType::kCruiser, 3, Direction::kVertical));
-    ret.emplace_back(ShipPlacementInfo(ShipType::kCruiser, 4, Direction::kVertical));
-    ret.emplace_back(ShipPlacementInfo(ShipType::kCruiser, 5, Direction::kVertical));
-    ret.emplace_back(ShipPlacementInfo(ShipType::kDestroyer, 6, Direction::kVertical));
-    ret.emplace_back(ShipPlacementInfo(ShipType::kDestroyer, 7, Direction::kVertical));
-    ret.emplace_back(ShipPlacementInfo(ShipType::kDestroyer, 8, Direction::kVertical));
-    ret.emplace_back(ShipPlacementInfo(ShipType::kDestroyer, 9, Direction::kVertical));
+  // every ship upright in its own column, from the left, longest first
+  ShipPlacingPlanList ShipPlacingPlanFixed(){
+    static_assert(Rules::kShipNum <= Rules::kDim, "the fixed plan needs a column per ship");
+    ShipPlacingPlanList ret;
+    size_t column = 0;
+    for(ShipType type : GetShipTypeList()){
+      for(size_t i = 0; i < Rules::GetNumFromType(type); ++i){
+        ret.emplace_back(type, column, Direction::kVertical);
+        column += 1;
+      }
+    }
 
     return ret;
   }
 
-  std::vector<ShipPlacementInfo> ShipPlacingPlanRandom(){
-    std::vector<ShipPlacementInfo> res;
+  ShipPlacingPlanList ShipPlacingPlanRandom(){
+    ShipPlacingPlanList res;
     PlaceOneType(ShipType::kCarrier, res);
     PlaceOneType(ShipType::kBattleShip, res);
     PlaceOneType(ShipType::kCruiser, res);
@@ -64,21 +88,31 @@ private:
     return res;
   }
 
-  void PlaceOneType(ShipType type, std::vector<ShipPlacementInfo> & res){
-    std::unique_ptr<size_t[]> up_random_location(RandomUnit::NewRandomSequenceArray(kDim * kDim));
-    std::unique_ptr<Direction[]> up_random_direction(RandomUnit::NewRandomDirectionArray(kDim * kDim));
+  void PlaceOneType(ShipType type, ShipPlacingPlanList & res){
+    size_t random_location[kDim * kDim];
+    Direction random_direction[kDim * kDim];
+    RandomUnit::FillRandomSequence(random_location, kDim * kDim);
+    RandomUnit::FillRandomDirections(random_direction, kDim * kDim);
     size_t p_current = 0;
     while(trial_board_.CanPlaceMore(type)){
-      size_t location = up_random_location.get()[p_current];
-      Direction direction = up_random_direction.get()[p_current];
+      // every spot tried once, go for another round of spots
+      if(p_current == kDim * kDim){
+        RandomUnit::FillRandomSequence(random_location, kDim * kDim);
+        RandomUnit::FillRandomDirections(random_direction, kDim * kDim);
+        p_current = 0;
+      }
+      size_t location = random_location[p_current];
+      Direction direction = random_direction[p_current];
 
       bool success = trial_board_.PlaceAShip(type, location, direction);
       if(success){
-        res.emplace_back(ShipPlacementInfo(type, location, direction));
+        res.emplace_back(type, location, direction);
       }
       p_current++;
     }
   }
 };
 
+typedef BasicShipPlacementUnit<ClassicRules> ShipPlacementUnit;
+
 #endif //BATTLESHIP_GAME_SHIP_PLACEMENT_UNIT_H
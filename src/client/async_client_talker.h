@@ -0,0 +1,178 @@
+//
+// Non-blocking counterpart of ClientTalker, every exchange completes through a handler.
+//
+
+#ifndef CLIENT_ASYNC_CLIENT_TALKER_H_
+#define CLIENT_ASYNC_CLIENT_TALKER_H_
+
+#include <string>
+#include "core/game/game_common.h"
+#include "core/networking/networking.h"
+#include "client/client_common.h"
+#include "client/async_connection.h"
+#include "utils/utils.h"
+
+// Talks the same protocol as ClientTalker as one session of an AsyncConnection.
+// Only one exchange may be in flight at a time, the caller starts the next one from the
+// handler of the last, so the handlers of one talker never run concurrently.
+// The talker must outlive the exchange, the caller keeps it alive through the handler.
+class AsyncClientTalker{
+public:
+  AsyncClientTalker(const std::shared_ptr<AsyncConnection> & connection, const ClientId & cli_id, const GameId & game_id):
+    connection_(connection),
+    cli_id_(cli_id),
+    game_id_(game_id){
+    connection_->Open(game_id_);
+  }
+
+  GameId GetGameId() const{
+    return game_id_;
+  }
+
+  // handler(error_code, GameId)
+  template<typename Handler>
+  void AsyncSendMyGameIdAndGetTheOther(Handler handler){
+    MakeInfoGameId(outgoing_.data, &outgoing_.length, cli_id_, game_id_);
+    AsyncSendAndReceive(MessageType::kInfoGameId, [handler](const asio::error_code & ec, const unsigned char* body, std::size_t length){
+      ClientId cli_id = 0;
+      GameId game_id = 0;
+      unsigned char version = 0;
+      if(ec){
+        handler(ec, game_id);
+        return;
+      }
+      if(!ResolveInfoGameId(body, length, &cli_id, &game_id, &version)){
+        handler(asio::error_code(asio::error::invalid_argument), game_id);
+        return;
+      }
+      if(version != kWireVersion){
+        Logger("peer talks wire version " + std::to_string(version));
+        handler(asio::error_code(asio::error::operation_not_supported), game_id);
+        return;
+      }
+      handler(ec, game_id);
+    });
+  }
+
+  // handler(error_code)
+  template<typename Handler>
+  void AsyncSendMyReadyAndWaitTheOther(Handler handler){
+    MakeInfoReady(outgoing_.data, &outgoing_.length, cli_id_, game_id_);
+    AsyncSendAndReceive(MessageType::kInfoReady, [handler](const asio::error_code & ec, const unsigned char*, std::size_t){
+      handler(ec);
+    });
+  }
+
+  // handler(error_code, bool fire_first)
+  template<typename Handler>
+  void AsyncDecideWhoFireFirst(Handler handler){
+    // same as ClientTalker, the client id decides
+    unsigned long my_num = cli_id_;
+    MakeInfoRoll(outgoing_.data, &outgoing_.length, cli_id_, game_id_, my_num);
+    AsyncSendAndReceive(MessageType::kInfoRoll, [handler, my_num](const asio::error_code & ec, const unsigned char* body, std::size_t length){
+      ClientId cli_id = 0;
+      GameId game_id = 0;
+      unsigned long oppo_num = 0;
+      if(!ec){
+        if(!ResolveInfoRoll(body, length, &cli_id, &game_id, &oppo_num)){
+          handler(asio::error_code(asio::error::invalid_argument), false);
+          return;
+        }
+        // the peer claims our client id, there is no telling who fires first
+        if(my_num == oppo_num){
+          handler(asio::error_code(asio::error::invalid_argument), false);
+          return;
+        }
+      }
+      handler(ec, my_num > oppo_num);
+    });
+  }
+
+  // handler(error_code, AttackResult)
+  template<typename Handler>
+  void AsyncAttack(size_t location, Handler handler){
+    MakeRequestAttack(outgoing_.data, &outgoing_.length, cli_id_, game_id_, location);
+    AsyncSendAndReceive(MessageType::kReplyAttack, [handler, location](const asio::error_code & ec, const unsigned char* body, std::size_t length){
+      bool success = false;
+      ShipType sink_ship_type = kNotAShip;
+      bool attacker_win = false;
+      if(!ec && !ResolveReplyAttack(body, length, &success, &sink_ship_type, &attacker_win)){
+        handler(asio::error_code(asio::error::invalid_argument), AttackResult(location, success, sink_ship_type, attacker_win));
+        return;
+      }
+      handler(ec, AttackResult(location, success, sink_ship_type, attacker_win));
+    });
+  }
+
+  // handler(error_code, size_t location)
+  template<typename Handler>
+  void AsyncGetEnemyMove(Handler handler){
+    AsyncReceive(MessageType::kRequestAttack, [handler](const asio::error_code & ec, const unsigned char* body, std::size_t length){
+      ClientId client_id = 0;
+      GameId game_id = 0;
+      size_t location = 0;
+      if(!ec && !ResolveRequestAttack(body, length, &client_id, &game_id, &location)){
+        handler(asio::error_code(asio::error::invalid_argument), location);
+        return;
+      }
+      handler(ec, location);
+    });
+  }
+
+  // handler(error_code)
+  template<typename Handler>
+  void AsyncSendAttackResult(bool success, ShipType type, bool attacker_win, Handler handler){
+    MakeReplyAttack(outgoing_.data, &outgoing_.length, game_id_, success, type, attacker_win);
+    AsyncSend(handler);
+  }
+
+  // the game is over, its messages are no longer expected
+  void Close(){
+    connection_->Close(game_id_);
+  }
+
+private:
+  std::shared_ptr<AsyncConnection> connection_;
+  ClientId cli_id_;
+  GameId game_id_;
+
+  // one exchange at a time, so one outgoing message is enough
+  Frame outgoing_;
+
+  // handler(error_code)
+  template<typename Handler>
+  void AsyncSend(Handler handler){
+    connection_->AsyncSend(outgoing_, handler);
+  }
+
+  // handler(error_code, body, body length)
+  template<typename Handler>
+  void AsyncReceive(MessageType type, Handler handler){
+    connection_->AsyncReceive(game_id_, [handler, type](const asio::error_code & ec, const Frame & frame){
+      if(ec){
+        handler(ec, nullptr, 0);
+        return;
+      }
+      if(frame.GetType() == MessageType::kInfoBreakOff){
+        handler(asio::error_code(asio::error::connection_aborted), nullptr, 0);
+        return;
+      }
+      if(frame.GetType() != type){
+        Logger("unexpected reply type");
+        handler(asio::error_code(asio::error::invalid_argument), nullptr, 0);
+        return;
+      }
+      handler(ec, frame.GetBody(), frame.GetBodyLength());
+    });
+  }
+
+  // the reply may arrive before the send completes, the connection keeps it until asked for.
+  // a failed send fails the connection, which the receive then reports.
+  template<typename Handler>
+  void AsyncSendAndReceive(MessageType type, Handler handler){
+    AsyncSend([](const asio::error_code &){});
+    AsyncReceive(type, handler);
+  }
+};
+
+#endif  // CLIENT_ASYNC_CLIENT_TALKER_H_
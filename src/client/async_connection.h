@@ -0,0 +1,376 @@
+//
+// One tcp connection carrying the messages of many games, told apart by the game id in every header.
+//
+
+#ifndef CLIENT_ASYNC_CONNECTION_H_
+#define CLIENT_ASYNC_CONNECTION_H_
+
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "core/networking/networking.h"
+#include "core/networking/frame_codec.h"
+#include "client/client_common.h"
+#include "utils/utils.h"
+
+using asio::ip::tcp;
+
+// Every game on the connection is a session, opened under its game id.
+// A message for a session lands in its inbox until the session asks for it, so a peer may
+// send before this side is listening. Sessions write through one queue: whatever piled up in it
+// while the last write was on the wire goes out in the next one, up to max_batch messages
+// gathered into a single write, so many games pay one round of syscalls instead of one each.
+// Reads go the same way the other direction, one read takes in all the messages the peer wrote.
+// All of the bookkeeping runs on a strand, while the handlers of the sessions are posted to the
+// io_service, so the games on one connection still play on all the threads running it.
+// A game may instead be relayed: its messages go on to the connection of the peer as they are,
+// which is how a server pairs two clients without playing itself.
+class AsyncConnection : public std::enable_shared_from_this<AsyncConnection>{
+public:
+  // called on the strand for a message of a game not opened yet and for every matchmaking message,
+  // the handler may open the game. a matchmaking message goes nowhere else.
+  typedef std::function<void(const std::shared_ptr<AsyncConnection> &, const FrameView &)> NewSessionHandler;
+  typedef std::function<void(const asio::error_code &, const Frame &)> ReceiveHandler;
+  // called on the strand once the reply winning a relayed game went through, finished true, or once
+  // the connection failed with the game still relayed, finished false. both ends of a game may call it.
+  typedef std::function<void(GameId, bool finished)> RelayOverHandler;
+
+  static const size_t kDefaultMaxBatch = 64;
+
+  // max_batch 1 writes the messages one by one
+  explicit AsyncConnection(asio::io_service & io_service, size_t max_batch = kDefaultMaxBatch):
+    io_service_(io_service),
+    strand_(io_service),
+    tcp_sock_(io_service),
+    max_batch_(max_batch > 0 ? max_batch : 1){
+  }
+
+  // to connect or accept on
+  tcp::socket & GetRefSocket(){
+    return tcp_sock_;
+  }
+
+  // start reading once connected, on_new_session may be empty
+  void Start(const NewSessionHandler & on_new_session){
+    // every message is a small request waiting for a small reply, Nagle would hold each back for the delayed ack
+    asio::error_code ignored;
+    tcp_sock_.set_option(tcp::no_delay(true), ignored);
+    auto self = shared_from_this();
+    strand_.dispatch([self, on_new_session](){
+      self->on_new_session_ = on_new_session;
+      self->ReadNext();
+    });
+  }
+
+  void Open(GameId game_id){
+    auto self = shared_from_this();
+    strand_.dispatch([self, game_id](){
+      Session & session = self->sessions_[game_id];
+      assert(!session.closed);
+      self->open_num_ += 1;
+    });
+  }
+
+  void Close(GameId game_id){
+    auto self = shared_from_this();
+    strand_.dispatch([self, game_id](){
+      // the session stays behind closed, so a late message can't open the game again
+      Session & session = self->sessions_[game_id];
+      if(session.closed) return;
+      session.closed = true;
+      session.inbox.clear();
+      session.waiting = nullptr;
+      self->open_num_ -= 1;
+      self->ShutdownIfDone();
+    });
+  }
+
+  // messages of the game go on to peer from now on, until the game is won
+  void Relay(GameId game_id, const std::shared_ptr<AsyncConnection> & peer, const RelayOverHandler & on_over){
+    auto self = shared_from_this();
+    strand_.dispatch([self, game_id, peer, on_over](){
+      self->relays_[game_id] = Relayed{peer, on_over};
+    });
+  }
+
+  void Unrelay(GameId game_id){
+    auto self = shared_from_this();
+    strand_.dispatch([self, game_id](){
+      self->relays_.erase(game_id);
+    });
+  }
+
+  // set once the connection failed, from any thread
+  bool HasFailed() const{
+    return failed_;
+  }
+
+  // the side that opened the sessions closes the connection once the last one is closed and everything is written
+  void CloseWhenIdle(){
+    auto self = shared_from_this();
+    strand_.dispatch([self](){
+      self->close_when_idle_ = true;
+      self->ShutdownIfDone();
+    });
+  }
+
+  // handler(error_code) once the frame is written
+  template<typename Handler>
+  void AsyncSend(const Frame & frame, Handler handler){
+    auto self = shared_from_this();
+    strand_.dispatch([self, frame, handler](){
+      if(self->error_){
+        self->io_service_.post(std::bind(handler, self->error_));
+        return;
+      }
+      self->outbox_.push_back(Outgoing{frame, handler});
+      self->Flush();
+    });
+  }
+
+  // handler(error_code, const Frame &) with the next message of the game
+  void AsyncReceive(GameId game_id, const ReceiveHandler & handler){
+    auto self = shared_from_this();
+    strand_.dispatch([self, game_id, handler](){
+      auto it = self->sessions_.find(game_id);
+      assert(it != self->sessions_.end() && !it->second.closed);
+      Session & session = it->second;
+      if(!session.inbox.empty()){
+        self->io_service_.post(std::bind(handler, asio::error_code(), session.inbox.front()));
+        session.inbox.pop_front();
+        return;
+      }
+      if(self->error_){
+        self->io_service_.post(std::bind(handler, self->error_, Frame()));
+        return;
+      }
+      assert(!session.waiting);
+      session.waiting = handler;
+    });
+  }
+
+  // writes made and messages written, read them once the io_service is done with the connection
+  size_t GetWriteNum() const{
+    return write_num_;
+  }
+
+  size_t GetWrittenFrameNum() const{
+    return written_frame_num_;
+  }
+
+  size_t GetReadNum() const{
+    return read_num_;
+  }
+
+  size_t GetReadFrameNum() const{
+    return read_frame_num_;
+  }
+
+private:
+  struct Session{
+    std::deque<Frame> inbox;
+    ReceiveHandler waiting;
+    bool closed = false;
+  };
+
+  struct Relayed{
+    std::shared_ptr<AsyncConnection> peer;
+    RelayOverHandler on_over;
+  };
+
+  struct Outgoing{
+    Frame frame;
+    std::function<void(const asio::error_code &)> handler;
+  };
+
+  asio::io_service & io_service_;
+  asio::io_service::strand strand_;
+  tcp::socket tcp_sock_;
+  size_t max_batch_;
+
+  // everything below is only touched on the strand
+  std::unordered_map<GameId, Session> sessions_;
+  std::unordered_map<GameId, Relayed> relays_;
+  size_t open_num_ = 0;
+  NewSessionHandler on_new_session_;
+  std::deque<Outgoing> outbox_;
+  // the first writing_num_ messages of the outbox are on the wire, gathered by write_buffers_
+  size_t writing_num_ = 0;
+  bool flush_posted_ = false;
+  std::vector<asio::const_buffer> write_buffers_;
+  size_t write_num_ = 0;
+  size_t written_frame_num_ = 0;
+  FrameDecoder decoder_;
+  size_t read_num_ = 0;
+  size_t read_frame_num_ = 0;
+  bool close_when_idle_ = false;
+  // the first error ends the connection for every session
+  asio::error_code error_;
+  std::atomic<bool> failed_{false};
+
+  // read whatever arrived, up to the room left, and deliver every whole message in it.
+  // a partial one stays in the decoder for the next read.
+  void ReadNext(){
+    auto self = shared_from_this();
+    tcp_sock_.async_read_some(decoder_.PrepareRead(), strand_.wrap([self](const asio::error_code & ec, std::size_t bytes){
+      if(ec){
+        self->Fail(ec);
+        return;
+      }
+      self->decoder_.CommitRead(bytes);
+      self->read_num_ += 1;
+      self->read_frame_num_ += self->decoder_.ParseFrames([&self](const FrameView & frame){
+        self->Deliver(frame);
+      });
+      if(self->decoder_.IsBroken()){
+        self->Fail(asio::error_code(asio::error::message_size));
+        return;
+      }
+      // a malformed message failed it
+      if(self->error_) return;
+      self->ReadNext();
+    }));
+  }
+
+  // hand the message to its session or the peer it is relayed to, it is copied out of the decoder only here
+  void Deliver(const FrameView & frame){
+    if(error_) return;
+    auto relay = relays_.find(frame.game_id);
+    if(relay != relays_.end()){
+      Forward(frame, relay);
+      return;
+    }
+    if(IsMatchmakingMessage(frame.type)){
+      if(on_new_session_) on_new_session_(shared_from_this(), frame);
+      return;
+    }
+
+    auto it = sessions_.find(frame.game_id);
+    if(it == sessions_.end() && on_new_session_){
+      on_new_session_(shared_from_this(), frame);
+      it = sessions_.find(frame.game_id);
+    }
+    if(it == sessions_.end() || it->second.closed){
+      Logger("message of unknown game " + std::to_string(frame.game_id) + " dropped");
+      return;
+    }
+
+    Session & session = it->second;
+    if(session.waiting){
+      io_service_.post(std::bind(session.waiting, asio::error_code(), Frame(frame)));
+      session.waiting = nullptr;
+      return;
+    }
+    session.inbox.emplace_back(frame);
+  }
+
+  // the reply that wins the game is the last message of it, both ends stop relaying it then.
+  // a reply cut short fails the connection, it is not passed on.
+  void Forward(const FrameView & frame, std::unordered_map<GameId, Relayed>::iterator relay){
+    std::shared_ptr<AsyncConnection> peer = relay->second.peer;
+    bool success = false;
+    ShipType type = kNotAShip;
+    bool attacker_win = false;
+    if(frame.type == MessageType::kReplyAttack
+       && !ResolveReplyAttack(frame.GetBody(), frame.GetBodyLength(), &success, &type, &attacker_win)){
+      Logger("malformed reply of game " + std::to_string(frame.game_id));
+      Fail(asio::error_code(asio::error::invalid_argument));
+      return;
+    }
+    if(attacker_win){
+      // over before the reply goes on, the peer may fail as soon as its client has it
+      RelayOverHandler on_over = relay->second.on_over;
+      relays_.erase(relay);
+      peer->Unrelay(frame.game_id);
+      if(on_over) on_over(frame.game_id, true);
+    }
+    peer->AsyncSend(Frame(frame), [](const asio::error_code &){});
+  }
+
+  // Start writing if nothing is on the wire. Batching waits for the handlers queued on the
+  // io_service by then to run first, the messages they send go out in the same write.
+  void Flush(){
+    if(writing_num_ > 0 || flush_posted_) return;
+    if(max_batch_ == 1){
+      WriteNext();
+      return;
+    }
+    flush_posted_ = true;
+    auto self = shared_from_this();
+    strand_.post([self](){
+      self->flush_posted_ = false;
+      if(self->writing_num_ == 0 && !self->error_ && !self->outbox_.empty()) self->WriteNext();
+    });
+  }
+
+  // write up to max_batch_ messages from the front of the outbox at once
+  void WriteNext(){
+    auto self = shared_from_this();
+    write_buffers_.clear();
+    for(auto it = outbox_.begin(); it != outbox_.end() && write_buffers_.size() < max_batch_; ++it){
+      write_buffers_.push_back(asio::buffer(it->frame.data, it->frame.length));
+    }
+    writing_num_ = write_buffers_.size();
+    asio::async_write(tcp_sock_, write_buffers_, strand_.wrap([self](const asio::error_code & ec, std::size_t){
+      self->write_num_ += 1;
+      self->written_frame_num_ += self->writing_num_;
+      for(; self->writing_num_ > 0; --self->writing_num_){
+        self->io_service_.post(std::bind(self->outbox_.front().handler, ec));
+        self->outbox_.pop_front();
+      }
+      if(ec){
+        self->Fail(ec);
+        return;
+      }
+      if(self->error_) return;
+      if(!self->outbox_.empty()){
+        self->WriteNext();
+        return;
+      }
+      self->ShutdownIfDone();
+    }));
+  }
+
+  // hand the error to every session waiting and to every message not written yet,
+  // the messages on the wire complete with the error of their write once the socket is closed
+  void Fail(const asio::error_code & ec){
+    if(!error_) error_ = ec;
+    failed_ = true;
+    for(auto & entry : sessions_){
+      Session & session = entry.second;
+      if(session.waiting){
+        io_service_.post(std::bind(session.waiting, error_, Frame()));
+        session.waiting = nullptr;
+      }
+    }
+    // the peers of relayed games stop sending here, which also breaks the cycle of pointers,
+    // and their clients hear that the game is broken off
+    for(auto & relay : relays_){
+      Frame break_off;
+      MakeInfoBreakOff(break_off.data, &break_off.length, relay.first);
+      relay.second.peer->AsyncSend(break_off, [](const asio::error_code &){});
+      relay.second.peer->Unrelay(relay.first);
+      if(relay.second.on_over) relay.second.on_over(relay.first, false);
+    }
+    relays_.clear();
+    while(outbox_.size() > writing_num_){
+      io_service_.post(std::bind(outbox_.back().handler, error_));
+      outbox_.pop_back();
+    }
+    asio::error_code ignored;
+    tcp_sock_.close(ignored);
+  }
+
+  void ShutdownIfDone(){
+    if(!close_when_idle_ || open_num_ > 0 || !outbox_.empty() || error_) return;
+    asio::error_code ignored;
+    tcp_sock_.shutdown(tcp::socket::shutdown_both, ignored);
+    tcp_sock_.close(ignored);
+  }
+};
+
+#endif  // CLIENT_ASYNC_CONNECTION_H_
@@ -0,0 +1,219 @@
+//
+// GameClient driven by the completion handlers of an AsyncClientTalker, many of them share one connection.
+//
+
+#ifndef BATTLESHIP_CLIENT_ASYNC_GAME_CLIENT_H
+#define BATTLESHIP_CLIENT_ASYNC_GAME_CLIENT_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include "client/client_common.h"
+#include "client/async_client_talker.h"
+#include "client/client_brain.h"
+#include "core/game/board.h"
+#include "utils/utils.h"
+
+// what one game ended with, does_win is false as well if the game broke off
+struct AsyncGameResult{
+  ClientId cli_id = 0;
+  GameId game_id = 0;
+  bool finished = false;
+  bool does_win = false;
+  size_t num_moves = 0;
+};
+
+// Goes through the same states as GameClient, but every state that talks to the peer starts one
+// exchange and returns, the handler of the exchange moves on to the next state. No thread blocks
+// on a game, so a few threads running the io_service can carry thousands of them, and many
+// of them can share one connection.
+// Handlers hold a shared_ptr to the client, the client lives until its last exchange completes.
+class AsyncGameClient : public std::enable_shared_from_this<AsyncGameClient>{
+public:
+  typedef std::function<void(const AsyncGameResult &)> GameOverHandler;
+
+  AsyncGameClient(const std::shared_ptr<AsyncConnection> & connection, ClientId cli_id, GameId game_id,
+                  StrategyAttack attack_strategy, const GameOverHandler & on_game_over):
+    cli_id_(cli_id),
+    attack_strategy_(attack_strategy),
+    cli_talker_(connection, cli_id, game_id),
+    cli_brain_{my_board_},
+    state_(ClientState::kStarted),
+    on_game_over_(on_game_over){
+  }
+
+  // the connection has to be started, by then or later
+  void Start(){
+    Step();
+  }
+
+  ClientState GetState() const{
+    return state_;
+  }
+
+private:
+  ClientId cli_id_;
+  StrategyAttack attack_strategy_;
+
+  Board my_board_;
+  AsyncClientTalker cli_talker_;
+  ClientBrain cli_brain_;
+
+  bool is_winner_me_ = false;
+
+  // game state
+  ClientState state_;
+
+  GameOverHandler on_game_over_;
+
+  // run the current state, the states that talk continue from their handler
+  void Step(){
+    auto self = shared_from_this();
+    switch(state_){
+      case ClientState::kStarted:{
+        // verify game id
+        cli_talker_.AsyncSendMyGameIdAndGetTheOther([self](const asio::error_code & ec, GameId game_id){
+          if(self->Failed(ec)) return;
+          if(game_id != self->cli_talker_.GetGameId()){
+            self->BreakOff("the peer plays game " + std::to_string(game_id));
+            return;
+          }
+          self->ChangeStateTo(ClientState::kConnected);
+        });
+        break;
+      }
+      case ClientState::kConnected:{
+        PlaceShips();
+        ChangeStateTo(ClientState::kReady);
+        break;
+      }
+      case ClientState::kReady:{
+        // wait for both clients are ready and decide who shoot first
+        cli_talker_.AsyncSendMyReadyAndWaitTheOther([self](const asio::error_code & ec){
+          if(self->Failed(ec)) return;
+          self->cli_talker_.AsyncDecideWhoFireFirst([self](const asio::error_code & ec, bool first_fire){
+            if(self->Failed(ec)) return;
+            self->ChangeStateTo(first_fire ? ClientState::kFire : ClientState::kWait);
+          });
+        });
+        break;
+      }
+      case ClientState::kFire:{
+        my_board_.IncrementOneMove();
+        size_t location = cli_brain_.GenerateNextAttackLocation(attack_strategy_);
+        cli_talker_.AsyncAttack(location, [self](const asio::error_code & ec, const AttackResult & res){
+          if(self->Failed(ec)) return;
+          if(!self->IsPossibleReply(res)){
+            self->BreakOff("the peer sank a ship it can't have sunk");
+            return;
+          }
+          self->cli_brain_.DigestAttackResult(res);
+          if(res.attacker_win){
+            self->is_winner_me_ = true;
+            self->ChangeStateTo(ClientState::kEndGame);
+            return;
+          }
+          self->ChangeStateTo(ClientState::kWait);
+        });
+        break;
+      }
+      case ClientState::kWait:{
+        cli_brain_.GetRefEnemyBoard().IncrementOneMove();
+        cli_talker_.AsyncGetEnemyMove([self](const asio::error_code & ec, size_t location){
+          if(self->Failed(ec)) return;
+          // Board::Attack throws on a location attacked before, and has no bounds to check
+          if(location >= ClassicRules::kCellNum || self->my_board_.LocationAttacked(location)){
+            self->BreakOff("the peer fired at " + std::to_string(location));
+            return;
+          }
+          AttackResult res = self->my_board_.Attack(location);
+          self->cli_talker_.AsyncSendAttackResult(res.success, res.sink_ship_type, res.attacker_win,
+                                                  [self, res](const asio::error_code & ec){
+            if(self->Failed(ec)) return;
+            if(res.attacker_win){
+              self->is_winner_me_ = false;
+              self->ChangeStateTo(ClientState::kEndGame);
+              return;
+            }
+            self->ChangeStateTo(ClientState::kFire);
+          });
+        });
+        break;
+      }
+      case ClientState::kEndGame:{
+        SetWinnerLoserOnBoards();
+        LogResult(cli_id_, cli_talker_.GetGameId(), is_winner_me_, my_board_.GetNumMoves());
+        cli_talker_.Close();
+        ReportResult(true);
+        break;
+      }
+      default:{
+        assert(false);
+      }
+    }
+  }
+
+  // the state machine moves on without logging every transition, with thousands of games the log would be all of it
+  void ChangeStateTo(ClientState new_state){
+    state_ = new_state;
+    Step();
+  }
+
+  // true and the game is broken off if ec is an error
+  bool Failed(const asio::error_code & ec){
+    if(!ec) return false;
+    BreakOff(ec);
+    return true;
+  }
+
+  void BreakOff(const asio::error_code & ec){
+    BreakOff(ec.message());
+  }
+
+  // only this game, the others on the connection go on
+  void BreakOff(const std::string & reason){
+    Logger("game " + std::to_string(cli_talker_.GetGameId()) + " broke off in " + ClientStateToString(state_)
+           + ": " + reason);
+    cli_talker_.Close();
+    state_ = ClientState::kEndGame;
+    ReportResult(false);
+  }
+
+  // a miss sinks nothing, a hit sinks nothing or a ship of a type still afloat
+  bool IsPossibleReply(const AttackResult & res){
+    if(res.sink_ship_type == kNotAShip) return true;
+    return res.success && cli_brain_.GetRefEnemyBoard().GetAliveShipNumber(res.sink_ship_type) > 0;
+  }
+
+  void PlaceShips(){
+    ShipPlacingPlanList plan = cli_brain_.GenerateShipPlacingPlan(StrategyPlaceShip::kRandom);
+    for(auto placement : plan){
+      bool success = my_board_.PlaceAShip(placement.type, placement.head_location, placement.direction);
+      assert(success);
+    }
+  }
+
+  // set winner and loser on boards
+  void SetWinnerLoserOnBoards(){
+    my_board_.SetGameOver();
+    cli_brain_.GetRefEnemyBoard().SetGameOver();
+    if(is_winner_me_){
+      my_board_.SetThisWinner();
+    }else{
+      cli_brain_.GetRefEnemyBoard().SetThisWinner();
+    }
+  }
+
+  void ReportResult(bool finished){
+    if(!on_game_over_) return;
+    AsyncGameResult res;
+    res.cli_id = cli_id_;
+    res.game_id = cli_talker_.GetGameId();
+    res.finished = finished;
+    res.does_win = finished && is_winner_me_;
+    res.num_moves = my_board_.GetNumMoves();
+    on_game_over_(res);
+  }
+};
+
+#endif //BATTLESHIP_CLIENT_ASYNC_GAME_CLIENT_H
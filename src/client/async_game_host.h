@@ -0,0 +1,226 @@
+//
+// Plays many AsyncGameClients of one process against a peer process, all on one io_service.
+//
+
+#ifndef BATTLESHIP_CLIENT_ASYNC_GAME_HOST_H
+#define BATTLESHIP_CLIENT_ASYNC_GAME_HOST_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "client/async_connection.h"
+#include "client/async_game_client.h"
+
+struct AsyncHostSetting{
+  ClientType type = ClientType::kListener;
+  std::string peer_ip = "127.0.0.1";
+  size_t port = 0;
+  ClientId cli_id = 0;
+  // games the initiator opens, first_game_id, first_game_id + 1, ...
+  // a listener plays whatever games its peers open, a matched client asks the server for that many games.
+  GameId first_game_id = 0;
+  size_t games = 1;
+  // connections the initiator or matched client opens and spreads its games over, or the listener accepts
+  size_t connections = 1;
+  // messages coalesced into one write at most, 1 writes them one by one
+  size_t batch = AsyncConnection::kDefaultMaxBatch;
+  StrategyAttack attack = StrategyAttack::kDFSProbability;
+};
+
+struct AsyncHostResult{
+  size_t finished = 0;
+  size_t broken_off = 0;
+  size_t wins = 0;
+  size_t moves = 0;
+  // over all connections, messages / writes is how well they were coalesced
+  size_t writes = 0;
+  size_t written_frames = 0;
+  // and messages / reads how many messages one read took in
+  size_t reads = 0;
+  size_t read_frames = 0;
+};
+
+// An initiator opens its connections at once and starts its games on them round robin, then
+// closes each connection once its games are over. A matched client opens its connections to a server
+// the same way, but asks for its games round robin and starts each once the server has made it. A listener accepts its connections one after
+// another on one port and starts a game for every game id it hears of. Either way the games are
+// only started here, they are played by whatever threads run the io_service.
+class AsyncGameHost{
+public:
+  AsyncGameHost(asio::io_service & io_service, const AsyncHostSetting & setting):
+    io_service_(io_service),
+    setting_(setting),
+    acceptor_(io_service){
+  }
+
+  // a listener is accepting once this returns, so its peer may connect right away
+  void Start(){
+    switch(setting_.type){
+      case ClientType::kInitiator:
+      case ClientType::kMatched:{
+        tcp::endpoint peer(asio::ip::address::from_string(setting_.peer_ip), setting_.port);
+        for(size_t c = 0; c < setting_.connections; ++c){
+          Connect(peer, c);
+        }
+        break;
+      }
+      case ClientType::kListener:{
+        tcp::endpoint endpoint(tcp::v4(), setting_.port);
+        acceptor_.open(endpoint.protocol());
+        acceptor_.set_option(tcp::acceptor::reuse_address(true));
+        acceptor_.bind(endpoint);
+        acceptor_.listen();
+        if(setting_.connections > 0) AcceptNext();
+        break;
+      }
+      default:{
+        assert(false);
+      }
+    }
+  }
+
+  // the write and read counts are only complete once the io_service has run out of work
+  AsyncHostResult GetResult() const{
+    std::lock_guard<std::mutex> lock(mutex_);
+    AsyncHostResult res = result_;
+    for(const std::shared_ptr<AsyncConnection> & connection : connections_){
+      res.writes += connection->GetWriteNum();
+      res.written_frames += connection->GetWrittenFrameNum();
+      res.reads += connection->GetReadNum();
+      res.read_frames += connection->GetReadFrameNum();
+    }
+    return res;
+  }
+
+  // the port a listener is accepting on, the one the system picked if the setting asked for 0
+  size_t GetPort() const{
+    return acceptor_.local_endpoint().port();
+  }
+
+  // run the io_service on thread_num threads until no game is left
+  static void Run(asio::io_service & io_service, size_t thread_num){
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < thread_num; ++i){
+      threads.emplace_back([&io_service](){
+        io_service.run();
+      });
+    }
+    io_service.run();
+    for(std::thread & thread : threads){
+      thread.join();
+    }
+  }
+
+private:
+  asio::io_service & io_service_;
+  AsyncHostSetting setting_;
+  tcp::acceptor acceptor_;
+  // only touched by the accept chain, one accept is in flight at a time
+  size_t accepted_ = 0;
+
+  mutable std::mutex mutex_;
+  AsyncHostResult result_;
+  std::vector<std::shared_ptr<AsyncConnection>> connections_;
+
+  std::shared_ptr<AsyncConnection> NewConnection(){
+    std::shared_ptr<AsyncConnection> connection = std::make_shared<AsyncConnection>(io_service_, setting_.batch);
+    std::lock_guard<std::mutex> lock(mutex_);
+    connections_.push_back(connection);
+    return connection;
+  }
+
+  void Connect(const tcp::endpoint & peer, size_t index){
+    std::shared_ptr<AsyncConnection> connection = NewConnection();
+    connection->GetRefSocket().async_connect(peer, [this, connection, index](const asio::error_code & ec){
+      size_t games = 0;
+      for(size_t i = index; i < setting_.games; i += setting_.connections){
+        games += 1;
+      }
+      if(ec){
+        Logger("can't connect to the peer: " + ec.message());
+        std::lock_guard<std::mutex> lock(mutex_);
+        result_.broken_off += games;
+        return;
+      }
+      if(setting_.type == ClientType::kMatched){
+        RequestMatches(connection, games);
+        return;
+      }
+      connection->Start(nullptr);
+      for(size_t i = index; i < setting_.games; i += setting_.connections){
+        NewGame(connection, setting_.cli_id, static_cast<GameId>(setting_.first_game_id + i))->Start();
+      }
+      connection->CloseWhenIdle();
+    });
+  }
+
+  // ask for all the games at once, the connection closes once the last one made is over
+  void RequestMatches(const std::shared_ptr<AsyncConnection> & connection, size_t games){
+    if(games == 0){
+      connection->Start(nullptr);
+      connection->CloseWhenIdle();
+      return;
+    }
+    // only touched on the strand of the connection
+    std::shared_ptr<size_t> pending = std::make_shared<size_t>(games);
+    connection->Start([this, pending](const std::shared_ptr<AsyncConnection> & connection, const FrameView & frame){
+      if(frame.type != MessageType::kInfoMatch){
+        Logger("message of unknown game " + std::to_string(frame.game_id) + " dropped");
+        return;
+      }
+      ClientId cli_id = 0;
+      unsigned char strategy = 0;
+      if(!ResolveInfoMatch(frame.GetBody(), frame.GetBodyLength(), &cli_id, &strategy)){
+        Logger("malformed match of game " + std::to_string(frame.game_id) + " dropped");
+        return;
+      }
+      NewGame(connection, cli_id, frame.game_id)->Start();
+      *pending -= 1;
+      if(*pending == 0) connection->CloseWhenIdle();
+    });
+    for(size_t i = 0; i < games; ++i){
+      Frame request;
+      MakeRequestMatch(request.data, &request.length, setting_.cli_id, static_cast<unsigned char>(setting_.attack));
+      connection->AsyncSend(request, [](const asio::error_code &){});
+    }
+  }
+
+  void AcceptNext(){
+    std::shared_ptr<AsyncConnection> connection = NewConnection();
+    acceptor_.async_accept(connection->GetRefSocket(), [this, connection](const asio::error_code & ec){
+      accepted_ += 1;
+      if(!ec){
+        connection->Start([this](const std::shared_ptr<AsyncConnection> & connection, const FrameView & frame){
+          if(IsMatchmakingMessage(frame.type)) return;
+          NewGame(connection, setting_.cli_id, frame.game_id)->Start();
+        });
+      }else{
+        Logger("can't accept a connection: " + ec.message());
+      }
+      if(!ec && accepted_ < setting_.connections){
+        AcceptNext();
+        return;
+      }
+      asio::error_code ignored;
+      acceptor_.close(ignored);
+    });
+  }
+
+  std::shared_ptr<AsyncGameClient> NewGame(const std::shared_ptr<AsyncConnection> & connection, ClientId cli_id, GameId game_id){
+    return std::make_shared<AsyncGameClient>(connection, cli_id, game_id, setting_.attack,
+                                             [this](const AsyncGameResult & res){
+      std::lock_guard<std::mutex> lock(mutex_);
+      if(res.finished){
+        result_.finished += 1;
+        result_.moves += res.num_moves;
+        if(res.does_win) result_.wins += 1;
+      }else{
+        result_.broken_off += 1;
+      }
+    });
+  }
+};
+
+#endif //BATTLESHIP_CLIENT_ASYNC_GAME_HOST_H
@@ -10,18 +10,33 @@
 #include "core/game/game_common.h"
 #include "core/game/board.h"
 #include "core/game/imagine_board.h"
-#include "client/client_talker.h"
 #include "ai/ship_placement_unit.h"
 #include "ai/attack_location_unit.h"
 
-class ClientBrain{
+template<typename Rules>
+class BasicClientBrain{
 public:
-  ClientBrain(Board& client_board):
+  typedef BasicBoard<Rules> Board;
+  typedef BasicImagineBoard<Rules> ImagineBoard;
+  typedef BasicProbabilityBoard<Rules> ProbabilityBoard;
+  typedef BasicShipPlacementUnit<Rules> ShipPlacementUnit;
+  typedef BasicAttackLocationUnit<Rules> AttackLocationUnit;
+  typedef typename ShipPlacementUnit::ShipPlacingPlanList ShipPlacingPlanList;
+
+  BasicClientBrain(Board& client_board):
     my_board_(client_board),
     attack_location_unit_(enemy_board_){
   }
 
-  std::vector<ShipPlacementInfo> GenerateShipPlacingPlan(const StrategyPlaceShip& strategy){
+  // takes over what another brain knows of its enemy, it stays the brain of its own board
+  BasicClientBrain & operator=(const BasicClientBrain & other){
+    enemy_board_ = other.enemy_board_;
+    ship_placement_unit_ = other.ship_placement_unit_;
+    attack_location_unit_ = other.attack_location_unit_;
+    return *this;
+  }
+
+  ShipPlacingPlanList GenerateShipPlacingPlan(const StrategyPlaceShip& strategy){
     return ship_placement_unit_.ShipPlacingPlan(strategy);
   }
 
@@ -58,4 +73,6 @@ private:
   AttackLocationUnit attack_location_unit_;
 };
 
+typedef BasicClientBrain<ClassicRules> ClientBrain;
+
 #endif  // CLIENT_CLIENT_BRAIN_H_
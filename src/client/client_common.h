@@ -3,18 +3,59 @@
 #ifndef CLIENT_CLIENT_COMMON_H_
 #define CLIENT_CLIENT_COMMON_H_
 
+#include <string>
+
 typedef unsigned int ClientId;
 typedef unsigned int GameId;
 
 
 enum class ClientType{
   kInitiator,
-  kListener
+  kListener,
+  // asks a server for games and plays whatever it is matched to
+  kMatched
+};
+
+enum class ClientState {
+  kStarted,
+  kConnected,
+  kReady,
+  kFire,
+  kWait,
+  kEndGame
 };
 
+static std::string ClientStateToString(const ClientState state){
+  switch(state){
+    case ClientState::kStarted:{
+      return "kStarted";
+    }
+    case ClientState::kConnected:{
+      return "kConnected";
+    }
+    case ClientState::kReady:{
+      return "kReady";
+    }
+    case ClientState::kFire:{
+      return "kFire";
+    }
+    case ClientState::kWait:{
+      return "kWait";
+    }
+    case ClientState::kEndGame:{
+      return "kEndGame";
+    }
+    default:{
+      return "UnknownState";
+    }
+  }
+}
+
 class ClientTalker;
-class ClientBrain;
+class AsyncClientTalker;
+template<typename Rules> class BasicClientBrain;
 class GameClient;
+class AsyncGameClient;
 
 
 #endif  // CLIENT_CLIENT_COMMON_H_
@@ -7,17 +7,22 @@
 #include <string>
 #include "core/game/game_common.h"
 #include "core/networking/networking.h"
+#include "core/networking/frame_codec.h"
 #include "client/client_common.h"
+#include "utils/histogram.h"
 
 using asio::ip::tcp;
 
 // This object will handle all network requests & response to & from the server
 class ClientTalker{
 public:
-  ClientTalker(const ClientType & cli_type, const std::string & peer_ip, const std::size_t & port, const ClientId & cli_id, const GameId & game_id):
+  // every read of the socket is counted in socket_reads
+  ClientTalker(const ClientType & cli_type, const std::string & peer_ip, const std::size_t & port, const ClientId & cli_id, const GameId & game_id,
+               EventCounter & socket_reads):
     tcp_sock_(io_service_),
     cli_id_(cli_id),
-    game_id_(game_id){
+    game_id_(game_id),
+    socket_reads_(socket_reads){
       switch (cli_type) {
         case ClientType::kInitiator:{
           ConnectToPeer(peer_ip, port);
@@ -39,11 +44,15 @@ public:
     MakeInfoGameId(buffer, &message_length, cli_id_, game_id_);
     asio::write(tcp_sock_, asio::buffer(buffer, message_length));
 
-    std::size_t length = EnsureMessageTypeAndGetBodyLength(MessageType::kInfoGameId);
-    asio::read(tcp_sock_, asio::buffer(buffer, length));
+    FrameView frame = ReceiveFrame(MessageType::kInfoGameId);
     ClientId cli_id;
     GameId game_id;
-    ResolveInfoGameId(buffer, length, &cli_id, &game_id);
+    unsigned char version = 0;
+    CheckResolved(ResolveInfoGameId(frame.GetBody(), frame.GetBodyLength(), &cli_id, &game_id, &version));
+    if(version != kWireVersion){
+      Logger("peer talks wire version " + std::to_string(version));
+      assert(false);
+    }
     // TODO: maybe we don't need cli_id
     return game_id;
   }
@@ -54,11 +63,10 @@ public:
     MakeInfoReady(buffer, &message_length, cli_id_, game_id_);
     asio::write(tcp_sock_, asio::buffer(buffer, message_length));
 
-    std::size_t length = EnsureMessageTypeAndGetBodyLength(MessageType::kInfoReady);
-    asio::read(tcp_sock_, asio::buffer(buffer, length));
+    FrameView frame = ReceiveFrame(MessageType::kInfoReady);
     ClientId cli_id;
     GameId game_id;
-    ResolveInfoReady(buffer, length, &cli_id, &game_id);
+    CheckResolved(ResolveInfoReady(frame.GetBody(), frame.GetBodyLength(), &cli_id, &game_id));
     // TODO: maybe we don't need cli_id and game_id?
     // or maybe we can add a verification here.
   }
@@ -72,12 +80,11 @@ public:
     MakeInfoRoll(buffer, &message_length, cli_id_, game_id_, my_num);
     asio::write(tcp_sock_, asio::buffer(buffer, message_length));
 
-    std::size_t length = EnsureMessageTypeAndGetBodyLength(MessageType::kInfoRoll);
-    asio::read(tcp_sock_, asio::buffer(buffer, length));
+    FrameView frame = ReceiveFrame(MessageType::kInfoRoll);
     ClientId cli_id;
     GameId game_id;
     unsigned long oppo_num;
-    ResolveInfoRoll(buffer, length, &cli_id, &game_id, &oppo_num);
+    CheckResolved(ResolveInfoRoll(frame.GetBody(), frame.GetBodyLength(), &cli_id, &game_id, &oppo_num));
 
     // TODO only for now
     assert(my_num != oppo_num);
@@ -92,26 +99,22 @@ public:
     MakeRequestAttack(request, &request_length, cli_id_, game_id_, location);
     asio::write(tcp_sock_, asio::buffer(request, request_length));
 
-    std::size_t length = EnsureMessageTypeAndGetBodyLength(MessageType::kReplyAttack);
-    unsigned char reply_body[kMaxBufferLength];
-    asio::read(tcp_sock_, asio::buffer(reply_body, length));
+    FrameView reply = ReceiveFrame(MessageType::kReplyAttack);
     bool success = false;
     ShipType sink_ship_type = kNotAShip;
     bool attacker_win = false;
-    ResolveReplyAttack(reply_body, length, &success, &sink_ship_type, &attacker_win);
+    CheckResolved(ResolveReplyAttack(reply.GetBody(), reply.GetBodyLength(), &success, &sink_ship_type, &attacker_win));
 
     return AttackResult(location, success, sink_ship_type, attacker_win);
   }
 
   size_t GetEnemyMove(){
     // get one enemy move
-    std::size_t length = EnsureMessageTypeAndGetBodyLength(MessageType::kRequestAttack);
-    unsigned char request_body[kMaxBufferLength];
-    asio::read(tcp_sock_, asio::buffer(request_body, length));
+    FrameView request = ReceiveFrame(MessageType::kRequestAttack);
     ClientId client_id = 0;
     GameId game_id = 0;
     size_t location = 0;
-    ResolveRequestAttack(request_body, length, &client_id, &game_id, &location);
+    CheckResolved(ResolveRequestAttack(request.GetBody(), request.GetBodyLength(), &client_id, &game_id, &location));
     return location;
   }
 
@@ -119,7 +122,7 @@ public:
     // send attack reply to peer
     unsigned char reply[kMaxBufferLength];
     std::size_t reply_length = 0;
-    MakeReplyAttack(reply, &reply_length, success, type, attacker_win);
+    MakeReplyAttack(reply, &reply_length, game_id_, success, type, attacker_win);
     asio::write(tcp_sock_, asio::buffer(reply, reply_length));
   }
 
@@ -132,6 +135,10 @@ private:
   // the unique game id, this should be given in cmd
   GameId game_id_;
 
+  FrameDecoder decoder_;
+
+  EventCounter & socket_reads_;
+
   void ConnectToPeer(const std::string & peer_ip, const std::size_t & port){
     tcp::endpoint peer(asio::ip::address::from_string(peer_ip), port);
     try{
@@ -148,21 +155,33 @@ private:
     acceptor.accept(tcp_sock_);
   }
 
-  std::size_t EnsureMessageTypeAndGetBodyLength(MessageType type){
-    unsigned char reply_type[1];
-    asio::read(tcp_sock_, asio::buffer(reply_type, 1));
-    if(reply_type[0] != static_cast<unsigned char>(type)){
+  // the next message, which has to be of type. a read takes in whatever the peer sent so far,
+  // the messages after this one wait in the decoder for the next call.
+  FrameView ReceiveFrame(MessageType type){
+    FrameView frame;
+    while(!decoder_.NextFrame(&frame)){
+      assert(!decoder_.IsBroken());
+      decoder_.CommitRead(tcp_sock_.read_some(decoder_.PrepareRead()));
+      socket_reads_.Add();
+    }
+    if(frame.type != type){
       Logger("unexpected reply type");
       assert(false);
     }
+    // this connection only carries our own game
+    assert(frame.game_id == game_id_);
 
-    unsigned char reply_length[1];
-    asio::read(tcp_sock_, asio::buffer(reply_length, 1));
-    assert(static_cast<std::size_t>(reply_length[0]) < kMaxBufferLength);
+    if(IsLogged(LogLevel::kDebug)) LogDebug("Message Received. type = " + MessageTypeToString(type));
 
-    Logger("Message Received. type = " + MessageTypeToString(type));
+    return frame;
+  }
 
-    return static_cast<std::size_t>(reply_length[0]);
+  // a message cut short is as fatal as one of the wrong type
+  static void CheckResolved(bool resolved){
+    if(!resolved){
+      Logger("malformed message");
+      assert(false);
+    }
   }
 
 };
@@ -8,54 +8,23 @@
 #include <iostream>
 #include "client/client_common.h"
 #include "client/client_talker.h"
+#include "client/game_metrics.h"
+#include "client/game_snapshot.h"
+#include "client/pacing.h"
 #include "client_brain.h"
 #include "core/game/board.h"
 #include "utils/utils.h"
 
-enum class ClientState {
-  kStarted,
-  kConnected,
-  kReady,
-  kFire,
-  kWait,
-  kEndGame
-};
-
-static std::string ClientStateToString(const ClientState state){
-  switch(state){
-    case ClientState::kStarted:{
-      return "kStarted";
-    }
-    case ClientState::kConnected:{
-      return "kConnected";
-    }
-    case ClientState::kReady:{
-      return "kReady";
-    }
-    case ClientState::kFire:{
-      return "kFire";
-    }
-    case ClientState::kWait:{
-      return "kWait";
-    }
-    case ClientState::kEndGame:{
-      return "kEndGame";
-    }
-    default:{
-      return "UnknownState";
-    }
-  }
-}
-
 class GameClient {
 public:
   GameClient(const ClientType &type, const std::string &peer_ip, const std::size_t &port, const ClientId &cli_id,
-             const GameId &game_id, pthread_t main_thread) :
+             const GameId &game_id, const PacingSetting &pacing, pthread_t main_thread) :
     cli_type_(type),
     cli_id_(cli_id),
     game_id_(game_id),
-    cli_talker_(type, peer_ip, port, cli_id, game_id),
+    cli_talker_(type, peer_ip, port, cli_id, game_id, metrics_.Counter(GameCounter::kSocketReads)),
     cli_brain_{my_board_},
+    pacer_(pacing),
     state_(ClientState::kStarted),
     main_thread_(main_thread){
 
@@ -90,7 +59,7 @@ public:
           break;
         }
         case ClientState::kFire: {
-          std::this_thread::sleep_for(std::chrono::milliseconds(100));
+          pacer_.WaitForTurn();
           bool win = MakeOneMove();
           if (win) {
             is_winner_me_ = true;
@@ -102,7 +71,6 @@ public:
           break;
         }
         case ClientState::kWait: {
-          std::this_thread::sleep_for(std::chrono::milliseconds(100));
           bool lose = WaitForEnemyAndReplyWithResult();
           if (lose) {
             is_winner_me_ = false;
@@ -116,6 +84,7 @@ public:
         case ClientState::kEndGame: {
           Logger("game over.");
           SetWinnerLoserOnBoards();
+          PublishSnapshot();
           OutputResultAndExit();
           return;
         }
@@ -138,14 +107,31 @@ public:
     return cli_brain_.GetRefProbBoard();
   }
 
+  Pacer& GetRefPacer(){
+    return pacer_;
+  }
+
+  // the only way another thread may look at the game
+  GameSnapshotBuffer& GetRefSnapshots(){
+    return snapshots_;
+  }
+
+  GameMetrics& GetRefMetrics(){
+    return metrics_;
+  }
+
 private:
   const ClientType &cli_type_;
   const ClientId &cli_id_;
   const GameId &game_id_;
 
+  // before the talker, which counts into it from its making
+  GameMetrics metrics_;
   Board my_board_;
   ClientTalker cli_talker_;
   ClientBrain cli_brain_;
+  Pacer pacer_;
+  GameSnapshotBuffer snapshots_;
 
   bool is_winner_me_ = false;
 
@@ -158,7 +144,15 @@ private:
 
   void ChangeStateTo(ClientState new_state) {
     Logger(ClientStateToString(state_) + " change to " + ClientStateToString(new_state));
+    metrics_.ChangeState(new_state);
     state_ = new_state;
+    PublishSnapshot();
+  }
+
+  // a copy of the boards for the ui, taken between moves so it is never half a move
+  void PublishSnapshot(){
+    snapshots_.GetBack().Capture(my_board_, cli_brain_.GetRefEnemyBoard(), cli_brain_.GetRefProbBoard());
+    snapshots_.Publish();
   }
 
 
@@ -167,7 +161,7 @@ private:
   }
 
   void PlaceShips() {
-    std::vector<ShipPlacementInfo> plan = cli_brain_.GenerateShipPlacingPlan(StrategyPlaceShip::kRandom);
+    ShipPlacingPlanList plan = cli_brain_.GenerateShipPlacingPlan(StrategyPlaceShip::kRandom);
     for (auto placement : plan) {
       // TODO place ship may fail, but only if the brain generated a faulty plan
       // brain should be responsible for the error-free placement plan.
@@ -190,8 +184,21 @@ private:
     // increment my move number by one
     my_board_.IncrementOneMove();
 
-    AttackResult res = cli_talker_.Attack(cli_brain_.GenerateNextAttackLocation(StrategyAttack::kDFSProbability));
-    cli_brain_.DigestAttackResult(res);
+    const StrategyAttack strategy = StrategyAttack::kDFSProbability;
+    size_t location = 0;
+    {
+      ScopedTimer timer(metrics_.GenerateAttack(strategy));
+      location = cli_brain_.GenerateNextAttackLocation(strategy);
+    }
+    AttackResult res(location, false, kNotAShip, false);
+    {
+      ScopedTimer timer(metrics_.Phase(GamePhase::kAttackWait));
+      res = cli_talker_.Attack(location);
+    }
+    {
+      ScopedTimer timer(metrics_.Phase(GamePhase::kDigestResult));
+      cli_brain_.DigestAttackResult(res);
+    }
     if (res.attacker_win) return true;
     return false;
   }
@@ -201,7 +208,12 @@ private:
     // increment enemy move number by one
     GetRefEnemyBoard().IncrementOneMove();
 
-    AttackResult res = my_board_.Attack(cli_talker_.GetEnemyMove());
+    size_t location = 0;
+    {
+      ScopedTimer timer(metrics_.Phase(GamePhase::kEnemyMoveWait));
+      location = cli_talker_.GetEnemyMove();
+    }
+    AttackResult res = my_board_.Attack(location);
     cli_talker_.SendAttackResult(res.success, res.sink_ship_type, res.attacker_win);
     if (res.attacker_win) return true;
     return false;
@@ -218,8 +230,20 @@ private:
     }
   }
 
+  // a line for every histogram and counter of the game
+  void LogMetrics() {
+    if (!kInstrumented) return;
+    metrics_.ForEachHistogram([this](const std::string &name, const LatencyHistogram &histogram) {
+      LogLatency(cli_id_, game_id_, name, histogram);
+    });
+    metrics_.ForEachCounter([this](const std::string &name, std::uint64_t value) {
+      LogCounter(cli_id_, game_id_, name, value);
+    });
+  }
+
   void OutputResultAndExit() {
     LogResult(cli_id_, game_id_, is_winner_me_, my_board_.GetNumMoves());
+    LogMetrics();
 
 #ifdef CLEAN_EXIT
     exit(0);
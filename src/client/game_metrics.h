@@ -0,0 +1,179 @@
+//
+// Where the time of a game goes: latency histograms of the moves, the network waits and the client states.
+//
+
+#ifndef BATTLESHIP_CLIENT_GAME_METRICS_H
+#define BATTLESHIP_CLIENT_GAME_METRICS_H
+
+#include <chrono>
+#include <string>
+#include "ai/attack_location_unit.h"
+#include "client/client_common.h"
+#include "utils/histogram.h"
+
+// what a move is made of, the compute of the brain apart from the waits on the peer
+enum class GamePhase{
+  // the brain taking in the reply to its attack
+  kDigestResult,
+  // from sending an attack to its reply
+  kAttackWait,
+  // from the end of my move to the enemy's attack
+  kEnemyMoveWait
+};
+
+static std::string GamePhaseToString(const GamePhase phase){
+  switch(phase){
+    case GamePhase::kDigestResult:{
+      return "digest_result";
+    }
+    case GamePhase::kAttackWait:{
+      return "attack_wait";
+    }
+    case GamePhase::kEnemyMoveWait:{
+      return "enemy_move_wait";
+    }
+    default:{
+      return "unknown";
+    }
+  }
+}
+
+enum class GameCounter{
+  // reads of the socket, a message may take more than one and a read more than one message
+  kSocketReads
+};
+
+static std::string GameCounterToString(const GameCounter counter){
+  switch(counter){
+    case GameCounter::kSocketReads:{
+      return "socket_reads";
+    }
+    default:{
+      return "unknown";
+    }
+  }
+}
+
+// The histograms and counters of one game, in nanoseconds. The game thread records, any thread may read.
+template<bool Instrumented>
+class BasicGameMetrics{
+public:
+  static const std::size_t kPhaseNum = 3;
+  static const std::size_t kCounterNum = 1;
+  static const std::size_t kStateNum = 6;
+
+  BasicGameMetrics():
+    state_(ClientState::kStarted),
+    state_entered_(std::chrono::steady_clock::now()){
+  }
+
+  LatencyHistogram & Phase(GamePhase phase){
+    return phases_[static_cast<std::size_t>(phase)];
+  }
+
+  // the brain choosing where to attack, for each strategy
+  LatencyHistogram & GenerateAttack(StrategyAttack strategy){
+    return generate_attack_[static_cast<std::size_t>(strategy)];
+  }
+
+  // how long the client stayed in a state, each time
+  LatencyHistogram & State(ClientState state){
+    return states_[static_cast<std::size_t>(state)];
+  }
+
+  EventCounter & Counter(GameCounter counter){
+    return counters_[static_cast<std::size_t>(counter)];
+  }
+
+  // the time since the last change goes to the state left
+  void ChangeState(ClientState new_state){
+    auto now = std::chrono::steady_clock::now();
+    State(state_).Record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - state_entered_).count()));
+    state_ = new_state;
+    state_entered_ = now;
+  }
+
+  // handler(const std::string & name, const LatencyHistogram &) for every histogram with a value in it
+  template<typename Handler>
+  void ForEachHistogram(Handler handler){
+    for(std::size_t i = 0; i < kStrategyAttackNum; ++i){
+      StrategyAttack strategy = static_cast<StrategyAttack>(i);
+      if(GenerateAttack(strategy).GetCount() > 0) handler("generate_attack/" + StrategyAttackToString(strategy), GenerateAttack(strategy));
+    }
+    for(std::size_t i = 0; i < kPhaseNum; ++i){
+      GamePhase phase = static_cast<GamePhase>(i);
+      if(Phase(phase).GetCount() > 0) handler(GamePhaseToString(phase), Phase(phase));
+    }
+    for(std::size_t i = 0; i < kStateNum; ++i){
+      ClientState state = static_cast<ClientState>(i);
+      if(State(state).GetCount() > 0) handler("state/" + ClientStateToString(state), State(state));
+    }
+  }
+
+  // handler(const std::string & name, std::uint64_t value) for every counter
+  template<typename Handler>
+  void ForEachCounter(Handler handler){
+    for(std::size_t i = 0; i < kCounterNum; ++i){
+      GameCounter counter = static_cast<GameCounter>(i);
+      handler(GameCounterToString(counter), Counter(counter).Get());
+    }
+  }
+
+private:
+  LatencyHistogram phases_[kPhaseNum];
+  LatencyHistogram generate_attack_[kStrategyAttackNum];
+  LatencyHistogram states_[kStateNum];
+  EventCounter counters_[kCounterNum];
+
+  ClientState state_;
+  std::chrono::steady_clock::time_point state_entered_;
+};
+
+// Nothing is recorded without instrumentation, so a game holds no histograms: every one it asks for
+// is the same empty one.
+template<>
+class BasicGameMetrics<false>{
+public:
+  static const std::size_t kCounterNum = 1;
+
+  LatencyHistogram & Phase(GamePhase){
+    return Empty();
+  }
+
+  LatencyHistogram & GenerateAttack(StrategyAttack){
+    return Empty();
+  }
+
+  LatencyHistogram & State(ClientState){
+    return Empty();
+  }
+
+  EventCounter & Counter(GameCounter){
+    static EventCounter counter;
+    return counter;
+  }
+
+  void ChangeState(ClientState){
+  }
+
+  template<typename Handler>
+  void ForEachHistogram(Handler){
+  }
+
+  template<typename Handler>
+  void ForEachCounter(Handler handler){
+    for(std::size_t i = 0; i < kCounterNum; ++i){
+      handler(GameCounterToString(static_cast<GameCounter>(i)), std::uint64_t(0));
+    }
+  }
+
+private:
+  static LatencyHistogram & Empty(){
+    static LatencyHistogram histogram;
+    return histogram;
+  }
+};
+
+typedef BasicGameMetrics<kInstrumented> GameMetrics;
+
+#endif //BATTLESHIP_CLIENT_GAME_METRICS_H
@@ -0,0 +1,76 @@
+//
+// What the ui shows of a game, copied out of the boards by the game thread.
+//
+
+#ifndef BATTLESHIP_CLIENT_GAME_SNAPSHOT_H
+#define BATTLESHIP_CLIENT_GAME_SNAPSHOT_H
+
+#include "ai/probability_board.h"
+#include "core/game/board.h"
+#include "core/game/imagine_board.h"
+#include "core/game/ship.h"
+#include "utils/fixed_vector.h"
+#include "utils/triple_buffer.h"
+
+// one side of the game
+template<typename Rules>
+struct BasicBoardSnapshot{
+  // OCCUPIED and ATTACKED flags of every location, as the board has them
+  unsigned char states[Rules::kCellNum] = {};
+  // empty for the enemy, its ships are not known
+  FixedVector<Ship, Rules::kShipNum> ships;
+  std::size_t carrier_num = 0;
+  std::size_t battleship_num = 0;
+  std::size_t cruiser_num = 0;
+  std::size_t destroyer_num = 0;
+  std::size_t move_num = 0;
+  bool is_game_over = false;
+  bool is_winner_me = false;
+};
+
+// Plain values only, the ui thread can read it while the game thread plays on.
+template<typename Rules>
+struct BasicGameSnapshot{
+  typedef BasicBoard<Rules> Board;
+  typedef BasicImagineBoard<Rules> ImagineBoard;
+  typedef BasicProbabilityBoard<Rules> ProbabilityBoard;
+  typedef BasicBoardSnapshot<Rules> BoardSnapshot;
+  static const unsigned char kOccupied = Board::OCCUPIED;
+  static const unsigned char kAttacked = Board::ATTACKED;
+
+  BoardSnapshot my;
+  BoardSnapshot enemy;
+  // 0.0 - 1.0 for every location of the enemy board
+  float probability_scale[Rules::kCellNum] = {};
+
+  // on the game thread, between moves
+  void Capture(const Board & my_board, const ImagineBoard & enemy_board, const ProbabilityBoard & probability_board){
+    for(std::size_t location = 0; location < Rules::kCellNum; ++location){
+      my.states[location] = my_board.GetState(location);
+      enemy.states[location] = enemy_board.GetState(location);
+      probability_scale[location] = probability_board.GetProbabilityScale(location);
+    }
+    my.ships = my_board.on_board_ships_;
+    my.carrier_num = my_board.carrier_num_;
+    my.battleship_num = my_board.battleship_num_;
+    my.cruiser_num = my_board.cruiser_num_;
+    my.destroyer_num = my_board.destroyer_num_;
+    my.move_num = my_board.move_num_;
+    my.is_game_over = my_board.is_game_over_;
+    my.is_winner_me = my_board.is_winner_me_;
+    enemy.carrier_num = enemy_board.carrier_num_;
+    enemy.battleship_num = enemy_board.battleship_num_;
+    enemy.cruiser_num = enemy_board.cruiser_num_;
+    enemy.destroyer_num = enemy_board.destroyer_num_;
+    enemy.move_num = enemy_board.move_num_;
+    enemy.is_game_over = enemy_board.is_game_over_;
+    enemy.is_winner_me = enemy_board.is_winner_me_;
+  }
+};
+
+typedef BasicGameSnapshot<ClassicRules> GameSnapshot;
+
+// published by the game thread after every change of state, read by the ui every frame
+typedef TripleBuffer<GameSnapshot> GameSnapshotBuffer;
+
+#endif //BATTLESHIP_CLIENT_GAME_SNAPSHOT_H
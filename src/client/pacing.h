@@ -0,0 +1,114 @@
+//
+// How fast a client makes its moves: as fast as it can, a fixed delay apart, or one a frame of the ui.
+//
+
+#ifndef BATTLESHIP_CLIENT_PACING_H
+#define BATTLESHIP_CLIENT_PACING_H
+
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+enum class PacingMode{
+  // no wait at all, for benchmarks
+  kUnpaced,
+  // a fixed delay before every move, for demos
+  kFixed,
+  // a move a frame the ui presents, the ui swaps buffers on vsync
+  kVsync
+};
+
+static bool PacingModeFromString(const std::string & name, PacingMode* mode){
+  if(name == "unpaced") *mode = PacingMode::kUnpaced;
+  else if(name == "fixed") *mode = PacingMode::kFixed;
+  else if(name == "vsync") *mode = PacingMode::kVsync;
+  else return false;
+  return true;
+}
+
+static std::string PacingModeToString(const PacingMode mode){
+  switch(mode){
+    case PacingMode::kUnpaced:{
+      return "unpaced";
+    }
+    case PacingMode::kFixed:{
+      return "fixed";
+    }
+    case PacingMode::kVsync:{
+      return "vsync";
+    }
+    default:{
+      return "unknown";
+    }
+  }
+}
+
+struct PacingSetting{
+  // 100ms a move, as the client always went
+  PacingMode mode = PacingMode::kFixed;
+  // only for kFixed
+  size_t delay_ms = 100;
+};
+
+// The game thread waits on it before every move of its own, the ui thread tells it of every frame.
+// The moves of the enemy are paced by the enemy, waiting for them needs no delay.
+class Pacer{
+public:
+  // a vsync pacer without a ui, or with the window closed, moves this often
+  static const int kFrameTimeoutMs = 100;
+
+  explicit Pacer(const PacingSetting & setting):
+    setting_(setting){
+  }
+
+  // returns when the next move may be made
+  void WaitForTurn(){
+    switch(setting_.mode){
+      case PacingMode::kUnpaced:{
+        break;
+      }
+      case PacingMode::kFixed:{
+        std::this_thread::sleep_for(std::chrono::milliseconds(setting_.delay_ms));
+        break;
+      }
+      case PacingMode::kVsync:{
+        // a copy, a reference to the constant would need a definition of it
+        const int timeout_ms = kFrameTimeoutMs;
+        std::unique_lock<std::mutex> lock(mutex_);
+        std::uint64_t seen = frames_;
+        frame_presented_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this, seen](){
+          return frames_ != seen;
+        });
+        break;
+      }
+      default:{
+        assert(false);
+      }
+    }
+  }
+
+  // the ui presented a frame
+  void OnFrame(){
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      frames_ += 1;
+    }
+    frame_presented_.notify_all();
+  }
+
+  const PacingSetting & GetSetting() const{
+    return setting_;
+  }
+
+private:
+  PacingSetting setting_;
+  std::mutex mutex_;
+  std::condition_variable frame_presented_;
+  std::uint64_t frames_ = 0;
+};
+
+#endif //BATTLESHIP_CLIENT_PACING_H
@@ -0,0 +1,276 @@
+// Bit set over the locations of a board
+
+#ifndef CORE_GAME_BITBOARD_H_
+#define CORE_GAME_BITBOARD_H_
+
+#include <cstdint>
+#include <cstring>
+#include "core/game/game_common.h"
+
+// one bit per location, location i lives in bit (i % 64) of word (i / 64).
+// bits past CellNum are always zero.
+template<std::size_t CellNum>
+class BasicBitBoard{
+public:
+  typedef BasicBitBoard BitBoard;
+  static const std::size_t kWordBits = 64;
+  static const std::size_t kWordNum = (CellNum + kWordBits - 1) / kWordBits;
+
+  BasicBitBoard(){
+    std::memset(words_, 0, sizeof(words_));
+  }
+
+  static BitBoard Full(){
+    BitBoard res;
+    for(std::size_t i = 0; i < CellNum; ++i){
+      res.Set(i);
+    }
+    return res;
+  }
+
+  void Set(std::size_t location){
+    words_[location / kWordBits] |= Bit(location);
+  }
+
+  void Reset(std::size_t location){
+    words_[location / kWordBits] &= ~Bit(location);
+  }
+
+  bool Test(std::size_t location) const{
+    return (words_[location / kWordBits] & Bit(location)) != 0;
+  }
+
+  bool Any() const{
+    for(std::size_t i = 0; i < kWordNum; ++i){
+      if(words_[i] != 0) return true;
+    }
+    return false;
+  }
+
+  bool Intersects(const BitBoard & other) const{
+    for(std::size_t i = 0; i < kWordNum; ++i){
+      if((words_[i] & other.words_[i]) != 0) return true;
+    }
+    return false;
+  }
+
+  std::size_t Count() const{
+    std::size_t res = 0;
+    for(std::size_t i = 0; i < kWordNum; ++i){
+      res += __builtin_popcountll(words_[i]);
+    }
+    return res;
+  }
+
+  // location of the n-th (0 based) set bit, CellNum if there are not that many
+  std::size_t NthSetBit(std::size_t n) const{
+    for(std::size_t i = 0; i < kWordNum; ++i){
+      std::size_t count = __builtin_popcountll(words_[i]);
+      if(n < count){
+        std::uint64_t word = words_[i];
+        for(std::size_t j = 0; j < n; ++j){
+          word &= word - 1;
+        }
+        return i * kWordBits + __builtin_ctzll(word);
+      }
+      n -= count;
+    }
+    return CellNum;
+  }
+
+  // call f(location) for every set bit, in ascending order
+  template<typename F>
+  void ForEach(F f) const{
+    for(std::size_t i = 0; i < kWordNum; ++i){
+      std::uint64_t word = words_[i];
+      while(word != 0){
+        f(i * kWordBits + __builtin_ctzll(word));
+        word &= word - 1;
+      }
+    }
+  }
+
+  BitBoard & operator|=(const BitBoard & other){
+    for(std::size_t i = 0; i < kWordNum; ++i){
+      words_[i] |= other.words_[i];
+    }
+    return *this;
+  }
+
+  BitBoard & operator&=(const BitBoard & other){
+    for(std::size_t i = 0; i < kWordNum; ++i){
+      words_[i] &= other.words_[i];
+    }
+    return *this;
+  }
+
+  BitBoard operator|(const BitBoard & other) const{
+    BitBoard res = *this;
+    res |= other;
+    return res;
+  }
+
+  BitBoard operator&(const BitBoard & other) const{
+    BitBoard res = *this;
+    res &= other;
+    return res;
+  }
+
+  // this & ~other
+  BitBoard AndNot(const BitBoard & other) const{
+    BitBoard res;
+    for(std::size_t i = 0; i < kWordNum; ++i){
+      res.words_[i] = words_[i] & ~other.words_[i];
+    }
+    return res;
+  }
+
+  // bit i of the result is bit i + k of this
+  BitBoard ShiftTowardsLow(std::size_t k) const{
+    BitBoard res;
+    std::size_t word_shift = k / kWordBits;
+    std::size_t bit_shift = k % kWordBits;
+    for(std::size_t i = 0; i + word_shift < kWordNum; ++i){
+      res.words_[i] = words_[i + word_shift] >> bit_shift;
+      if(bit_shift != 0 && i + word_shift + 1 < kWordNum){
+        res.words_[i] |= words_[i + word_shift + 1] << (kWordBits - bit_shift);
+      }
+    }
+    return res;
+  }
+
+  // bit i + k of the result is bit i of this, bits pushed past the board are dropped
+  BitBoard ShiftTowardsHigh(std::size_t k) const{
+    BitBoard res;
+    std::size_t word_shift = k / kWordBits;
+    std::size_t bit_shift = k % kWordBits;
+    for(std::size_t i = word_shift; i < kWordNum; ++i){
+      res.words_[i] = words_[i - word_shift] << bit_shift;
+      if(bit_shift != 0 && i > word_shift){
+        res.words_[i] |= words_[i - word_shift - 1] >> (kWordBits - bit_shift);
+      }
+    }
+    res.ClearPastBoard();
+    return res;
+  }
+
+  std::uint64_t GetWord(std::size_t i) const{
+    return words_[i];
+  }
+
+  bool operator==(const BitBoard & other) const{
+    for(std::size_t i = 0; i < kWordNum; ++i){
+      if(words_[i] != other.words_[i]) return false;
+    }
+    return true;
+  }
+
+private:
+  std::uint64_t words_[kWordNum];
+
+  static std::uint64_t Bit(std::size_t location){
+    return static_cast<std::uint64_t>(1) << (location % kWordBits);
+  }
+
+  void ClearPastBoard(){
+    std::size_t used_bits = CellNum - (kWordNum - 1) * kWordBits;
+    if(used_bits < kWordBits){
+      words_[kWordNum - 1] &= (static_cast<std::uint64_t>(1) << used_bits) - 1;
+    }
+  }
+};
+
+typedef BasicBitBoard<ClassicRules::kCellNum> BitBoard;
+
+static std::size_t DirectionIndex(Direction direction){
+  switch(direction){
+    case kVertical:{
+      return 0;
+    }
+    case kHorisontal:{
+      return 1;
+    }
+    default:{
+      assert(false);
+      return 0;
+    }
+  }
+}
+
+// masks of every (ShipType, head location, Direction), built once per rules.
+// a placement that would leave the board has an empty mask and is not in bound.
+template<typename Rules>
+class BasicPlacementMasks{
+public:
+  typedef BasicPlacementMasks PlacementMasks;
+  typedef BasicBitBoard<Rules::kCellNum> BitBoard;
+  static const std::size_t kDim = Rules::kDim;
+
+  static const PlacementMasks & Get(){
+    static const PlacementMasks masks;
+    return masks;
+  }
+
+  bool InBound(ShipType type, std::size_t head_location, Direction direction) const{
+    return head_location < kDim * kDim && in_bound_[type][head_location][DirectionIndex(direction)];
+  }
+
+  const BitBoard & Mask(ShipType type, std::size_t head_location, Direction direction) const{
+    return masks_[type][head_location][DirectionIndex(direction)];
+  }
+
+  // head locations of every in-bound placement of the type in the direction
+  const BitBoard & LegalHeads(ShipType type, Direction direction) const{
+    return legal_heads_[type][DirectionIndex(direction)];
+  }
+
+  // the up to four locations next to the given one, without wrapping around rows
+  const BitBoard & SurroundingFour(std::size_t location) const{
+    return surrounding_four_[location];
+  }
+
+private:
+  BitBoard masks_[kShipTypeNum][kDim * kDim][2];
+  bool in_bound_[kShipTypeNum][kDim * kDim][2];
+  BitBoard legal_heads_[kShipTypeNum][2];
+  BitBoard surrounding_four_[kDim * kDim];
+
+  BasicPlacementMasks(){
+    for(std::size_t type = 0; type < kShipTypeNum; ++type){
+      std::size_t size = GetSizeFromType(static_cast<ShipType>(type));
+      for(std::size_t head = 0; head < kDim * kDim; ++head){
+        std::size_t row = head / kDim;
+        std::size_t col = head % kDim;
+
+        in_bound_[type][head][DirectionIndex(kVertical)] = row + size - 1 < kDim;
+        if(row + size - 1 < kDim){
+          legal_heads_[type][DirectionIndex(kVertical)].Set(head);
+          for(std::size_t i = 0; i < size; ++i){
+            masks_[type][head][DirectionIndex(kVertical)].Set(head + i * kDim);
+          }
+        }
+
+        in_bound_[type][head][DirectionIndex(kHorisontal)] = col + size - 1 < kDim;
+        if(col + size - 1 < kDim){
+          legal_heads_[type][DirectionIndex(kHorisontal)].Set(head);
+          for(std::size_t i = 0; i < size; ++i){
+            masks_[type][head][DirectionIndex(kHorisontal)].Set(head + i);
+          }
+        }
+      }
+    }
+
+    for(std::size_t location = 0; location < kDim * kDim; ++location){
+      std::size_t row = location / kDim;
+      std::size_t col = location % kDim;
+      if(col > 0) surrounding_four_[location].Set(location - 1);
+      if(col < kDim - 1) surrounding_four_[location].Set(location + 1);
+      if(row > 0) surrounding_four_[location].Set(location - kDim);
+      if(row < kDim - 1) surrounding_four_[location].Set(location + kDim);
+    }
+  }
+};
+
+typedef BasicPlacementMasks<ClassicRules> PlacementMasks;
+
+#endif  // CORE_GAME_BITBOARD_H_
@@ -10,13 +10,20 @@
 #include "utils/utils.h"
 #include "core/game/ship.h"
 #include "core/game/game_common.h"
+#include "core/game/bitboard.h"
+#include "utils/fixed_vector.h"
 #include "core/exception/exception.h"
 
-class Board{
+template<typename Rules>
+class BasicBoard{
 public:
-  Board(){
-    std::memset(states_, 0, sizeof(char) * kDim * kDim);
-    std::memset(which_ship_, 0, sizeof(Ship*) * kDim * kDim);
+  typedef BasicBitBoard<Rules::kCellNum> BitBoard;
+  typedef BasicPlacementMasks<Rules> PlacementMasks;
+  static const std::size_t kDim = Rules::kDim;
+  static const std::size_t kShipNum = Rules::kShipNum;
+
+  BasicBoard(){
+    std::memset(which_ship_, 0, sizeof(which_ship_));
   }
 
   // place a ship
@@ -26,41 +33,17 @@ public:
     }
 
     // make a ship, append it to the ship list
-    on_board_ships_.push_back(Ship(type));
+    on_board_ships_.emplace_back(type);
     // ref to the new ship
     Ship& new_ship = on_board_ships_.back();
+    unsigned char ship_index = static_cast<unsigned char>(on_board_ships_.size() - 1);
 
-    // place the ship
-    // TODO: possible code duplication
-    std::size_t size = GetSizeFromType(type);
-    std::size_t row = head_location / kDim;
-    std::size_t col = head_location % kDim;
-
-    switch(direction){
-      case kVertical:{
-        // since we checked
-        assert(row + size - 1 < kDim);
-        // turn on OCCUPIED flag, connect the occupied location and the corresponding ship via pointer
-        for(std::size_t i = 0; i < size; i++){
-          states_[head_location + i * kDim] |= OCCUPIED;
-          which_ship_[head_location + i * kDim] = &new_ship;
-        }
-        break;
-      }
-      case kHorisontal:{
-        // since we checked
-        assert(col + size - 1 < kDim);
-        // turn on OCCUPIED flag, connect the occupied location and the corresponding ship via pointer
-        for(std::size_t i = 0; i < size; i++){
-          states_[head_location + i] |= OCCUPIED;
-          which_ship_[head_location + i] = &new_ship;
-        }
-        break;
-      }
-      default:{
-        assert(false);
-      }
-    }
+    // turn on OCCUPIED flag, connect the occupied location and the corresponding ship via its index
+    const BitBoard & mask = PlacementMasks::Get().Mask(type, head_location, direction);
+    occupied_ |= mask;
+    mask.ForEach([this, ship_index](std::size_t location){
+      which_ship_[location] = ship_index;
+    });
 
     new_ship.PlaceShip(head_location, direction);
     AddOneOnBoard(type);
@@ -77,15 +60,15 @@ public:
   AttackResult Attack(std::size_t location){
     // we prohibit player to attack the same spot multiple times
     // it will throw a exception
-    if(states_[location] & ATTACKED){
+    if(attacked_.Test(location)){
       throw GameException::kLocationAlreadyAttacked;
     }
 
-    states_[location] |= ATTACKED;
+    attacked_.Set(location);
 
-    if(states_[location] & OCCUPIED){
+    if(occupied_.Test(location)){
       // get ref of the attacked ship
-      Ship* p_attacked_ship = which_ship_[location];
+      Ship* p_attacked_ship = &on_board_ships_[which_ship_[location]];
       p_attacked_ship -> Damage();
       if(p_attacked_ship -> IsAlive()){
         return AttackResult(location, true, kNotAShip, false);
@@ -119,10 +102,20 @@ public:
     return move_num_;
   }
 
+  bool LocationAttacked(std::size_t location) const{
+    return attacked_.Test(location);
+  }
+
+  // OCCUPIED and ATTACKED flags of one location
+  unsigned char GetState(std::size_t location) const{
+    return (occupied_.Test(location) ? OCCUPIED : 0) | (attacked_.Test(location) ? ATTACKED : 0);
+  }
+
 private:
   // friends
-  friend class GameUi;
-  friend class ShipPlacementUnit;
+  template<typename> friend struct BasicGameSnapshot;
+  template<typename> friend struct BasicGameRecordStats;
+  template<typename> friend class BasicShipPlacementUnit;
 
   bool is_game_over_ = false;
   bool is_winner_me_ = false;
@@ -139,65 +132,39 @@ private:
   static const unsigned char OCCUPIED = 1 << 0;
   static const unsigned char ATTACKED = 1 << 1;
 
-  // ships that on the board
-  std::list<Ship> on_board_ships_;
+  // ships that on the board, in placing order
+  FixedVector<Ship, kShipNum> on_board_ships_;
   // the number of live ships on the board
-  std::size_t ships_alive_;
-  // bit flag indicates the state of one spot
-  unsigned char states_[kDim * kDim];
-  // ship pointers indicates the ship pointer of one spot
-  Ship* which_ship_[kDim * kDim];
+  std::size_t ships_alive_ = 0;
+  // one bit per spot for each of the two states
+  BitBoard occupied_;
+  BitBoard attacked_;
+  // the index in on_board_ships_ of the ship on one spot, an index rather than a pointer so a board copies
+  unsigned char which_ship_[kDim * kDim];
+  static_assert(kShipNum <= 256, "a ship index takes a byte");
 
   // test if the given type ship fits the given place
   bool DoesShipFit(ShipType type, std::size_t head_location, Direction direction){
-    if(head_location >= kDim * kDim) return false;
-
-    // TODO: possible code duplication
-    std::size_t size = GetSizeFromType(type);
-    std::size_t row = head_location / kDim;
-    std::size_t col = head_location % kDim;
-
-    switch(direction){
-      case kVertical:{
-        // boundary check
-        if(row + size - 1 >= kDim) return false;
-        // every subsequential spot should not be occupied
-        for(std::size_t i = 0; i < size; i++){
-          if(states_[head_location + i * kDim] & OCCUPIED) return false;
-        }
-        break;
-      }
-      case kHorisontal:{
-        // boundary check
-        if(col + size - 1 >= kDim) return false;
-        // every subsequential spot should not be occupied
-        for(std::size_t i = 0; i < size; i++){
-          if(states_[head_location + i] & OCCUPIED) return false;
-        }
-        break;
-      }
-      default:{
-        assert(false);
-      }
-    }
-
-    return true;
+    const PlacementMasks & masks = PlacementMasks::Get();
+    if(!masks.InBound(type, head_location, direction)) return false;
+    // every subsequential spot should not be occupied
+    return !masks.Mask(type, head_location, direction).Intersects(occupied_);
   }
 
   // test if there are enough number of certain type of ships on board
   bool CanPlaceMore(ShipType type){
     switch(type){
       case kCarrier:{
-        return carrier_num_ < kCarrierNum;
+        return carrier_num_ < Rules::kCarrierNum;
       }
       case kBattleShip:{
-        return battleship_num_ < kBattleShipNum;
+        return battleship_num_ < Rules::kBattleShipNum;
       }
       case kCruiser:{
-        return cruiser_num_ < kCruiserNum;
+        return cruiser_num_ < Rules::kCruiserNum;
       }
       case kDestroyer:{
-        return destroyer_num_ < kDestroyerNum;
+        return destroyer_num_ < Rules::kDestroyerNum;
       }
       default:{
         assert(false);
@@ -209,22 +176,22 @@ private:
   void AddOneOnBoard(ShipType type){
     switch(type){
       case kCarrier:{
-        assert(carrier_num_ < kCarrierNum);
+        assert(carrier_num_ < Rules::kCarrierNum);
         carrier_num_ += 1;
         break;
       }
       case kBattleShip:{
-        assert(battleship_num_ < kBattleShipNum);
+        assert(battleship_num_ < Rules::kBattleShipNum);
         battleship_num_+= 1;
         break;
       }
       case kCruiser:{
-        assert(cruiser_num_ < kCruiserNum);
+        assert(cruiser_num_ < Rules::kCruiserNum);
         cruiser_num_ += 1;
         break;
       }
       case kDestroyer:{
-        assert(destroyer_num_ < kDestroyerNum);
+        assert(destroyer_num_ < Rules::kDestroyerNum);
         destroyer_num_ += 1;
         break;
       }
@@ -274,6 +241,6 @@ private:
 
 };
 
-
+typedef BasicBoard<ClassicRules> Board;
 
 #endif  // CORE_GAME_BOARD_H_
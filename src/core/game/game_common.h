@@ -3,15 +3,11 @@
 #ifndef CORE_GAME_GAME_COMMON_H_
 #define CORE_GAME_GAME_COMMON_H_
 
-#include <vector>
+#include <array>
 #include "utils/utils.h"
 
 
-static const std::size_t kDim = 10;
-static const std::size_t kCarrierNum = 1;
-static const std::size_t kBattleShipNum = 2;
-static const std::size_t kCruiserNum = 3;
-static const std::size_t kDestroyerNum = 4;
+static const std::size_t kShipTypeNum = 4;
 
 // define Directions
 enum Direction{
@@ -29,6 +25,42 @@ enum ShipType{
   kNotAShip
 };
 
+// The geometry of a game: a Dim x Dim board and the number of ships of every type.
+// Boards and AI units take it as a template parameter, so every variant gets its own
+// constant sized tables and loops.
+template<std::size_t Dim, std::size_t CarrierNum, std::size_t BattleShipNum, std::size_t CruiserNum, std::size_t DestroyerNum>
+struct GameRules{
+  static const std::size_t kDim = Dim;
+  static const std::size_t kCellNum = Dim * Dim;
+  static const std::size_t kCarrierNum = CarrierNum;
+  static const std::size_t kBattleShipNum = BattleShipNum;
+  static const std::size_t kCruiserNum = CruiserNum;
+  static const std::size_t kDestroyerNum = DestroyerNum;
+  static const std::size_t kShipNum = CarrierNum + BattleShipNum + CruiserNum + DestroyerNum;
+
+  // number of ships of the type in a full fleet
+  static constexpr std::size_t GetNumFromType(ShipType type){
+    return type == kCarrier ? CarrierNum
+         : type == kBattleShip ? BattleShipNum
+         : type == kCruiser ? CruiserNum
+         : type == kDestroyer ? DestroyerNum
+         : 0;
+  }
+};
+
+// the game the client, the server and the wire format play
+typedef GameRules<10, 1, 2, 3, 4> ClassicRules;
+// bigger variants, only played in process
+typedef GameRules<15, 1, 3, 4, 5> LargeRules;
+typedef GameRules<20, 2, 4, 6, 8> HugeRules;
+
+static const std::size_t kDim = ClassicRules::kDim;
+static const std::size_t kCarrierNum = ClassicRules::kCarrierNum;
+static const std::size_t kBattleShipNum = ClassicRules::kBattleShipNum;
+static const std::size_t kCruiserNum = ClassicRules::kCruiserNum;
+static const std::size_t kDestroyerNum = ClassicRules::kDestroyerNum;
+static const std::size_t kShipNum = ClassicRules::kShipNum;
+
 struct AttackResult{
   size_t location;
   bool success;
@@ -63,13 +95,22 @@ std::size_t GetSizeFromType(ShipType type){
   }
 }
 
-std::vector<ShipType> GetShipTypeList(){
-  std::vector<ShipType> res;
-  res.emplace_back(ShipType::kCarrier);
-  res.emplace_back(ShipType::kBattleShip);
-  res.emplace_back(ShipType::kCruiser);
-  res.emplace_back(ShipType::kDestroyer);
-  return  res;
+// number of ships of the type in a full classic fleet
+std::size_t GetNumFromType(ShipType type){
+  assert(type != kNotAShip);
+  return ClassicRules::GetNumFromType(type);
+}
+
+static constexpr std::array<ShipType, kShipTypeNum> kShipTypeList = {{
+  ShipType::kCarrier,
+  ShipType::kBattleShip,
+  ShipType::kCruiser,
+  ShipType::kDestroyer
+}};
+
+// every ship type, longest first
+const std::array<ShipType, kShipTypeNum> & GetShipTypeList(){
+  return kShipTypeList;
 }
 
 #endif  // CORE_GAME_GAME_COMMON_H_
@@ -8,19 +8,25 @@
 #include <cstring>
 #include "utils/utils.h"
 #include "ship.h"
+#include "core/game/bitboard.h"
+#include "utils/fixed_vector.h"
 
-class ImagineBoard{
+template<typename Rules>
+class BasicImagineBoard{
 public:
-  ImagineBoard(){
-    std::memset(states_, 0, sizeof(char) * kDim * kDim);
+  typedef BasicBitBoard<Rules::kCellNum> BitBoard;
+  typedef BasicPlacementMasks<Rules> PlacementMasks;
+  static const std::size_t kDim = Rules::kDim;
+
+  BasicImagineBoard(){
   }
 
   void MarkAttack(std::size_t location){
-    states_[location] |= ATTACKED;
+    attacked_.Set(location);
   }
 
   void MarkOccupied(std::size_t location){
-    states_[location] |= OCCUPIED;
+    occupied_.Set(location);
   }
 
   // decrement the on board ship number of given type
@@ -61,34 +67,50 @@ public:
     last_attack_sink_ship_type_ = res.sink_ship_type;
   }
 
-  std::vector<size_t> GetUnAttackedLocations(){
-    std::vector<size_t> res;
-    for(size_t i = 0; i < kDim * kDim; ++i){
-      if(!LocationAttacked(i)){
-        res.emplace_back(i);
-      }
+  // res[0, n) are the un-attacked locations in increasing order, res holds kDim * kDim. returns n.
+  size_t GetUnAttackedLocations(size_t* res) const{
+    size_t n = 0;
+    GetUnAttackedMask().ForEach([res, &n](size_t location){
+      res[n] = location;
+      n += 1;
+    });
+    return n;
+  }
+
+  // un-attacked locations among the (up to) four neighbours of the location,
+  // left, right, up, down, the order dfs always stacked them in
+  FixedVector<size_t, 4> GetSurroundingFourUnAttacked(size_t location) const{
+    FixedVector<size_t, 4> res;
+    BitBoard un_attacked = PlacementMasks::Get().SurroundingFour(location).AndNot(attacked_);
+    // off the board wraps past Rules::kCellNum, and the mask leaves out the other rows' ends
+    const size_t neighbours[] = {location - 1, location + 1, location - kDim, location + kDim};
+    for(size_t neighbour : neighbours){
+      if(neighbour < Rules::kCellNum && un_attacked.Test(neighbour)) res.emplace_back(neighbour);
     }
     return res;
   }
 
-  std::vector<size_t> GetSurroundingFourUnAttacked(size_t location){
-    std::vector<size_t> res;
-    const size_t kDoesntExist = kDim * kDim;
-    size_t left = location > 0 ? location - 1 : kDoesntExist;
-    size_t right = location % kDim < kDim - 1 ? location + 1 : kDoesntExist;
-    size_t up = location / kDim > 0 ? location - kDim : kDoesntExist;
-    size_t down = location / kDim < kDim - 1 ? location + kDim : kDoesntExist;
+  BitBoard GetUnAttackedMask() const{
+    return BitBoard::Full().AndNot(attacked_);
+  }
 
-    if(left != kDoesntExist && !LocationAttacked(left)) res.emplace_back(left);
-    if(right != kDoesntExist && !LocationAttacked(right)) res.emplace_back(right);
-    if(up != kDoesntExist && !LocationAttacked(up)) res.emplace_back(up);
-    if(down != kDoesntExist && !LocationAttacked(down)) res.emplace_back(down);
+  // attacked but not occupied, i.e. every location a ship can't cover
+  BitBoard GetMissedMask() const{
+    return attacked_.AndNot(occupied_);
+  }
 
-    return res;
+  // attacked and occupied
+  const BitBoard & GetHitMask() const{
+    return occupied_;
   }
 
   bool LocationAttacked(size_t location){
-    return states_[location] & ATTACKED;
+    return attacked_.Test(location);
+  }
+
+  // OCCUPIED and ATTACKED flags of one location
+  unsigned char GetState(std::size_t location) const{
+    return (occupied_.Test(location) ? OCCUPIED : 0) | (attacked_.Test(location) ? ATTACKED : 0);
   }
 
   void SetGameOver(){
@@ -108,49 +130,17 @@ public:
   }
 
   bool DoesShipFit(ShipType type, std::size_t head_location, Direction direction){
-    if(head_location >= kDim * kDim) return false;
-
-    // TODO: possible code duplication
-    std::size_t size = GetSizeFromType(type);
-    std::size_t row = head_location / kDim;
-    std::size_t col = head_location % kDim;
-
-    switch(direction){
-      case kVertical:{
-        // boundary check
-        if(row + size - 1 >= kDim) return false;
-        // every subsequential spot should not be (attacked but not occupied)
-        // every subsequential spot should be (not attacked or (occupied))
-        for(std::size_t i = 0; i < size; i++){
-          unsigned char state = states_[head_location + i * kDim];
-          if((state & ATTACKED) && !(state & OCCUPIED)) return false;
-        }
-        break;
-      }
-      case kHorisontal:{
-        // boundary check
-        if(col + size - 1 >= kDim) return false;
-        // every subsequential spot should not be (attacked but not occupied)
-        // every subsequential spot should be (not attacked or (occupied))
-        for(std::size_t i = 0; i < size; i++){
-          unsigned char state = states_[head_location + i];
-          if((state & ATTACKED) && !(state & OCCUPIED)) return false;
-        }
-        break;
-      }
-      default:{
-        assert(false);
-      }
-    }
-
-    return true;
+    const PlacementMasks & masks = PlacementMasks::Get();
+    if(!masks.InBound(type, head_location, direction)) return false;
+    // every subsequential spot should not be (attacked but not occupied)
+    return !masks.Mask(type, head_location, direction).Intersects(GetMissedMask());
   }
 
   // TODO: this can be used to reduce code dup in probability attack module
   size_t GetAliveShipNumber(ShipType type){
     switch(type){
       case ShipType::kCarrier:{
-        return cruiser_num_;
+        return carrier_num_;
       }
       case ShipType::kBattleShip:{
         return battleship_num_;
@@ -169,9 +159,9 @@ public:
 
 private:
   // friends
-  friend class GameUi;
-  friend class AttackLocationUnit;
-  friend class ProbabilityBoard;
+  template<typename> friend struct BasicGameSnapshot;
+  template<typename> friend class BasicAttackLocationUnit;
+  template<typename> friend class BasicProbabilityBoard;
 
   bool is_game_over_ = false;
   bool is_winner_me_ = false;
@@ -179,24 +169,26 @@ private:
   size_t move_num_ = 0;
 
   // ships number currently on board
-  std::size_t carrier_num_ = 1;
-  std::size_t battleship_num_ = 2;
-  std::size_t cruiser_num_ = 3;
-  std::size_t destroyer_num_ = 4;
+  std::size_t carrier_num_ = Rules::kCarrierNum;
+  std::size_t battleship_num_ = Rules::kBattleShipNum;
+  std::size_t cruiser_num_ = Rules::kCruiserNum;
+  std::size_t destroyer_num_ = Rules::kDestroyerNum;
 
   // two bit flags
   static const unsigned char OCCUPIED = 1 << 0;
   static const unsigned char ATTACKED = 1 << 1;
 
-  // bit flag indicates the state of one spot
-  unsigned char states_[kDim * kDim];
+  // one bit per spot for each of the two states
+  BitBoard occupied_;
+  BitBoard attacked_;
 
-  // my brian should remember some stuff
-  size_t last_attack_location_;
-  bool last_attack_success_;
-  ShipType last_attack_sink_ship_type_;
+  // my brian should remember some stuff, nothing attacked yet so DFS has no hit to follow on the first move
+  size_t last_attack_location_ = 0;
+  bool last_attack_success_ = false;
+  ShipType last_attack_sink_ship_type_ = kNotAShip;
 
 };
 
+typedef BasicImagineBoard<ClassicRules> ImagineBoard;
 
 #endif  // CORE_GAME_IMAGINE_BOARD_H_
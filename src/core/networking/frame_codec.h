@@ -0,0 +1,147 @@
+//
+// Splitting a byte stream into messages, in place in a ring buffer the socket reads into.
+//
+
+#ifndef CORE_NETWORKING_FRAME_CODEC_H_
+#define CORE_NETWORKING_FRAME_CODEC_H_
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include "core/networking/networking.h"
+
+// one message still in the buffer it was read into, header included.
+// only good until the next call on the decoder that gave it.
+struct FrameView{
+  MessageType type = MessageType::kRequestAttack;
+  GameId game_id = 0;
+  const unsigned char* data = nullptr;
+  std::size_t length = 0;
+
+  const unsigned char* GetBody() const{
+    return data + kHeaderLength;
+  }
+
+  std::size_t GetBodyLength() const{
+    return length - kHeaderLength;
+  }
+};
+
+// one whole message of its own, header included, for keeping it past the read it came with
+struct Frame{
+  unsigned char data[kMaxBufferLength];
+  std::size_t length = 0;
+
+  Frame() = default;
+
+  explicit Frame(const FrameView & view):
+    length(view.length){
+    std::memcpy(data, view.data, view.length);
+  }
+
+  MessageType GetType() const{
+    return static_cast<MessageType>(data[0]);
+  }
+
+  const unsigned char* GetBody() const{
+    return data + kHeaderLength;
+  }
+
+  unsigned char* GetBody(){
+    return data + kHeaderLength;
+  }
+
+  std::size_t GetBodyLength() const{
+    return length - kHeaderLength;
+  }
+};
+
+// The socket reads straight into the free part of the ring, as much as is there, and
+// NextFrame hands out the messages in it without copying them out. Only a message split by the
+// end of the ring is copied, into a scratch buffer, so it can be handed out in one piece.
+// head_ and tail_ only ever grow, the capacity being a power of two they wrap by masking.
+class FrameDecoder{
+public:
+  // room for many messages, so one read takes in all that a batch of the peer brought
+  static const std::size_t kCapacity = 64 * kMaxBufferLength;
+  static_assert((kCapacity & (kCapacity - 1)) == 0, "the capacity has to be a power of two");
+
+  // the free part of the ring, in two pieces if it wraps, for one scatter read
+  std::array<asio::mutable_buffer, 2> PrepareRead(){
+    if(head_ == tail_){
+      // nothing buffered, start over at the front so the next read is in one piece
+      head_ = 0;
+      tail_ = 0;
+    }
+    std::size_t free_length = kCapacity - (tail_ - head_);
+    std::size_t start = tail_ & kMask;
+    std::size_t first = std::min(free_length, kCapacity - start);
+    return {{asio::buffer(ring_ + start, first), asio::buffer(ring_, free_length - first)}};
+  }
+
+  // bytes were read into what PrepareRead gave
+  void CommitRead(std::size_t bytes){
+    assert(tail_ - head_ + bytes <= kCapacity);
+    tail_ += bytes;
+  }
+
+  // false if no whole message is buffered or the stream is broken
+  bool NextFrame(FrameView* frame){
+    if(broken_ || tail_ - head_ < kHeaderLength) return false;
+    unsigned char type = ring_[head_ & kMask];
+    std::size_t length = kHeaderLength + static_cast<std::size_t>(ring_[(head_ + 1) & kMask]);
+    if(!IsMessageType(type) || length > kMaxBufferLength){
+      broken_ = true;
+      return false;
+    }
+    if(tail_ - head_ < length) return false;
+
+    std::size_t start = head_ & kMask;
+    const unsigned char* data = ring_ + start;
+    if(start + length > kCapacity){
+      std::size_t first = kCapacity - start;
+      std::memcpy(scratch_, ring_ + start, first);
+      std::memcpy(scratch_ + first, ring_, length - first);
+      data = scratch_;
+    }
+    std::size_t body_length = 0;
+    ResolveHeader(data, &frame->type, &body_length, &frame->game_id);
+    frame->data = data;
+    frame->length = length;
+    head_ += length;
+    return true;
+  }
+
+  // handler(const FrameView &) for every whole message buffered, returns how many there were
+  template<typename Handler>
+  std::size_t ParseFrames(Handler handler){
+    std::size_t num = 0;
+    FrameView frame;
+    while(NextFrame(&frame)){
+      handler(frame);
+      num += 1;
+    }
+    return num;
+  }
+
+  // a message of unknown type or too long for a buffer came in, nothing after it can be trusted
+  bool IsBroken() const{
+    return broken_;
+  }
+
+  std::size_t GetBufferedLength() const{
+    return tail_ - head_;
+  }
+
+private:
+  static const std::size_t kMask = kCapacity - 1;
+
+  unsigned char ring_[kCapacity];
+  unsigned char scratch_[kMaxBufferLength];
+  std::size_t head_ = 0;
+  std::size_t tail_ = 0;
+  bool broken_ = false;
+};
+
+#endif  // CORE_NETWORKING_FRAME_CODEC_H_
@@ -12,12 +12,48 @@ using namespace serialization;
 
 static const std::size_t kMaxBufferLength = 256;
 
+// layout of the messages below, sent with INFO_GAME_ID so peers of different layouts don't talk past each other
+static const unsigned char kWireVersion = 2;
+
+// every field is little endian whatever the host, so both ends agree on the bytes
+typedef FixedField<1> ByteField;
+typedef FixedField<4> Uint32Field;
+
+// every message starts with
+// MESSAGE_TYPE (1 Byte) | MESSAGE_REMAINING_BYTES (1 Byte) | GAME_ID (4 Byte)
+// the game id tells apart the games sharing one connection, the remaining bytes count what follows the header.
+typedef WireSchema<ByteField, ByteField, Uint32Field> HeaderSchema;
+static const std::size_t kHeaderLength = HeaderSchema::kMaxLength;
+
+// CLIENT_ID (4 Byte) | GAME_ID (4 Byte) | LOCATION (varint)
+typedef WireSchema<Uint32Field, Uint32Field, VarintField> RequestAttackSchema;
+// SUCCEED_OR_NOT (1 Byte) | SINK_SHIP_TYPE_DURING_ATTACK (1 Byte) | ATTACKER_WIN_OR_NOT (1 Byte)
+typedef WireSchema<ByteField, ByteField, ByteField> ReplyAttackSchema;
+// CLIENT_ID (4 Byte) | GAME_ID (4 Byte) | WIRE_VERSION (1 Byte)
+typedef WireSchema<Uint32Field, Uint32Field, ByteField> InfoGameIdSchema;
+// CLIENT_ID (4 Byte) | GAME_ID (4 Byte)
+typedef WireSchema<Uint32Field, Uint32Field> InfoReadySchema;
+// CLIENT_ID (4 Byte) | GAME_ID (4 Byte) | ROLL_NUMBER (4 Byte)
+typedef WireSchema<Uint32Field, Uint32Field, Uint32Field> InfoRollSchema;
+// CLIENT_ID (4 Byte) | STRATEGY (1 Byte)
+typedef WireSchema<Uint32Field, ByteField> RequestMatchSchema;
+// CLIENT_ID (4 Byte) | STRATEGY (1 Byte)
+typedef WireSchema<Uint32Field, ByteField> InfoMatchSchema;
+// nothing but the header
+typedef WireSchema<> InfoBreakOffSchema;
+
+// a client asks a server for a game under this id, the server never hands it out
+static const GameId kLobbyGameId = 0xFFFFFFFF;
+
 enum class MessageType : unsigned char {
   kRequestAttack,
   kReplyAttack,
   kInfoGameId,
   kInfoReady,
-  kInfoRoll
+  kInfoRoll,
+  kRequestMatch,
+  kInfoMatch,
+  kInfoBreakOff
 };
 
 static std::string MessageTypeToString(const MessageType type){
@@ -37,6 +73,15 @@ static std::string MessageTypeToString(const MessageType type){
     case MessageType::kInfoRoll:{
       return "kInfoRoll";
     }
+    case MessageType::kRequestMatch:{
+      return "kRequestMatch";
+    }
+    case MessageType::kInfoMatch:{
+      return "kInfoMatch";
+    }
+    case MessageType::kInfoBreakOff:{
+      return "kInfoBreakOff";
+    }
     default:{
       return "UnknownType";
     }
@@ -47,160 +92,107 @@ static std::string MessageTypeToString(const MessageType type){
 // functions for serializing and deserializing messages
 // ******************************************************************
 
-static void MakeRequestAttack(unsigned char* buffer, std::size_t* length, ClientId cli_id, GameId game_id, std::size_t location){
-  // `REQUEST_ATTACK (1 Byte) | MESSAGE_REMAINING_BYTES (1 Byte) | CLIENT_ID (4 Byte) | SECRET_KEY (4 Byte) | LOCATION (4 Byte)`
-  std::size_t offset = 0;
-  buffer[offset] = static_cast<unsigned char>(MessageType::kRequestAttack);
-
-  // request[1] is reserved for REMAINING_BYTES
-  offset += 2;
-
-  WriteToByteArray<ClientId>(buffer, offset, cli_id);
-  offset += sizeof(ClientId);
-  WriteToByteArray<GameId>(buffer, offset, game_id);
-  offset += sizeof(game_id);
-  WriteToByteArray<std::size_t>(buffer, offset, location);
-  offset += sizeof(std::size_t);
-  *length = offset;
-
-  // REMAINING_BYTES
-  buffer[1] = static_cast<unsigned char>(offset - 2);
+static bool IsMessageType(unsigned char type){
+  return type <= static_cast<unsigned char>(MessageType::kInfoBreakOff);
+}
 
-  *length = offset;
-  assert(*length <= kMaxBufferLength);
+// talked between a client and a server, not between the players of a game
+static bool IsMatchmakingMessage(MessageType type){
+  return type == MessageType::kRequestMatch || type == MessageType::kInfoMatch;
 }
 
-static void ResolveRequestAttack(unsigned char* buffer, std::size_t length, ClientId* cli_id, GameId* game_id, std::size_t* location){
-  // CLIENT_ID (4 Byte) | SECRET_KEY (4 Byte) | LOCATION (4 Byte)
-  assert(length <= kMaxBufferLength);
-  std::size_t offset = 0;
-  ReadFromByteArray<ClientId>(buffer, offset, cli_id);
-  offset += sizeof(ClientId);
-  ReadFromByteArray<GameId>(buffer, offset, game_id);
-  offset += sizeof(GameId);
-  ReadFromByteArray<std::size_t>(buffer, offset, location);
+static bool ResolveHeader(const unsigned char* header, MessageType* type, std::size_t* length, GameId* game_id){
+  ByteReader reader(header, kHeaderLength);
+  return HeaderSchema::Decode(reader, type, length, game_id);
 }
 
-static void MakeReplyAttack(unsigned char* buffer, std::size_t* length, bool success, ShipType type, bool attacker_win){
-  // REPLY_ATTACK (1 Byte) | MESSAGE_REMAINING_BYTES (1 Byte) | SUCCEED_OR_NOT (1 Byte) | SINK_SHIP_TYPE_DURING_ATTACK (1 Byte) | ATTACKER_WIN_OR_NOT (1 Byte)
-  std::size_t offset = 0;
-  buffer[offset] = static_cast<unsigned char>(MessageType::kReplyAttack);
+// header and payload of one message, the values go to the fields of Schema in order
+template<typename Schema, typename... Values>
+static void MakeMessage(unsigned char* buffer, std::size_t* length, MessageType type, GameId game_id, const Values &... values){
+  static_assert(kHeaderLength + Schema::kMaxLength <= kMaxBufferLength, "a message of the schema may not fit a buffer");
+  ByteWriter writer(buffer, 0);
+  // REMAINING_BYTES is filled in once the payload is written
+  HeaderSchema::Encode(writer, type, 0, game_id);
+  Schema::Encode(writer, values...);
+  *length = writer.GetOffset();
+  buffer[1] = static_cast<unsigned char>(*length - kHeaderLength);
+}
 
-  // request[1] is reserved for REMAINING_BYTES
-  offset += 2;
+// the payload of one message, without the header. false if it is cut short, it comes from the peer
+// and can be anything, the values are only good if true.
+template<typename Schema, typename... Values>
+static bool ResolveMessage(const unsigned char* buffer, std::size_t length, Values*... values){
+  ByteReader reader(buffer, length);
+  return Schema::Decode(reader, values...);
+}
 
-  WriteToByteArray<bool>(buffer, offset, success);
-  offset += sizeof(bool);
-  WriteToByteArray<ShipType>(buffer, offset, type);
-  offset += sizeof(ShipType);
-  WriteToByteArray<bool>(buffer, offset, attacker_win);
-  offset += sizeof(bool);
-  // REMAINING_BYTES
-  buffer[1] = static_cast<unsigned char>(offset - 2);
+static void MakeRequestAttack(unsigned char* buffer, std::size_t* length, ClientId cli_id, GameId game_id, std::size_t location){
+  MakeMessage<RequestAttackSchema>(buffer, length, MessageType::kRequestAttack, game_id, cli_id, game_id, location);
+}
 
-  *length = offset;
-  assert(*length <= kMaxBufferLength);
+static bool ResolveRequestAttack(const unsigned char* buffer, std::size_t length, ClientId* cli_id, GameId* game_id, std::size_t* location){
+  return ResolveMessage<RequestAttackSchema>(buffer, length, cli_id, game_id, location);
 }
 
+static void MakeReplyAttack(unsigned char* buffer, std::size_t* length, GameId game_id, bool success, ShipType type, bool attacker_win){
+  MakeMessage<ReplyAttackSchema>(buffer, length, MessageType::kReplyAttack, game_id, success, type, attacker_win);
+}
 
-static void ResolveReplyAttack(unsigned char* buffer, std::size_t length, bool* success, ShipType* type, bool* attacker_win){
-  // SUCCEED_OR_NOT (1 Byte) | SINK_SHIP_TYPE_DURING_ATTACK (1 Byte)
-  assert(length <= kMaxBufferLength);
-  std::size_t offset = 0;
-  ReadFromByteArray<bool>(buffer, offset, success);
-  offset += sizeof(bool);
-  ReadFromByteArray<ShipType>(buffer, offset, type);
-  offset += sizeof(ShipType);
-  ReadFromByteArray<bool>(buffer, offset, attacker_win);
+// false also for a byte that is no ship type
+static bool ResolveReplyAttack(const unsigned char* buffer, std::size_t length, bool* success, ShipType* type, bool* attacker_win){
+  unsigned char type_byte = 0;
+  if(!ResolveMessage<ReplyAttackSchema>(buffer, length, success, &type_byte, attacker_win) || type_byte > kNotAShip) return false;
+  *type = static_cast<ShipType>(type_byte);
+  return true;
 }
 
 static void MakeInfoGameId(unsigned char* buffer, std::size_t* length, ClientId cli_id, GameId game_id){
-  // INFO_GAME_ID (1 Byte) | MESSAGE_REMAINING_BYTES (1 Byte) | CLIENT_ID (4 Byte) | GAME_ID (4 Byte)
-  std::size_t offset = 0;
-  buffer[offset] = static_cast<unsigned char>(MessageType::kInfoGameId);
-
-  // request[1] is reserved for REMAINING_BYTES
-  offset += 2;
-
-  WriteToByteArray<ClientId>(buffer, offset, cli_id);
-  offset += sizeof(ClientId);
-  WriteToByteArray<GameId>(buffer, offset, game_id);
-  offset += sizeof(GameId);
-  // REMAINING_BYTES
-  buffer[1] = static_cast<unsigned char>(offset - 2);
+  MakeMessage<InfoGameIdSchema>(buffer, length, MessageType::kInfoGameId, game_id, cli_id, game_id, kWireVersion);
+}
 
-  *length = offset;
-  assert(*length <= kMaxBufferLength);
+static bool ResolveInfoGameId(const unsigned char* buffer, std::size_t length, ClientId* cli_id, GameId* game_id, unsigned char* version){
+  return ResolveMessage<InfoGameIdSchema>(buffer, length, cli_id, game_id, version);
 }
 
-static void ResolveInfoGameId(unsigned char* buffer, std::size_t length, ClientId* cli_id, GameId* game_id){
-  // CLIENT_ID (4 Byte) | GAME_ID (4 Byte)
-  assert(length <= kMaxBufferLength);
-  std::size_t offset = 0;
-  ReadFromByteArray<ClientId>(buffer, offset, cli_id);
-  offset += sizeof(ClientId);
-  ReadFromByteArray<GameId>(buffer, offset, game_id);
+static void MakeInfoReady(unsigned char* buffer, std::size_t* length, ClientId cli_id, GameId game_id){
+  MakeMessage<InfoReadySchema>(buffer, length, MessageType::kInfoReady, game_id, cli_id, game_id);
 }
 
+static bool ResolveInfoReady(const unsigned char* buffer, std::size_t length, ClientId* cli_id, GameId* game_id){
+  return ResolveMessage<InfoReadySchema>(buffer, length, cli_id, game_id);
+}
 
-static void MakeInfoReady(unsigned char* buffer, std::size_t* length, ClientId cli_id, GameId game_id){
-  // INFO_READY (1 Byte) | MESSAGE_REMAINING_BYTES (1 Byte) | CLIENT_ID (4 Byte) | GAME_ID (4 Byte)
-  std::size_t offset = 0;
-  buffer[offset] = static_cast<unsigned char>(MessageType::kInfoReady);
+static void MakeInfoRoll(unsigned char* buffer, std::size_t* length, ClientId cli_id, GameId game_id, unsigned long roll_number){
+  MakeMessage<InfoRollSchema>(buffer, length, MessageType::kInfoRoll, game_id, cli_id, game_id, roll_number);
+}
 
-  // request[1] is reserved for REMAINING_BYTES
-  offset += 2;
+static bool ResolveInfoRoll(const unsigned char* buffer, std::size_t length, ClientId* cli_id, GameId* game_id, unsigned long* roll_number){
+  return ResolveMessage<InfoRollSchema>(buffer, length, cli_id, game_id, roll_number);
+}
 
-  WriteToByteArray<ClientId>(buffer, offset, cli_id);
-  offset += sizeof(ClientId);
-  WriteToByteArray<GameId>(buffer, offset, game_id);
-  offset += sizeof(GameId);
-  // REMAINING_BYTES
-  buffer[1] = static_cast<unsigned char>(offset - 2);
+// REQUEST_MATCH (1 Byte) | MESSAGE_REMAINING_BYTES (1 Byte) | GAME_ID (4 Byte) | CLIENT_ID (4 Byte) | STRATEGY (1 Byte)
+// sent under kLobbyGameId, the strategy names the pool of games the client wants one of
+static void MakeRequestMatch(unsigned char* buffer, std::size_t* length, ClientId cli_id, unsigned char strategy){
+  MakeMessage<RequestMatchSchema>(buffer, length, MessageType::kRequestMatch, kLobbyGameId, cli_id, strategy);
+}
 
-  *length = offset;
-  assert(*length <= kMaxBufferLength);
+static bool ResolveRequestMatch(const unsigned char* buffer, std::size_t length, ClientId* cli_id, unsigned char* strategy){
+  return ResolveMessage<RequestMatchSchema>(buffer, length, cli_id, strategy);
 }
 
-static void ResolveInfoReady(unsigned char* buffer, std::size_t length, ClientId* cli_id, GameId* game_id){
-  // CLIENT_ID (4 Byte) | GAME_ID (4 Byte)
-  assert(length <= kMaxBufferLength);
-  std::size_t offset = 0;
-  ReadFromByteArray<ClientId>(buffer, offset, cli_id);
-  offset += sizeof(ClientId);
-  ReadFromByteArray<GameId>(buffer, offset, game_id);
+// INFO_MATCH (1 Byte) | MESSAGE_REMAINING_BYTES (1 Byte) | GAME_ID (4 Byte) | CLIENT_ID (4 Byte) | STRATEGY (1 Byte)
+// sent under the game the server made, the client plays it under the client id given
+static void MakeInfoMatch(unsigned char* buffer, std::size_t* length, GameId game_id, ClientId cli_id, unsigned char strategy){
+  MakeMessage<InfoMatchSchema>(buffer, length, MessageType::kInfoMatch, game_id, cli_id, strategy);
 }
 
+static bool ResolveInfoMatch(const unsigned char* buffer, std::size_t length, ClientId* cli_id, unsigned char* strategy){
+  return ResolveMessage<InfoMatchSchema>(buffer, length, cli_id, strategy);
+}
 
-static void MakeInfoRoll(unsigned char* buffer, std::size_t* length, ClientId cli_id, GameId game_id, unsigned long roll_number){
-  // INFO_READY (1 Byte) | MESSAGE_REMAINING_BYTES (1 Byte) | CLIENT_ID (4 Byte) | GAME_ID (4 Byte) | ROLL_NUMBER (4 Byte)
-  std::size_t offset = 0;
-  buffer[offset] = static_cast<unsigned char>(MessageType::kInfoRoll);
-
-  // request[1] is reserved for REMAINING_BYTES
-  offset += 2;
-
-  WriteToByteArray<ClientId>(buffer, offset, cli_id);
-  offset += sizeof(ClientId);
-  WriteToByteArray<GameId>(buffer, offset, game_id);
-  offset += sizeof(GameId);
-  WriteToByteArray<unsigned long>(buffer, offset, roll_number);
-  offset += sizeof(unsigned long);
-  // REMAINING_BYTES
-  buffer[1] = static_cast<unsigned char>(offset - 2);
-
-  *length = offset;
-  assert(*length <= kMaxBufferLength);
-}
-
-static void ResolveInfoRoll(unsigned char* buffer, std::size_t length, ClientId* cli_id, GameId* game_id, unsigned long* roll_number){
-  // CLIENT_ID (4 Byte) | GAME_ID (4 Byte) | ROLL_NUMBER (4 Byte)
-  assert(length <= kMaxBufferLength);
-  std::size_t offset = 0;
-  ReadFromByteArray<ClientId>(buffer, offset, cli_id);
-  offset += sizeof(ClientId);
-  ReadFromByteArray<GameId>(buffer, offset, game_id);
-  offset += sizeof(GameId);
-  ReadFromByteArray<unsigned long>(buffer, offset, roll_number);
+// INFO_BREAK_OFF (1 Byte) | MESSAGE_REMAINING_BYTES (1 Byte) | GAME_ID (4 Byte)
+// sent by a server relaying the game once the other client is gone, the game can't go on
+static void MakeInfoBreakOff(unsigned char* buffer, std::size_t* length, GameId game_id){
+  MakeMessage<InfoBreakOffSchema>(buffer, length, MessageType::kInfoBreakOff, game_id);
 }
 #endif  // CORE_NETWORKING_MESSAGES_H_
@@ -3,6 +3,8 @@
 #ifndef CORE_NETWORKING_SERIALIZATION_H_
 #define CORE_NETWORKING_SERIALIZATION_H_
 
+#include <cassert>
+#include <cstdint>
 #include <cstring>
 
 namespace serialization{
@@ -37,7 +39,7 @@ namespace serialization{
   // read type from the byte array
   //*********************************
   template<typename T>
-  static void ReadFromByteArrayImplBitOpts(unsigned char* arr, std::size_t offset, T* data){
+  static void ReadFromByteArrayImplBitOpts(const unsigned char* arr, std::size_t offset, T* data){
     // an implementation of converting byte array to typed data -- using bit operations
     std::size_t type_size = sizeof(T);
     std::memset(data, 0, type_size);
@@ -49,16 +51,156 @@ namespace serialization{
   }
 
   template<typename T>
-  static void ReadFromByteArrayImplMemcpy(unsigned char* arr, std::size_t offset, T* data){
+  static void ReadFromByteArrayImplMemcpy(const unsigned char* arr, std::size_t offset, T* data){
     // an implementation of converting byte array to typed data -- using memcpy
     std::memcpy(data, arr + offset, sizeof(T));
   }
 
   template<typename T>
-  static void ReadFromByteArray(unsigned char* arr, std::size_t offset, T* data){
+  static void ReadFromByteArray(const unsigned char* arr, std::size_t offset, T* data){
     //ReadFromByteArrayImplBitOpts<T>(arr, offset, data);
     ReadFromByteArrayImplMemcpy<T>(arr, offset, data);
   }
+
+  //*********************************
+  // wire fields, the same bytes on every host
+  //*********************************
+  // an unsigned integer in Bytes bytes, least significant byte first
+  template<std::size_t Bytes>
+  struct FixedField{
+    static const std::size_t kMaxLength = Bytes;
+
+    static void Write(unsigned char* arr, std::size_t* offset, std::uint64_t data){
+      // Bytes % 8, a shift by the width of the type is undefined even where the assert doesn't look at it
+      assert(Bytes == 8 || data >> (8 * (Bytes % 8)) == 0);
+      for(std::size_t i = 0; i < Bytes; i++){
+        arr[*offset + i] = static_cast<unsigned char>(data >> (8 * i));
+      }
+      *offset += Bytes;
+    }
+
+    // false if fewer than Bytes bytes are left
+    static bool Read(const unsigned char* arr, std::size_t length, std::size_t* offset, std::uint64_t* data){
+      if(*offset > length || length - *offset < Bytes) return false;
+      *data = 0;
+      for(std::size_t i = 0; i < Bytes; i++){
+        *data |= static_cast<std::uint64_t>(arr[*offset + i]) << (8 * i);
+      }
+      *offset += Bytes;
+      return true;
+    }
+  };
+
+  // an unsigned integer 7 bits a byte, least significant first, the high bit set on all but the last byte.
+  // a board location takes one or two bytes instead of a whole size_t.
+  struct VarintField{
+    static const std::size_t kMaxLength = 10;
+
+    static void Write(unsigned char* arr, std::size_t* offset, std::uint64_t data){
+      while(data >= 0x80){
+        arr[(*offset)++] = static_cast<unsigned char>(data | 0x80);
+        data >>= 7;
+      }
+      arr[(*offset)++] = static_cast<unsigned char>(data);
+    }
+
+    // false if the bytes end before the last byte of the varint or it runs past 64 bits
+    static bool Read(const unsigned char* arr, std::size_t length, std::size_t* offset, std::uint64_t* data){
+      *data = 0;
+      for(std::size_t shift = 0; shift < 64; shift += 7){
+        if(*offset >= length) return false;
+        unsigned char byte = arr[(*offset)++];
+        // the tenth byte has room for one bit only
+        if(shift == 63 && byte > 1) return false;
+        *data |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if((byte & 0x80) == 0) return true;
+      }
+      return false;
+    }
+  };
+
+  //*********************************
+  // cursors keeping the offset
+  //*********************************
+  class ByteWriter{
+  public:
+    ByteWriter(unsigned char* arr, std::size_t offset):
+      arr_(arr),
+      offset_(offset){
+    }
+
+    template<typename Field, typename T>
+    void Put(T data){
+      Field::Write(arr_, &offset_, static_cast<std::uint64_t>(data));
+    }
+
+    std::size_t GetOffset() const{
+      return offset_;
+    }
+
+  private:
+    unsigned char* arr_;
+    std::size_t offset_;
+  };
+
+  class ByteReader{
+  public:
+    ByteReader(const unsigned char* arr, std::size_t length):
+      arr_(arr),
+      length_(length){
+    }
+
+    // false if the field doesn't fit what is left, data is left as it was then
+    template<typename Field, typename T>
+    bool Get(T* data){
+      std::uint64_t value = 0;
+      if(!Field::Read(arr_, length_, &offset_, &value)) return false;
+      *data = static_cast<T>(value);
+      return true;
+    }
+
+  private:
+    const unsigned char* arr_;
+    std::size_t length_;
+    std::size_t offset_ = 0;
+  };
+
+  //*********************************
+  // a message layout as a list of fields,
+  // encoding and decoding are both generated from it
+  //*********************************
+  template<typename... Fields>
+  struct WireSchema;
+
+  template<>
+  struct WireSchema<>{
+    static const std::size_t kMaxLength = 0;
+
+    static void Encode(ByteWriter &){
+    }
+
+    static bool Decode(ByteReader &){
+      return true;
+    }
+  };
+
+  template<typename Field, typename... Rest>
+  struct WireSchema<Field, Rest...>{
+    static const std::size_t kMaxLength = Field::kMaxLength + WireSchema<Rest...>::kMaxLength;
+
+    // one value a field, in order
+    template<typename T, typename... Values>
+    static void Encode(ByteWriter & writer, const T & value, const Values &... values){
+      writer.Put<Field>(value);
+      WireSchema<Rest...>::Encode(writer, values...);
+    }
+
+    // false at the first field the bytes run out in
+    template<typename T, typename... Values>
+    static bool Decode(ByteReader & reader, T* value, Values*... values){
+      return reader.Get<Field>(value) && WireSchema<Rest...>::Decode(reader, values...);
+    }
+  };
 }
 
 #endif  // CORE_NETWORKING_SERIALIZATION_H_
@@ -0,0 +1,249 @@
+//
+// Renderer drawing a frame with a handful of GL calls: shapes and text are collected into vertex arrays and drawn in batches.
+//
+
+#ifndef BATTLESHIP_GAME_BATCH_RENDERER_H
+#define BATTLESHIP_GAME_BATCH_RENDERER_H
+
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "graphic/graphic_common.h"
+
+// Every glyph of the pixel font of graphic_utils.h rendered once into one alpha texture,
+// a cell of the same size for every character.
+class GlyphAtlas{
+public:
+  // a point of a glyph covers the 4 by 4 pixels around it, a glyph's points lie in 0 - 8
+  static const int kPointSize = 4;
+  static const int kPadding = kPointSize / 2;
+  static const int kCellSize = 12;
+  static const int kColumns = 16;
+  static const int kRows = 8;
+  static const int kWidth = kColumns * kCellSize;
+  static const int kHeight = kRows * kCellSize;
+
+  GlyphAtlas(){
+    std::memset(alpha_, 0, sizeof(alpha_));
+    for(int c = 0; c < kColumns * kRows; ++c){
+      int cell_x = CellX(static_cast<char>(c));
+      int cell_y = CellY(static_cast<char>(c));
+      advance_[c] = PlotGlyph(static_cast<char>(c), cell_x + kPadding, cell_y + kPadding, [this, cell_x, cell_y](int x, int y){
+        for(int i = x - kPadding; i < x + kPadding; ++i){
+          for(int j = y - kPadding; j < y + kPadding; ++j){
+            assert(i >= cell_x && i < cell_x + kCellSize && j >= cell_y && j < cell_y + kCellSize);
+            alpha_[j * kWidth + i] = 0xFF;
+          }
+        }
+      });
+    }
+  }
+
+  // how far the pen moves on after the glyph
+  int GetAdvance(char c) const{
+    return advance_[Index(c)];
+  }
+
+  // left bottom pixel of the cell of the glyph
+  int CellX(char c) const{
+    return Index(c) % kColumns * kCellSize;
+  }
+
+  int CellY(char c) const{
+    return Index(c) / kColumns * kCellSize;
+  }
+
+  unsigned char GetAlpha(int x, int y) const{
+    return alpha_[y * kWidth + x];
+  }
+
+  // with a GL context current, returns the texture
+  GLuint Upload() const{
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, kWidth, kHeight, 0, GL_ALPHA, GL_UNSIGNED_BYTE, alpha_);
+    // a pixel of a glyph is a pixel on the screen
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    return texture;
+  }
+
+private:
+  unsigned char alpha_[kWidth * kHeight];
+  int advance_[kColumns * kRows];
+
+  static int Index(char c){
+    unsigned char index = static_cast<unsigned char>(c);
+    return index < kColumns * kRows ? index : ' ';
+  }
+};
+
+// Collects a frame and draws it with three glDrawArrays: filled shapes, lines and text.
+// Every shape gets a depth by the order it was asked for, so with the depth test on a later shape
+// still covers an earlier one, as drawn one by one in immediate mode. Transparent texels of the
+// text fail the alpha test and cover nothing.
+// The vertex arrays keep their capacity from frame to frame, a frame allocates nothing once they grew.
+class BatchRenderer{
+public:
+  // all lines are this wide, as the ui drew them
+  static const int kLineWidth = 3;
+  // the most shapes in one frame, each gets a depth of its own
+  static const std::size_t kMaxLayers = 1 << 16;
+
+  struct Vertex{
+    float x;
+    float y;
+    float z;
+    float u;
+    float v;
+    float color[3];
+  };
+
+  // with the GL context current, before the first frame
+  void Init(){
+    texture_ = atlas_.Upload();
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    glAlphaFunc(GL_GREATER, 0.5f);
+  }
+
+  void BeginFrame(){
+    fills_.clear();
+    lines_.clear();
+    glyphs_.clear();
+    layer_ = 0;
+  }
+
+  void FillRect(float center_x, float center_y, float width, float height, float r, float g, float b){
+    float z = NextDepth();
+    float left = center_x - width / 2;
+    float right = center_x + width / 2;
+    float bottom = center_y - height / 2;
+    float top = center_y + height / 2;
+    AddQuad(&fills_, left, bottom, right, top, z, 0, 0, 0, 0, r, g, b);
+  }
+
+  void StrokeRect(float center_x, float center_y, float width, float height, float r, float g, float b){
+    float z = NextDepth();
+    float left = center_x - width / 2;
+    float right = center_x + width / 2;
+    float bottom = center_y - height / 2;
+    float top = center_y + height / 2;
+    AddLine(left, top, right, top, z, r, g, b);
+    AddLine(right, top, right, bottom, z, r, g, b);
+    AddLine(right, bottom, left, bottom, z, r, g, b);
+    AddLine(left, bottom, left, top, z, r, g, b);
+  }
+
+  // centered where DrawString would center it
+  void Text(const std::string & s, int x, int y, float r, float g, float b){
+    float z = NextDepth();
+    int offset = (s.length() + 1) * 4;
+    x = x - offset;
+    y = y - 3;
+    int startX = x;
+    for(const char & c : s){
+      if(c == '\n'){
+        y -= 10;
+        x = startX + 2;
+        continue;
+      }
+      if(c != ' '){
+        float u = static_cast<float>(atlas_.CellX(c)) / GlyphAtlas::kWidth;
+        float v = static_cast<float>(atlas_.CellY(c)) / GlyphAtlas::kHeight;
+        float left = x - GlyphAtlas::kPadding;
+        float bottom = y - GlyphAtlas::kPadding;
+        AddQuad(&glyphs_, left, bottom, left + GlyphAtlas::kCellSize, bottom + GlyphAtlas::kCellSize, z,
+                u, v, u + static_cast<float>(GlyphAtlas::kCellSize) / GlyphAtlas::kWidth,
+                v + static_cast<float>(GlyphAtlas::kCellSize) / GlyphAtlas::kHeight, r, g, b);
+      }
+      x += atlas_.GetAdvance(c);
+    }
+  }
+
+  // the draws of the frame, with the GL context current
+  void EndFrame(){
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    Draw(fills_, GL_TRIANGLES);
+    glLineWidth(kLineWidth);
+    Draw(lines_, GL_LINES);
+
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_ALPHA_TEST);
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    if(!glyphs_.empty()) glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &glyphs_[0].u);
+    Draw(glyphs_, GL_TRIANGLES);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisable(GL_ALPHA_TEST);
+    glDisable(GL_TEXTURE_2D);
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+  }
+
+  const std::vector<Vertex> & GetFills() const{
+    return fills_;
+  }
+
+  const std::vector<Vertex> & GetLines() const{
+    return lines_;
+  }
+
+  const std::vector<Vertex> & GetGlyphs() const{
+    return glyphs_;
+  }
+
+  const GlyphAtlas & GetAtlas() const{
+    return atlas_;
+  }
+
+private:
+  GlyphAtlas atlas_;
+  GLuint texture_ = 0;
+  std::vector<Vertex> fills_;
+  std::vector<Vertex> lines_;
+  std::vector<Vertex> glyphs_;
+  std::size_t layer_ = 0;
+
+  // glOrtho has near 0 and far 1, z goes from -1 up to 0 as shapes are added
+  float NextDepth(){
+    assert(layer_ + 1 < kMaxLayers);
+    layer_ += 1;
+    return -1.0f + static_cast<float>(layer_) / kMaxLayers;
+  }
+
+  static Vertex MakeVertex(float x, float y, float z, float u, float v, float r, float g, float b){
+    Vertex vertex{x, y, z, u, v, {r, g, b}};
+    return vertex;
+  }
+
+  // two triangles
+  static void AddQuad(std::vector<Vertex>* batch, float left, float bottom, float right, float top, float z,
+                      float u0, float v0, float u1, float v1, float r, float g, float b){
+    batch->push_back(MakeVertex(left, bottom, z, u0, v0, r, g, b));
+    batch->push_back(MakeVertex(right, bottom, z, u1, v0, r, g, b));
+    batch->push_back(MakeVertex(right, top, z, u1, v1, r, g, b));
+    batch->push_back(MakeVertex(left, bottom, z, u0, v0, r, g, b));
+    batch->push_back(MakeVertex(right, top, z, u1, v1, r, g, b));
+    batch->push_back(MakeVertex(left, top, z, u0, v1, r, g, b));
+  }
+
+  void AddLine(float x0, float y0, float x1, float y1, float z, float r, float g, float b){
+    lines_.push_back(MakeVertex(x0, y0, z, 0, 0, r, g, b));
+    lines_.push_back(MakeVertex(x1, y1, z, 0, 0, r, g, b));
+  }
+
+  static void Draw(const std::vector<Vertex> & batch, GLenum mode){
+    if(batch.empty()) return;
+    glVertexPointer(3, GL_FLOAT, sizeof(Vertex), &batch[0].x);
+    glColorPointer(3, GL_FLOAT, sizeof(Vertex), batch[0].color);
+    glDrawArrays(mode, 0, static_cast<GLsizei>(batch.size()));
+  }
+};
+
+#endif //BATTLESHIP_GAME_BATCH_RENDERER_H
@@ -5,19 +5,23 @@
 #ifndef GRAPTHIC_GAME_UI_H_
 #define GRAPTHIC_GAME_UI_H_
 
+#include <functional>
 #include <iostream>
 #include "graphic/graphic_common.h"
-#include "core/game/board.h"
-#include "core/game/imagine_board.h"
+#include "graphic/batch_renderer.h"
+#include "client/game_snapshot.h"
 
 
-class GameUi{
+template<typename Rules>
+class BasicGameUi{
 public:
-  // TODO: make first two ref const, along with their getter function
-  GameUi(Board& my_board, ImagineBoard& enemy_board, const ProbabilityBoard& probability_board):
-    ref_my_board_(my_board),
-    ref_enemy_board_(enemy_board),
-    ref_prob_board_(probability_board){
+  typedef BasicGameSnapshot<Rules> GameSnapshot;
+  typedef TripleBuffer<GameSnapshot> GameSnapshotBuffer;
+  static const std::size_t kDim = Rules::kDim;
+
+  // the ui is the only reader of snapshots
+  explicit BasicGameUi(GameSnapshotBuffer& snapshots):
+    ref_snapshots_(snapshots){
   }
 
   int run(){
@@ -48,6 +52,8 @@ public:
     // see https://www.opengl.org/sdk/docs/man2/xhtml/glOrtho.xml
     glOrtho(0.0,kWindowWidth,0.0,kWindowHeight,0.0,1.0); // this creates a canvas you can do 2D drawing on
 
+    renderer_.Init();
+
     /* Loop until the user closes the window */
     while (!glfwWindowShouldClose(window) && !stop_)
     {
@@ -56,6 +62,7 @@ public:
 
       /* Swap front and back buffers */
       glfwSwapBuffers(window);
+      if(on_frame_) on_frame_();
 
       /* Poll for and process events */
       glfwPollEvents();
@@ -69,8 +76,14 @@ public:
     stop_ = true;
   }
 
+  // called on the ui thread after every frame presented
+  void SetFrameListener(std::function<void()> on_frame){
+    on_frame_ = on_frame;
+  }
+
 private:
-  static const size_t kBoardDim = 11;
+  // the board and a row and a column of labels
+  static const size_t kBoardDim = kDim + 1;
 
   static const int kWindowWidth = 1000;
   static const int kWindowHeight = 700;
@@ -88,31 +101,37 @@ private:
 
   static const int kInfoLineNum = 7;
 
-  static const int kBoardLineWidth = 3;
-  static const int kInfoLineWidth = 2;
-  static const int kDefaultColorR = 0;
-  static const int kDefaultColorG = 0;
-  static const int kDefaultColorB = 0;
 
 
   float x_offet_for_better_display_;
 
-  Board & ref_my_board_;
-  ImagineBoard & ref_enemy_board_;
-  const ProbabilityBoard & ref_prob_board_;
+  // the game as of the latest snapshot, never waits on the game thread
+  GameSnapshotBuffer & ref_snapshots_;
+
+  // a frame is collected into it and drawn at once
+  BatchRenderer renderer_;
 
   // TODO: a flag that allow other thread to stop the endless loop
   bool stop_ = false;
 
+  std::function<void()> on_frame_;
+
   void RenderGameUi(){
+    ref_snapshots_.Update();
     ClearCanvas();
+    renderer_.BeginFrame();
     RenderMyBoard();
     RenderEnemyBoard();
     RenderMyInfo();
     RenderEnemyInfo();
+    renderer_.EndFrame();
   }
 
 
+  const GameSnapshot & Snapshot() const{
+    return ref_snapshots_.GetFront();
+  }
+
   void ClearCanvas(){
     glClearColor ( 1.0f, 1.0f, 1.0f, 1.0f );
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -125,7 +144,7 @@ private:
 
     for(size_t i = 1; i < kBoardDim; i++){
       for(size_t j = 0; j < kBoardDim - 1; j++){
-        float grey_scale = 1.0f - 0.7f * (ref_prob_board_.GetProbabilityScale(ToLocation(i, j)));
+        float grey_scale = 1.0f - 0.7f * (Snapshot().probability_scale[ToLocation(i, j)]);
         RenderShade(center_left_bottom_x + i * width_per_square, center_left_bottom_y + j * width_per_square, width_per_square, grey_scale, grey_scale, grey_scale);
       }
     }
@@ -134,13 +153,11 @@ private:
   // for now, only used for RenderProbEnemyBoard()
   size_t ToLocation(size_t i, size_t j){
     size_t col = i - 1;
-    size_t row = 9 - j;
-    return row * 10 + col;
+    size_t row = kDim - 1 - j;
+    return row * kDim + col;
   }
 
   void RenderMyInfo(){
-    glColor3f(0.0, 0.0, 0.0);
-    glLineWidth(kInfoLineWidth);
     float center_x = kInfoCanvasWidth / 4;
     float center_y = kInfoCanvasHeight / 2 + kInfoCanvasHeightOffset;
     float width = kInfoCanvasWidth / 2 - kInfoCanvasWidthMargin;
@@ -155,14 +172,14 @@ private:
   }
 
   void RenderMyShipInfo(float info_center_x, float info_center_y, float info_width, float info_height){
-    RenderString("carrier: " + std::to_string(ref_my_board_.carrier_num_) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 2));
-    RenderString("battleship: " + std::to_string(ref_my_board_.battleship_num_) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 3));
-    RenderString("cruiser: " + std::to_string(ref_my_board_.cruiser_num_) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 4));
-    RenderString("destroyer: " + std::to_string(ref_my_board_.destroyer_num_) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 5));
+    RenderString("carrier: " + std::to_string(Snapshot().my.carrier_num) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 2));
+    RenderString("battleship: " + std::to_string(Snapshot().my.battleship_num) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 3));
+    RenderString("cruiser: " + std::to_string(Snapshot().my.cruiser_num) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 4));
+    RenderString("destroyer: " + std::to_string(Snapshot().my.destroyer_num) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 5));
   }
 
   void RenderMyMoveNum(float info_center_x, float info_center_y, float info_width, float info_height){
-    RenderString("total " + std::to_string(ref_my_board_.move_num_) + " moves", info_center_x, GetLineCenterY(info_center_y, info_height, 6));
+    RenderString("total " + std::to_string(Snapshot().my.move_num) + " moves", info_center_x, GetLineCenterY(info_center_y, info_height, 6));
   }
 
   void RenderMyLabel(float info_center_x, float info_center_y, float info_width, float info_height){
@@ -170,8 +187,8 @@ private:
   }
 
   void RenderMyGameStatus(float info_center_x, float info_center_y, float info_width, float info_height){
-    if(ref_my_board_.is_game_over_){
-      if(ref_my_board_.is_winner_me_){
+    if(Snapshot().my.is_game_over){
+      if(Snapshot().my.is_winner_me){
         RenderString("winner", info_center_x, GetLineCenterY(info_center_y, info_height, 7), 1.0, 0.0, 0.0);
       }else{
         RenderString("loser", info_center_x, GetLineCenterY(info_center_y, info_height, 7), 0.0, 1.0, 0.0);
@@ -185,8 +202,6 @@ private:
   }
 
   void RenderEnemyInfo(){
-    glColor3f(0.0, 0.0, 0.0);
-    glLineWidth(kInfoLineWidth);
     float center_x = kInfoCanvasWidth / 4 * 3;
     float center_y = kInfoCanvasHeight / 2 + kInfoCanvasHeightOffset;
     float width = kInfoCanvasWidth / 2 - kInfoCanvasWidthMargin;
@@ -202,13 +217,13 @@ private:
 
   // TODO: possible code dup
   void RenderEnemyMoveNum(float info_center_x, float info_center_y, float info_width, float info_height){
-    RenderString("total " + std::to_string(ref_my_board_.move_num_) + " moves", info_center_x, GetLineCenterY(info_center_y, info_height, 6));
+    RenderString("total " + std::to_string(Snapshot().enemy.move_num) + " moves", info_center_x, GetLineCenterY(info_center_y, info_height, 6));
   }
 
   // TODO: possible code dup
   void RenderEnemyGameStatus(float info_center_x, float info_center_y, float info_width, float info_height){
-    if(ref_enemy_board_.is_game_over_){
-      if(ref_enemy_board_.is_winner_me_){
+    if(Snapshot().enemy.is_game_over){
+      if(Snapshot().enemy.is_winner_me){
         RenderString("winner", info_center_x, GetLineCenterY(info_center_y, info_height, 7), 1.0, 0.0, 0.0);
       }else{
         RenderString("loser", info_center_x, GetLineCenterY(info_center_y, info_height, 7), 0.0, 1.0, 0.0);
@@ -218,10 +233,10 @@ private:
 
   // TODO: possible code dup
   void RenderEnemyShipInfo(float info_center_x, float info_center_y, float info_width, float info_height){
-    RenderString("carrier: " + std::to_string(ref_enemy_board_.carrier_num_) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 2));
-    RenderString("battleship: " + std::to_string(ref_enemy_board_.battleship_num_) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 3));
-    RenderString("cruiser: " + std::to_string(ref_enemy_board_.cruiser_num_) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 4));
-    RenderString("destroyer: " + std::to_string(ref_enemy_board_.destroyer_num_) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 5));
+    RenderString("carrier: " + std::to_string(Snapshot().enemy.carrier_num) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 2));
+    RenderString("battleship: " + std::to_string(Snapshot().enemy.battleship_num) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 3));
+    RenderString("cruiser: " + std::to_string(Snapshot().enemy.cruiser_num) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 4));
+    RenderString("destroyer: " + std::to_string(Snapshot().enemy.destroyer_num) + " alive", info_center_x, GetLineCenterY(info_center_y, info_height, 5));
   }
 
   // TODO: possible code dup
@@ -231,8 +246,6 @@ private:
   }
 
   void RenderEnemyBoard(){
-    glColor3f(0.0, 0.0, 0.0);
-    glLineWidth(kBoardLineWidth);
     float center_x = kBoardCanvasWidth / 4 * 3;
     float center_y = kBoardCanvasHeight / 2 + kBoardCanvasHeightOffset;
     float width = kBoardCanvasHeight - kBoardCanvasMargin;
@@ -248,15 +261,15 @@ private:
     for(size_t i = 0; i < kDim * kDim; i++){
       size_t row = i / kDim;
       size_t col = i % kDim;
-      const unsigned char & state = ref_enemy_board_.states_[i];
+      unsigned char state = Snapshot().enemy.states[i];
       RenderOneStateEnemyBoard(state, ColToCenterX(col, board_center_x, board_width), RowToCenterY(row, board_center_y, board_width));
     }
   }
 
   void RenderOneStateEnemyBoard(unsigned char state, float center_x, float center_y){
-    if(state & Board::OCCUPIED){
+    if(state & GameSnapshot::kOccupied){
       RenderString(std::string().append(1, 'o'),center_x + x_offet_for_better_display_, center_y);
-    }else if(state & Board::ATTACKED){
+    }else if(state & GameSnapshot::kAttacked){
       // only if not occupied, then we check if attacked
       // because if a location in enemy board is occupied, it must be attacked.
       RenderString(std::string().append(1, 'x'),center_x + x_offet_for_better_display_, center_y);
@@ -265,8 +278,6 @@ private:
 
 
   void RenderMyBoard(){
-    glColor3f(0.0, 0.0, 0.0);
-    glLineWidth(kBoardLineWidth);
     float center_x = kBoardCanvasWidth / 4;
     float center_y = kBoardCanvasHeight / 2 + kBoardCanvasHeightOffset;
     float width = kBoardCanvasHeight - kBoardCanvasMargin;
@@ -277,7 +288,7 @@ private:
   }
 
   void RenderShipsMyBoard(float board_center_x, float board_center_y, float board_width){
-    for(Ship ship : ref_my_board_.on_board_ships_){
+    for(Ship ship : Snapshot().my.ships){
       RenderShip(ship.GetType(), ship.GetHeadLoaction(), ship.GetDirection(), board_center_x, board_center_y, board_width);
     }
   }
@@ -310,43 +321,15 @@ private:
   }
 
   void RenderRectangleWithShade(float center_x, float center_y, float width, float height, float r, float g, float b){
-    float left_top_x = center_x - width / 2;
-    float left_top_y = center_y + height / 2;
-
-    float left_bottom_x = center_x - width / 2;
-    float left_bottom_y = center_y - height / 2;
-
-    float right_top_x = center_x + width / 2;
-    float right_top_y = center_y + height / 2;
-
-    float right_bottom_x = center_x + width / 2;
-    float right_bottom_y = center_y - height / 2;
-
-    glColor3f (r, g, b);
-    glBegin(GL_POLYGON);
-    glVertex3f(left_top_x, left_top_y, 0.0);
-    glVertex3f(right_top_x, right_top_y, 0.0);
-    glVertex3f(right_bottom_x, right_bottom_y, 0.0);
-    glVertex3f(left_bottom_x, left_bottom_y, 0.0);
-    glEnd();
-
-    glColor3f (0.0, 0.0, 0.0);
-    glLineWidth(3);
-    glBegin(GL_LINE_LOOP);
-    glVertex3f(left_top_x, left_top_y, 0.0);
-    glVertex3f(right_top_x, right_top_y, 0.0);
-    glVertex3f(right_bottom_x, right_bottom_y, 0.0);
-    glVertex3f(left_bottom_x, left_bottom_y, 0.0);
-    glEnd();
-
-    glLineWidth(kBoardLineWidth);
+    renderer_.FillRect(center_x, center_y, width, height, r, g, b);
+    renderer_.StrokeRect(center_x, center_y, width, height, 0.0, 0.0, 0.0);
   }
 
   void RenderStatesMyBoard(float board_center_x, float board_center_y, float board_width){
     for(size_t i = 0; i < kDim * kDim; i++){
       size_t row = i / kDim;
       size_t col = i % kDim;
-      const unsigned char & state = ref_my_board_.states_[i];
+      unsigned char state = Snapshot().my.states[i];
       RenderOneStateMyBoard(state, ColToCenterX(col, board_center_x, board_width), RowToCenterY(row, board_center_y, board_width));
     }
   }
@@ -364,55 +347,17 @@ private:
   }
 
   void RenderOneStateMyBoard(unsigned char state, float center_x, float center_y){
-    if(state & Board::ATTACKED){
+    if(state & GameSnapshot::kAttacked){
       RenderString(std::string().append(1, 'x'),center_x + x_offet_for_better_display_, center_y);
     }
   }
 
   void RenderSquare(float center_x, float center_y, float width){
-
-    float left_top_x = center_x - width / 2;
-    float left_top_y = center_y + width / 2;
-
-    float left_bottom_x = center_x - width / 2;
-    float left_bottom_y = center_y - width / 2;
-
-    float right_top_x = center_x + width / 2;
-    float right_top_y = center_y + width / 2;
-
-    float right_bottom_x = center_x + width / 2;
-    float right_bottom_y = center_y - width / 2;
-
-    glBegin(GL_LINE_LOOP);
-    glVertex3f(left_top_x, left_top_y, 0.0);
-    glVertex3f(right_top_x, right_top_y, 0.0);
-    glVertex3f(right_bottom_x, right_bottom_y, 0.0);
-    glVertex3f(left_bottom_x, left_bottom_y, 0.0);
-    glEnd();
+    renderer_.StrokeRect(center_x, center_y, width, width, 0.0, 0.0, 0.0);
   }
 
   void RenderShade(float center_x, float center_y, float width, float r, float g, float b){
-
-    float left_top_x = center_x - width / 2;
-    float left_top_y = center_y + width / 2;
-
-    float left_bottom_x = center_x - width / 2;
-    float left_bottom_y = center_y - width / 2;
-
-    float right_top_x = center_x + width / 2;
-    float right_top_y = center_y + width / 2;
-
-    float right_bottom_x = center_x + width / 2;
-    float right_bottom_y = center_y - width / 2;
-
-    glColor3f(r, g, b);
-    glBegin(GL_POLYGON);
-    glVertex3f(left_top_x, left_top_y, 0.0);
-    glVertex3f(right_top_x, right_top_y, 0.0);
-    glVertex3f(right_bottom_x, right_bottom_y, 0.0);
-    glVertex3f(left_bottom_x, left_bottom_y, 0.0);
-    glEnd();
-    glColor3d(kDefaultColorR, kDefaultColorG, kDefaultColorB);
+    renderer_.FillRect(center_x, center_y, width, width, r, g, b);
   }
 
 
@@ -438,15 +383,16 @@ private:
     }
   }
 
-// TODO: need better method to render texts
   void RenderString(const std::string & s, float center_x, float center_y){
-    DrawString(s, center_x, center_y);
+    RenderString(s, center_x, center_y, 0.0, 0.0, 0.0);
   }
 
   void RenderString(const std::string & s, float center_x, float center_y, float r, float g, float b){
-    DrawString(s, center_x, center_y, r, g, b);
+    renderer_.Text(s, static_cast<int>(center_x), static_cast<int>(center_y), r, g, b);
   }
 
 };
 
+typedef BasicGameUi<ClassicRules> GameUi;
+
 #endif //GRAPTHIC_GAME_UI_H_
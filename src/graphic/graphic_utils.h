@@ -15,483 +15,492 @@ static void drawOnePoint(float x, float y){
   glEnd();
 }
 
-static void DrawString(const std::string & s, int x, int y, float r, float g, float b) {
-  int offset = (s.length() + 1) * 4;
-  x = x - offset;
-  y = y - 3;
+// plots the points of one glyph with its pen at x, y, returns how far the pen moves on.
+// a point is drawn 4 pixels wide, so a glyph covers 2 pixels more all around its points.
+template<typename Plot>
+static int PlotGlyph(const char c, int x, int y, Plot plot) {
   int startX = x;
-  glColor3f(r, g, b);
-  //glBegin(GL_POINTS);
-  for (const char & c : s ){
-    if (c == 'a') {
-      for (int i = 0; i < 8; i++) {
-        drawOnePoint(x + 1, y + i);
-        drawOnePoint(x + 7, y + i);
-      }
-      for (int i = 2; i <= 6; i++) {
-        drawOnePoint(x + i, y + 8);
-        drawOnePoint(x + i, y + 4);
-      }
-      x += 8;
-    } else if (c == 'b') {
-      for (int i = 0; i < 8; i++) {
-        drawOnePoint(x + 1, y + i);
-      }
-      for (int i = 1; i <= 6; i++) {
-        drawOnePoint(x + i, y);
-        drawOnePoint(x + i, y + 4);
-        drawOnePoint(x + i, y + 8);
-      }
-      drawOnePoint(x + 7, y + 5);
-      drawOnePoint(x + 7, y + 7);
-      drawOnePoint(x + 7, y + 6);
-      drawOnePoint(x + 7, y + 1);
-      drawOnePoint(x + 7, y + 2);
-      drawOnePoint(x + 7, y + 3);
-      x += 8;
-    } else if (c == 'c') {
-      for (int i = 1; i <= 7; i++) {
-        drawOnePoint(x + 1, y + i);
-      }
-      for (int i = 2; i <= 5; i++) {
-        drawOnePoint(x + i, y);
-        drawOnePoint(x + i, y + 8);
-      }
-      drawOnePoint(x + 6, y + 1);
-      drawOnePoint(x + 6, y + 2);
+  if (c == 'a') {
+    for (int i = 0; i < 8; i++) {
+      plot(x + 1, y + i);
+      plot(x + 7, y + i);
+    }
+    for (int i = 2; i <= 6; i++) {
+      plot(x + i, y + 8);
+      plot(x + i, y + 4);
+    }
+    x += 8;
+  } else if (c == 'b') {
+    for (int i = 0; i < 8; i++) {
+      plot(x + 1, y + i);
+    }
+    for (int i = 1; i <= 6; i++) {
+      plot(x + i, y);
+      plot(x + i, y + 4);
+      plot(x + i, y + 8);
+    }
+    plot(x + 7, y + 5);
+    plot(x + 7, y + 7);
+    plot(x + 7, y + 6);
+    plot(x + 7, y + 1);
+    plot(x + 7, y + 2);
+    plot(x + 7, y + 3);
+    x += 8;
+  } else if (c == 'c') {
+    for (int i = 1; i <= 7; i++) {
+      plot(x + 1, y + i);
+    }
+    for (int i = 2; i <= 5; i++) {
+      plot(x + i, y);
+      plot(x + i, y + 8);
+    }
+    plot(x + 6, y + 1);
+    plot(x + 6, y + 2);
 
-      drawOnePoint(x + 6, y + 6);
-      drawOnePoint(x + 6, y + 7);
+    plot(x + 6, y + 6);
+    plot(x + 6, y + 7);
 
-      x += 8;
-    } else if (c == 'd') {
-      for (int i = 0; i <= 8; i++) {
-        drawOnePoint(x + 1, y + i);
-      }
-      for (int i = 2; i <= 5; i++) {
-        drawOnePoint(x + i, y);
-        drawOnePoint(x + i, y + 8);
-      }
-      drawOnePoint(x + 6, y + 1);
-      drawOnePoint(x + 6, y + 2);
-      drawOnePoint(x + 6, y + 3);
-      drawOnePoint(x + 6, y + 4);
-      drawOnePoint(x + 6, y + 5);
-      drawOnePoint(x + 6, y + 6);
-      drawOnePoint(x + 6, y + 7);
+    x += 8;
+  } else if (c == 'd') {
+    for (int i = 0; i <= 8; i++) {
+      plot(x + 1, y + i);
+    }
+    for (int i = 2; i <= 5; i++) {
+      plot(x + i, y);
+      plot(x + i, y + 8);
+    }
+    plot(x + 6, y + 1);
+    plot(x + 6, y + 2);
+    plot(x + 6, y + 3);
+    plot(x + 6, y + 4);
+    plot(x + 6, y + 5);
+    plot(x + 6, y + 6);
+    plot(x + 6, y + 7);
 
-      x += 8;
-    } else if (c == 'e') {
-      for (int i = 0; i <= 8; i++) {
-        drawOnePoint(x + 1, y + i);
-      }
-      for (int i = 1; i <= 6; i++) {
-        drawOnePoint(x + i, y + 0);
-        drawOnePoint(x + i, y + 8);
-      }
-      for (int i = 2; i <= 5; i++) {
-        drawOnePoint(x + i, y + 4);
-      }
-      x += 8;
-    } else if (c == 'f') {
-      for (int i = 0; i <= 8; i++) {
-        drawOnePoint(x + 1, y + i);
-      }
-      for (int i = 1; i <= 6; i++) {
-        drawOnePoint(x + i, y + 8);
-      }
-      for (int i = 2; i <= 5; i++) {
-        drawOnePoint(x + i, y + 4);
-      }
-      x += 8;
-    } else if (c == 'g') {
-      for (int i = 1; i <= 7; i++) {
-        drawOnePoint(x + 1, y + i);
-      }
-      for (int i = 2; i <= 5; i++) {
-        drawOnePoint(x + i, y);
-        drawOnePoint(x + i, y + 8);
-      }
-      drawOnePoint(x + 6, y + 1);
-      drawOnePoint(x + 6, y + 2);
-      drawOnePoint(x + 6, y + 3);
-      drawOnePoint(x + 5, y + 3);
-      drawOnePoint(x + 7, y + 3);
+    x += 8;
+  } else if (c == 'e') {
+    for (int i = 0; i <= 8; i++) {
+      plot(x + 1, y + i);
+    }
+    for (int i = 1; i <= 6; i++) {
+      plot(x + i, y + 0);
+      plot(x + i, y + 8);
+    }
+    for (int i = 2; i <= 5; i++) {
+      plot(x + i, y + 4);
+    }
+    x += 8;
+  } else if (c == 'f') {
+    for (int i = 0; i <= 8; i++) {
+      plot(x + 1, y + i);
+    }
+    for (int i = 1; i <= 6; i++) {
+      plot(x + i, y + 8);
+    }
+    for (int i = 2; i <= 5; i++) {
+      plot(x + i, y + 4);
+    }
+    x += 8;
+  } else if (c == 'g') {
+    for (int i = 1; i <= 7; i++) {
+      plot(x + 1, y + i);
+    }
+    for (int i = 2; i <= 5; i++) {
+      plot(x + i, y);
+      plot(x + i, y + 8);
+    }
+    plot(x + 6, y + 1);
+    plot(x + 6, y + 2);
+    plot(x + 6, y + 3);
+    plot(x + 5, y + 3);
+    plot(x + 7, y + 3);
 
-      drawOnePoint(x + 6, y + 6);
-      drawOnePoint(x + 6, y + 7);
+    plot(x + 6, y + 6);
+    plot(x + 6, y + 7);
 
-      x += 8;
-    } else if (c == 'h') {
-      for (int i = 0; i <= 8; i++) {
-        drawOnePoint(x + 1, y + i);
-        drawOnePoint(x + 7, y + i);
-      }
-      for (int i = 2; i <= 6; i++) {
-        drawOnePoint(x + i, y + 4);
-      }
-      x += 8;
-    } else if (c == 'i') {
-      for (int i = 0; i <= 8; i++) {
-        drawOnePoint(x + 3, y + i);
-      }
-      for (int i = 1; i <= 5; i++) {
-        drawOnePoint(x + i, y + 0);
-        drawOnePoint(x + i, y + 8);
-      }
-      x += 7;
-    } else if (c == 'j') {
-      for (int i = 1; i <= 8; i++) {
-        drawOnePoint(x + 6, y + i);
-      }
-      for (int i = 2; i <= 5; i++) {
-        drawOnePoint(x + i, y + 0);
-      }
-      drawOnePoint(x + 1, y + 3);
-      drawOnePoint(x + 1, y + 2);
-      drawOnePoint(x + 1, y + 1);
-      x += 8;
-    } else if (c == 'k') {
-      for (int i = 0; i <= 8; i++) {
-        drawOnePoint(x + 1, y + i);
-      }
-      drawOnePoint(x + 6, y + 8);
-      drawOnePoint(x + 5, y + 7);
-      drawOnePoint(x + 4, y + 6);
-      drawOnePoint(x + 3, y + 5);
-      drawOnePoint(x + 2, y + 4);
-      drawOnePoint(x + 2, y + 3);
-      drawOnePoint(x + 3, y + 4);
-      drawOnePoint(x + 4, y + 3);
-      drawOnePoint(x + 5, y + 2);
-      drawOnePoint(x + 6, y + 1);
-      drawOnePoint(x + 7, y);
-      x += 8;
-    } else if (c == 'l') {
-      for (int i = 0; i <= 8; i++) {
-        drawOnePoint(x + 1, y + i);
-      }
-      for (int i = 1; i <= 6; i++) {
-        drawOnePoint(x + i, y);
-      }
-      x += 7;
-    } else if (c == 'm') {
-      for (int i = 0; i <= 8; i++) {
-        drawOnePoint(x + 1, y + i);
-        drawOnePoint(x + 7, y + i);
-      }
-      drawOnePoint(x + 3, y + 6);
-      drawOnePoint(x + 2, y + 7);
-      drawOnePoint(x + 4, y + 5);
+    x += 8;
+  } else if (c == 'h') {
+    for (int i = 0; i <= 8; i++) {
+      plot(x + 1, y + i);
+      plot(x + 7, y + i);
+    }
+    for (int i = 2; i <= 6; i++) {
+      plot(x + i, y + 4);
+    }
+    x += 8;
+  } else if (c == 'i') {
+    for (int i = 0; i <= 8; i++) {
+      plot(x + 3, y + i);
+    }
+    for (int i = 1; i <= 5; i++) {
+      plot(x + i, y + 0);
+      plot(x + i, y + 8);
+    }
+    x += 7;
+  } else if (c == 'j') {
+    for (int i = 1; i <= 8; i++) {
+      plot(x + 6, y + i);
+    }
+    for (int i = 2; i <= 5; i++) {
+      plot(x + i, y + 0);
+    }
+    plot(x + 1, y + 3);
+    plot(x + 1, y + 2);
+    plot(x + 1, y + 1);
+    x += 8;
+  } else if (c == 'k') {
+    for (int i = 0; i <= 8; i++) {
+      plot(x + 1, y + i);
+    }
+    plot(x + 6, y + 8);
+    plot(x + 5, y + 7);
+    plot(x + 4, y + 6);
+    plot(x + 3, y + 5);
+    plot(x + 2, y + 4);
+    plot(x + 2, y + 3);
+    plot(x + 3, y + 4);
+    plot(x + 4, y + 3);
+    plot(x + 5, y + 2);
+    plot(x + 6, y + 1);
+    plot(x + 7, y);
+    x += 8;
+  } else if (c == 'l') {
+    for (int i = 0; i <= 8; i++) {
+      plot(x + 1, y + i);
+    }
+    for (int i = 1; i <= 6; i++) {
+      plot(x + i, y);
+    }
+    x += 7;
+  } else if (c == 'm') {
+    for (int i = 0; i <= 8; i++) {
+      plot(x + 1, y + i);
+      plot(x + 7, y + i);
+    }
+    plot(x + 3, y + 6);
+    plot(x + 2, y + 7);
+    plot(x + 4, y + 5);
 
-      drawOnePoint(x + 5, y + 6);
-      drawOnePoint(x + 6, y + 7);
-      drawOnePoint(x + 4, y + 5);
-      x += 8;
-    } else if (c == 'n') {
-      for (int i = 0; i <= 8; i++) {
-        drawOnePoint(x + 1, y + i);
-        drawOnePoint(x + 7, y + i);
-      }
-      drawOnePoint(x + 2, y + 7);
-      drawOnePoint(x + 2, y + 6);
-      drawOnePoint(x + 3, y + 5);
-      drawOnePoint(x + 4, y + 4);
-      drawOnePoint(x + 5, y + 3);
-      drawOnePoint(x + 6, y + 2);
-      drawOnePoint(x + 6, y + 1);
-      x += 8;
-    } else if (c == 'o' || c == '0') {
-      for (int i = 1; i <= 7; i++) {
-        drawOnePoint(x + 1, y + i);
-        drawOnePoint(x + 7, y + i);
-      }
-      for (int i = 2; i <= 6; i++) {
-        drawOnePoint(x + i, y + 8);
-        drawOnePoint(x + i, y + 0);
-      }
-      x += 8;
-    } else if (c == 'p') {
-      for (int i = 0; i <= 8; i++) {
-        drawOnePoint(x + 1, y + i);
-      }
-      for (int i = 2; i <= 5; i++) {
-        drawOnePoint(x + i, y + 8);
-        drawOnePoint(x + i, y + 4);
-      }
-      drawOnePoint(x + 6, y + 7);
-      drawOnePoint(x + 6, y + 5);
-      drawOnePoint(x + 6, y + 6);
-      x += 8;
-    } else if (c == 'q') {
-      for (int i = 1; i <= 7; i++) {
-        drawOnePoint(x + 1, y + i);
-        if (i != 1)
-          drawOnePoint(x + 7, y + i);
-      }
-      for (int i = 2; i <= 6; i++) {
-        drawOnePoint(x + i, y + 8);
-        if (i != 6)
-          drawOnePoint(x + i, y + 0);
-      }
-      drawOnePoint(x + 4, y + 3);
-      drawOnePoint(x + 5, y + 2);
-      drawOnePoint(x + 6, y + 1);
-      drawOnePoint(x + 7, y);
-      x += 8;
-    } else if (c == 'r') {
-      for (int i = 0; i <= 8; i++) {
-        drawOnePoint(x + 1, y + i);
-      }
-      for (int i = 2; i <= 5; i++) {
-        drawOnePoint(x + i, y + 8);
-        drawOnePoint(x + i, y + 4);
-      }
-      drawOnePoint(x + 6, y + 7);
-      drawOnePoint(x + 6, y + 5);
-      drawOnePoint(x + 6, y + 6);
+    plot(x + 5, y + 6);
+    plot(x + 6, y + 7);
+    plot(x + 4, y + 5);
+    x += 8;
+  } else if (c == 'n') {
+    for (int i = 0; i <= 8; i++) {
+      plot(x + 1, y + i);
+      plot(x + 7, y + i);
+    }
+    plot(x + 2, y + 7);
+    plot(x + 2, y + 6);
+    plot(x + 3, y + 5);
+    plot(x + 4, y + 4);
+    plot(x + 5, y + 3);
+    plot(x + 6, y + 2);
+    plot(x + 6, y + 1);
+    x += 8;
+  } else if (c == 'o' || c == '0') {
+    for (int i = 1; i <= 7; i++) {
+      plot(x + 1, y + i);
+      plot(x + 7, y + i);
+    }
+    for (int i = 2; i <= 6; i++) {
+      plot(x + i, y + 8);
+      plot(x + i, y + 0);
+    }
+    x += 8;
+  } else if (c == 'p') {
+    for (int i = 0; i <= 8; i++) {
+      plot(x + 1, y + i);
+    }
+    for (int i = 2; i <= 5; i++) {
+      plot(x + i, y + 8);
+      plot(x + i, y + 4);
+    }
+    plot(x + 6, y + 7);
+    plot(x + 6, y + 5);
+    plot(x + 6, y + 6);
+    x += 8;
+  } else if (c == 'q') {
+    for (int i = 1; i <= 7; i++) {
+      plot(x + 1, y + i);
+      if (i != 1)
+        plot(x + 7, y + i);
+    }
+    for (int i = 2; i <= 6; i++) {
+      plot(x + i, y + 8);
+      if (i != 6)
+        plot(x + i, y + 0);
+    }
+    plot(x + 4, y + 3);
+    plot(x + 5, y + 2);
+    plot(x + 6, y + 1);
+    plot(x + 7, y);
+    x += 8;
+  } else if (c == 'r') {
+    for (int i = 0; i <= 8; i++) {
+      plot(x + 1, y + i);
+    }
+    for (int i = 2; i <= 5; i++) {
+      plot(x + i, y + 8);
+      plot(x + i, y + 4);
+    }
+    plot(x + 6, y + 7);
+    plot(x + 6, y + 5);
+    plot(x + 6, y + 6);
+
+    plot(x + 4, y + 3);
+    plot(x + 5, y + 2);
+    plot(x + 6, y + 1);
+    plot(x + 7, y);
+    x += 8;
+  } else if (c == 's') {
+    for (int i = 2; i <= 7; i++) {
+      plot(x + i, y + 8);
+    }
+    plot(x + 1, y + 7);
+    plot(x + 1, y + 6);
+    plot(x + 1, y + 5);
+    for (int i = 2; i <= 6; i++) {
+      plot(x + i, y + 4);
+      plot(x + i, y);
+    }
+    plot(x + 7, y + 3);
+    plot(x + 7, y + 2);
+    plot(x + 7, y + 1);
+    plot(x + 1, y + 1);
+    plot(x + 1, y + 2);
+    x += 8;
+  } else if (c == 't') {
+    for (int i = 0; i <= 8; i++) {
+      plot(x + 4, y + i);
+    }
+    for (int i = 1; i <= 7; i++) {
+      plot(x + i, y + 8);
+    }
+    x += 7;
+  } else if (c == 'u') {
+    for (int i = 1; i <= 8; i++) {
+      plot(x + 1, y + i);
+      plot(x + 7, y + i);
+    }
+    for (int i = 2; i <= 6; i++) {
+      plot(x + i, y + 0);
+    }
+    x += 8;
+  } else if (c == 'v') {
+    for (int i = 2; i <= 8; i++) {
+      plot(x + 1, y + i);
+      plot(x + 6, y + i);
+    }
+    plot(x + 2, y + 1);
+    plot(x + 5, y + 1);
+    plot(x + 3, y);
+    plot(x + 4, y);
+    x += 7;
+  } else if (c == 'w') {
+    for (int i = 1; i <= 8; i++) {
+      plot(x + 1, y + i);
+      plot(x + 7, y + i);
+    }
+    plot(x + 2, y);
+    plot(x + 3, y);
+    plot(x + 5, y);
+    plot(x + 6, y);
+    for (int i = 1; i <= 6; i++) {
+      plot(x + 4, y + i);
+    }
+    x += 8;
+  } else if (c == 'x') {
+    for (int i = 1; i <= 7; i++)
+      plot(x + i, y + i);
+    for (int i = 7; i >= 1; i--)
+      plot(x + i, y + 8 - i);
+    x += 8;
+  } else if (c == 'y') {
+    plot(x + 4, y);
+    plot(x + 4, y + 1);
+    plot(x + 4, y + 2);
+    plot(x + 4, y + 3);
+    plot(x + 4, y + 4);
 
-      drawOnePoint(x + 4, y + 3);
-      drawOnePoint(x + 5, y + 2);
-      drawOnePoint(x + 6, y + 1);
-      drawOnePoint(x + 7, y);
-      x += 8;
-    } else if (c == 's') {
-      for (int i = 2; i <= 7; i++) {
-        drawOnePoint(x + i, y + 8);
-      }
-      drawOnePoint(x + 1, y + 7);
-      drawOnePoint(x + 1, y + 6);
-      drawOnePoint(x + 1, y + 5);
-      for (int i = 2; i <= 6; i++) {
-        drawOnePoint(x + i, y + 4);
-        drawOnePoint(x + i, y);
-      }
-      drawOnePoint(x + 7, y + 3);
-      drawOnePoint(x + 7, y + 2);
-      drawOnePoint(x + 7, y + 1);
-      drawOnePoint(x + 1, y + 1);
-      drawOnePoint(x + 1, y + 2);
-      x += 8;
-    } else if (c == 't') {
-      for (int i = 0; i <= 8; i++) {
-        drawOnePoint(x + 4, y + i);
-      }
-      for (int i = 1; i <= 7; i++) {
-        drawOnePoint(x + i, y + 8);
-      }
-      x += 7;
-    } else if (c == 'u') {
-      for (int i = 1; i <= 8; i++) {
-        drawOnePoint(x + 1, y + i);
-        drawOnePoint(x + 7, y + i);
-      }
-      for (int i = 2; i <= 6; i++) {
-        drawOnePoint(x + i, y + 0);
-      }
-      x += 8;
-    } else if (c == 'v') {
-      for (int i = 2; i <= 8; i++) {
-        drawOnePoint(x + 1, y + i);
-        drawOnePoint(x + 6, y + i);
-      }
-      drawOnePoint(x + 2, y + 1);
-      drawOnePoint(x + 5, y + 1);
-      drawOnePoint(x + 3, y);
-      drawOnePoint(x + 4, y);
-      x += 7;
-    } else if (c == 'w') {
-      for (int i = 1; i <= 8; i++) {
-        drawOnePoint(x + 1, y + i);
-        drawOnePoint(x + 7, y + i);
-      }
-      drawOnePoint(x + 2, y);
-      drawOnePoint(x + 3, y);
-      drawOnePoint(x + 5, y);
-      drawOnePoint(x + 6, y);
-      for (int i = 1; i <= 6; i++) {
-        drawOnePoint(x + 4, y + i);
-      }
-      x += 8;
-    } else if (c == 'x') {
-      for (int i = 1; i <= 7; i++)
-        drawOnePoint(x + i, y + i);
-      for (int i = 7; i >= 1; i--)
-        drawOnePoint(x + i, y + 8 - i);
-      x += 8;
-    } else if (c == 'y') {
-      drawOnePoint(x + 4, y);
-      drawOnePoint(x + 4, y + 1);
-      drawOnePoint(x + 4, y + 2);
-      drawOnePoint(x + 4, y + 3);
-      drawOnePoint(x + 4, y + 4);
+    plot(x + 3, y + 5);
+    plot(x + 2, y + 6);
+    plot(x + 1, y + 7);
+    plot(x + 1, y + 8);
 
-      drawOnePoint(x + 3, y + 5);
-      drawOnePoint(x + 2, y + 6);
-      drawOnePoint(x + 1, y + 7);
-      drawOnePoint(x + 1, y + 8);
+    plot(x + 5, y + 5);
+    plot(x + 6, y + 6);
+    plot(x + 7, y + 7);
+    plot(x + 7, y + 8);
+    x += 8;
+  } else if (c == 'z') {
+    for (int i = 1; i <= 6; i++) {
+      plot(x + i, y);
+      plot(x + i, y + 8);
+      plot(x + i, y + i);
+    }
+    plot(x + 6, y + 7);
+    x += 8;
+  } else if (c == '1') {
+    for (int i = 2; i <= 6; i++) {
+      plot(x + i, y);
+    }
+    for (int i = 1; i <= 8; i++) {
+      plot(x + 4, y + i);
+    }
+    plot(x + 3, y + 7);
+    x += 8;
+  } else if (c == '2') {
+    for (int i = 1; i <= 6; i++) {
+      plot(x + i, y);
+    }
+    for (int i = 2; i <= 5; i++) {
+      plot(x + i, y + 8);
+    }
+    plot(x + 1, y + 7);
+    plot(x + 1, y + 6);
 
-      drawOnePoint(x + 5, y + 5);
-      drawOnePoint(x + 6, y + 6);
-      drawOnePoint(x + 7, y + 7);
-      drawOnePoint(x + 7, y + 8);
-      x += 8;
-    } else if (c == 'z') {
-      for (int i = 1; i <= 6; i++) {
-        drawOnePoint(x + i, y);
-        drawOnePoint(x + i, y + 8);
-        drawOnePoint(x + i, y + i);
-      }
-      drawOnePoint(x + 6, y + 7);
-      x += 8;
-    } else if (c == '1') {
-      for (int i = 2; i <= 6; i++) {
-        drawOnePoint(x + i, y);
-      }
-      for (int i = 1; i <= 8; i++) {
-        drawOnePoint(x + 4, y + i);
-      }
-      drawOnePoint(x + 3, y + 7);
-      x += 8;
-    } else if (c == '2') {
-      for (int i = 1; i <= 6; i++) {
-        drawOnePoint(x + i, y);
-      }
-      for (int i = 2; i <= 5; i++) {
-        drawOnePoint(x + i, y + 8);
-      }
-      drawOnePoint(x + 1, y + 7);
-      drawOnePoint(x + 1, y + 6);
+    plot(x + 6, y + 7);
+    plot(x + 6, y + 6);
+    plot(x + 6, y + 5);
+    plot(x + 5, y + 4);
+    plot(x + 4, y + 3);
+    plot(x + 3, y + 2);
+    plot(x + 2, y + 1);
+    x += 8;
+  } else if (c == '3') {
+    for (int i = 1; i <= 5; i++) {
+      plot(x + i, y + 8);
+      plot(x + i, y);
+    }
+    for (int i = 1; i <= 7; i++) {
+      plot(x + 6, y + i);
+    }
+    for (int i = 2; i <= 5; i++) {
+      plot(x + i, y + 4);
+    }
+    x += 8;
+  } else if (c == '4') {
+    for (int i = 2; i <= 8; i++) {
+      plot(x + 1, y + i);
+    }
+    for (int i = 2; i <= 7; i++) {
+      plot(x + i, y + 1);
+    }
+    for (int i = 0; i <= 4; i++) {
+      plot(x + 4, y + i);
+    }
+    x += 8;
+  } else if (c == '5') {
+    for (int i = 1; i <= 7; i++) {
+      plot(x + i, y + 8);
+    }
+    for (int i = 4; i <= 7; i++) {
+      plot(x + 1, y + i);
+    }
+    plot(x + 1, y + 1);
+    plot(x + 2, y);
+    plot(x + 3, y);
+    plot(x + 4, y);
+    plot(x + 5, y);
+    plot(x + 6, y);
 
-      drawOnePoint(x + 6, y + 7);
-      drawOnePoint(x + 6, y + 6);
-      drawOnePoint(x + 6, y + 5);
-      drawOnePoint(x + 5, y + 4);
-      drawOnePoint(x + 4, y + 3);
-      drawOnePoint(x + 3, y + 2);
-      drawOnePoint(x + 2, y + 1);
-      x += 8;
-    } else if (c == '3') {
-      for (int i = 1; i <= 5; i++) {
-        drawOnePoint(x + i, y + 8);
-        drawOnePoint(x + i, y);
-      }
-      for (int i = 1; i <= 7; i++) {
-        drawOnePoint(x + 6, y + i);
-      }
-      for (int i = 2; i <= 5; i++) {
-        drawOnePoint(x + i, y + 4);
-      }
-      x += 8;
-    } else if (c == '4') {
-      for (int i = 2; i <= 8; i++) {
-        drawOnePoint(x + 1, y + i);
-      }
-      for (int i = 2; i <= 7; i++) {
-        drawOnePoint(x + i, y + 1);
-      }
-      for (int i = 0; i <= 4; i++) {
-        drawOnePoint(x + 4, y + i);
-      }
-      x += 8;
-    } else if (c == '5') {
-      for (int i = 1; i <= 7; i++) {
-        drawOnePoint(x + i, y + 8);
-      }
-      for (int i = 4; i <= 7; i++) {
-        drawOnePoint(x + 1, y + i);
-      }
-      drawOnePoint(x + 1, y + 1);
-      drawOnePoint(x + 2, y);
-      drawOnePoint(x + 3, y);
-      drawOnePoint(x + 4, y);
-      drawOnePoint(x + 5, y);
-      drawOnePoint(x + 6, y);
+    plot(x + 7, y + 1);
+    plot(x + 7, y + 2);
+    plot(x + 7, y + 3);
 
-      drawOnePoint(x + 7, y + 1);
-      drawOnePoint(x + 7, y + 2);
-      drawOnePoint(x + 7, y + 3);
+    plot(x + 6, y + 4);
+    plot(x + 5, y + 4);
+    plot(x + 4, y + 4);
+    plot(x + 3, y + 4);
+    plot(x + 2, y + 4);
+    x += 8;
+  } else if (c == '6') {
+    for (int i = 1; i <= 7; i++) {
+      plot(x + 1, y + i);
+    }
+    for (int i = 2; i <= 6; i++) {
+      plot(x + i, y);
+    }
+    for (int i = 2; i <= 5; i++) {
+      plot(x + i, y + 4);
+      plot(x + i, y + 8);
+    }
+    plot(x + 7, y + 1);
+    plot(x + 7, y + 2);
+    plot(x + 7, y + 3);
+    plot(x + 6, y + 4);
+    x += 8;
+  } else if (c == '7') {
+    for (int i = 0; i <= 7; i++)
+      plot(x + i, y + 8);
+    plot(x + 7, y + 7);
+    plot(x + 7, y + 6);
 
-      drawOnePoint(x + 6, y + 4);
-      drawOnePoint(x + 5, y + 4);
-      drawOnePoint(x + 4, y + 4);
-      drawOnePoint(x + 3, y + 4);
-      drawOnePoint(x + 2, y + 4);
-      x += 8;
-    } else if (c == '6') {
-      for (int i = 1; i <= 7; i++) {
-        drawOnePoint(x + 1, y + i);
-      }
-      for (int i = 2; i <= 6; i++) {
-        drawOnePoint(x + i, y);
-      }
-      for (int i = 2; i <= 5; i++) {
-        drawOnePoint(x + i, y + 4);
-        drawOnePoint(x + i, y + 8);
-      }
-      drawOnePoint(x + 7, y + 1);
-      drawOnePoint(x + 7, y + 2);
-      drawOnePoint(x + 7, y + 3);
-      drawOnePoint(x + 6, y + 4);
-      x += 8;
-    } else if (c == '7') {
-      for (int i = 0; i <= 7; i++)
-        drawOnePoint(x + i, y + 8);
-      drawOnePoint(x + 7, y + 7);
-      drawOnePoint(x + 7, y + 6);
+    plot(x + 6, y + 5);
+    plot(x + 5, y + 4);
+    plot(x + 4, y + 3);
+    plot(x + 3, y + 2);
+    plot(x + 2, y + 1);
+    plot(x + 1, y);
+    x += 8;
+  } else if (c == '8') {
+    for (int i = 1; i <= 7; i++) {
+      plot(x + 1, y + i);
+      plot(x + 7, y + i);
+    }
+    for (int i = 2; i <= 6; i++) {
+      plot(x + i, y + 8);
+      plot(x + i, y + 0);
+    }
+    for (int i = 2; i <= 6; i++) {
+      plot(x + i, y + 4);
+    }
+    x += 8;
+  } else if (c == '9') {
+    for (int i = 1; i <= 7; i++) {
+      plot(x + 7, y + i);
+    }
+    for (int i = 5; i <= 7; i++) {
+      plot(x + 1, y + i);
+    }
+    for (int i = 2; i <= 6; i++) {
+      plot(x + i, y + 8);
+      plot(x + i, y + 0);
+    }
+    for (int i = 2; i <= 6; i++) {
+      plot(x + i, y + 4);
+    }
+    plot(x + 1, y + 0);
+    x += 8;
+  } else if (c == '.') {
+    plot(x + 1, y);
+    x += 2;
+  } else if (c == ',') {
+    plot(x + 1, y);
+    plot(x + 1, y + 1);
+    x += 2;
+  } else if (c == ' ') {
+    x += 8;
+  }
+  x += 2;
+  return x - startX;
+}
 
-      drawOnePoint(x + 6, y + 5);
-      drawOnePoint(x + 5, y + 4);
-      drawOnePoint(x + 4, y + 3);
-      drawOnePoint(x + 3, y + 2);
-      drawOnePoint(x + 2, y + 1);
-      drawOnePoint(x + 1, y);
-      x += 8;
-    } else if (c == '8') {
-      for (int i = 1; i <= 7; i++) {
-        drawOnePoint(x + 1, y + i);
-        drawOnePoint(x + 7, y + i);
-      }
-      for (int i = 2; i <= 6; i++) {
-        drawOnePoint(x + i, y + 8);
-        drawOnePoint(x + i, y + 0);
-      }
-      for (int i = 2; i <= 6; i++) {
-        drawOnePoint(x + i, y + 4);
-      }
-      x += 8;
-    } else if (c == '9') {
-      for (int i = 1; i <= 7; i++) {
-        drawOnePoint(x + 7, y + i);
-      }
-      for (int i = 5; i <= 7; i++) {
-        drawOnePoint(x + 1, y + i);
-      }
-      for (int i = 2; i <= 6; i++) {
-        drawOnePoint(x + i, y + 8);
-        drawOnePoint(x + i, y + 0);
-      }
-      for (int i = 2; i <= 6; i++) {
-        drawOnePoint(x + i, y + 4);
-      }
-      drawOnePoint(x + 1, y + 0);
-      x += 8;
-    } else if (c == '.') {
-      drawOnePoint(x + 1, y);
-      x += 2;
-    } else if (c == ',') {
-      drawOnePoint(x + 1, y);
-      drawOnePoint(x + 1, y + 1);
-      x += 2;
-    } else if (c == '\n') {
+static void DrawString(const std::string & s, int x, int y, float r, float g, float b) {
+  int offset = (s.length() + 1) * 4;
+  x = x - offset;
+  y = y - 3;
+  int startX = x;
+  glColor3f(r, g, b);
+  for (const char & c : s ){
+    if (c == '\n') {
       y -= 10;
-      x = startX;
-    } else if (c == ' ') {
-      x += 8;
+      x = startX + 2;
+      continue;
     }
-    x += 2;
+    x += PlotGlyph(c, x, y, drawOnePoint);
   }
-  //glEnd();
 }
 
 static void DrawString(const std::string & s, int x, int y) {
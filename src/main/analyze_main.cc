@@ -0,0 +1,70 @@
+//
+// Analytics over game record files: heatmaps of the shots, hit rate by move, moves to win and first sinks by strategy.
+//
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "tclap/CmdLine.h"
+#include "simulation/game_record_analysis.h"
+#include "utils/mapped_file.h"
+
+struct AnalyzeArgs{
+  std::vector<std::string> files;
+  size_t threads = 0;
+};
+
+bool ParseArgs(const int argc, const char** argv, AnalyzeArgs* args){
+  try{
+    TCLAP::CmdLine cmd("battleship game record analytics", ' ', "1.0");
+
+    TCLAP::ValueArg<std::size_t> threadsArg("j", "threads", "worker threads, 0 for one per core", false, 0, "size_t");
+    TCLAP::UnlabeledMultiArg<std::string> filesArg("files", "record files written by the simulator, all of the same rules", true, "file");
+
+    cmd.add(threadsArg);
+    cmd.add(filesArg);
+
+    // Parse the argv array.
+    cmd.parse(argc, argv);
+
+    // Get the value parsed by each arg.
+    args->threads = threadsArg.getValue();
+    args->files = filesArg.getValue();
+
+  } catch (TCLAP::ArgException &e){
+    std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+template<typename Rules>
+int Analyze(const AnalyzeArgs & args){
+  BasicGameRecordAnalysis<Rules> analysis(args.threads);
+  for(const std::string & file : args.files){
+    if(!analysis.AddFile(file)){
+      std::cerr << "error: " << file << " is not a record file of the same rules as " << args.files[0] << std::endl;
+      return 1;
+    }
+  }
+  analysis.Run().Print(stdout);
+  return 0;
+}
+
+// the rules of the first file are the rules of all
+int main(const int argc, const char** argv){
+  AnalyzeArgs args;
+  if(!ParseArgs(argc, argv, &args)) return 1;
+
+  MappedFile first;
+  if(!first.Open(args.files[0])){
+    std::cerr << "error: can't open " << args.files[0] << std::endl;
+    return 1;
+  }
+  if(CheckGameRecordFileHeader<ClassicRules>(first.GetData(), first.GetLength())) return Analyze<ClassicRules>(args);
+  if(CheckGameRecordFileHeader<LargeRules>(first.GetData(), first.GetLength())) return Analyze<LargeRules>(args);
+  if(CheckGameRecordFileHeader<HugeRules>(first.GetData(), first.GetLength())) return Analyze<HugeRules>(args);
+  std::cerr << "error: " << args.files[0] << " is not a record file" << std::endl;
+  return 1;
+}
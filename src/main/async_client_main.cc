@@ -0,0 +1,93 @@
+//
+// Headless client playing many games at once over a few connections, on a few threads.
+//
+
+// the probability of every cell is logged at trace level on every move, millions of games can't afford it,
+// -DBATTLESHIP_LOG_LEVEL=0 brings it back
+#ifndef BATTLESHIP_LOG_LEVEL
+#define BATTLESHIP_LOG_LEVEL 2
+#endif
+
+#include <chrono>
+#include <string>
+#include "tclap/CmdLine.h"
+#include "client/async_game_host.h"
+
+struct AsyncClientArgs{
+  AsyncHostSetting host;
+  size_t threads = 2;
+};
+
+bool ParseArgs(const int argc, const char** argv, AsyncClientArgs* args){
+  try{
+    TCLAP::CmdLine cmd("battleship game async client", ' ', "1.0");
+
+    TCLAP::ValueArg<std::string> typeArg("t", "type", "client type: initiator, listener or matched (asks a server for its games), lower case", true, "not a type", "string");
+    TCLAP::ValueArg<std::string> ipArg("a", "ip", "peer or server ip address", false, "127.0.0.1", "string");
+    TCLAP::ValueArg<std::size_t> portArg("p", "port", "peer port", true, 0, "size_t");
+    TCLAP::ValueArg<unsigned> idArg("i", "id", "client id", true, 0, "unsigned");
+    TCLAP::ValueArg<unsigned> gameArg("g", "game", "game id of the first game of an initiator", false, 0, "unsigned");
+    TCLAP::ValueArg<std::size_t> gamesArg("n", "games", "number of games an initiator or matched client plays at once", false, 1, "size_t");
+    TCLAP::ValueArg<std::size_t> connectionsArg("c", "connections", "connections an initiator or matched client spreads its games over, or a listener accepts", false, 1, "size_t");
+    TCLAP::ValueArg<std::size_t> batchArg("b", "batch", "messages of different games coalesced into one write at most, 1 writes them one by one", false, AsyncConnection::kDefaultMaxBatch, "size_t");
+    TCLAP::ValueArg<std::size_t> threadsArg("j", "threads", "threads running the games", false, 2, "size_t");
+    TCLAP::ValueArg<std::string> attackArg("", "attack", "attack strategy: random, dfs, probability, dfs_probability or monte_carlo", false, "dfs_probability", "string");
+
+    cmd.add(typeArg);
+    cmd.add(ipArg);
+    cmd.add(portArg);
+    cmd.add(idArg);
+    cmd.add(gameArg);
+    cmd.add(gamesArg);
+    cmd.add(connectionsArg);
+    cmd.add(batchArg);
+    cmd.add(threadsArg);
+    cmd.add(attackArg);
+
+    // Parse the argv array.
+    cmd.parse(argc, argv);
+
+    // Get the value parsed by each arg.
+    if(typeArg.getValue() == "initiator") args->host.type = ClientType::kInitiator;
+    else if(typeArg.getValue() == "matched") args->host.type = ClientType::kMatched;
+    else args->host.type = ClientType::kListener;
+    args->host.peer_ip = ipArg.getValue();
+    args->host.port = portArg.getValue();
+    args->host.cli_id = idArg.getValue();
+    args->host.first_game_id = gameArg.getValue();
+    args->host.games = gamesArg.getValue();
+    args->host.connections = connectionsArg.getValue() > 0 ? connectionsArg.getValue() : 1;
+    args->host.batch = batchArg.getValue();
+    args->threads = threadsArg.getValue() > 0 ? threadsArg.getValue() : 1;
+    if(!StrategyAttackFromString(attackArg.getValue(), &args->host.attack)){
+      std::cerr << "error: unknown strategy" << std::endl;
+      return false;
+    }
+
+  } catch (TCLAP::ArgException &e){
+    std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(const int argc, const char** argv){
+  AsyncClientArgs args;
+  if(!ParseArgs(argc, argv, &args)) return 1;
+
+  asio::io_service io_service;
+  AsyncGameHost host(io_service, args.host);
+  auto start = std::chrono::steady_clock::now();
+  host.Start();
+  AsyncGameHost::Run(io_service, args.threads);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  AsyncHostResult res = host.GetResult();
+  std::cerr << res.finished << " games finished, " << res.broken_off << " broken off, " << res.wins << " won, "
+            << (res.finished > 0 ? static_cast<double>(res.moves) / res.finished : 0.0) << " moves per game, "
+            << seconds << "s on " << args.threads << " threads, "
+            << (res.writes > 0 ? static_cast<double>(res.written_frames) / res.writes : 0.0) << " messages per write, "
+            << (res.reads > 0 ? static_cast<double>(res.read_frames) / res.reads : 0.0) << " messages per read" << std::endl;
+  return res.broken_off == 0 ? 0 : 1;
+}
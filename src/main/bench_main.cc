@@ -0,0 +1,327 @@
+//
+// Micro-benchmarks of the hot paths: the boards, the AI and the message codecs.
+//
+
+// the probability of every cell is logged at trace level on every move, that is not what is measured
+#define BATTLESHIP_LOG_LEVEL 2
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include "tclap/CmdLine.h"
+#include "client/client_brain.h"
+#include "core/game/board.h"
+#include "core/networking/messages.h"
+#include "utils/benchmark.h"
+
+struct BenchArgs{
+  BenchmarkSetting setting;
+  std::string filter;
+  std::string json;
+};
+
+bool ParseArgs(const int argc, const char** argv, BenchArgs* args){
+  try{
+    TCLAP::CmdLine cmd("battleship game micro-benchmarks", ' ', "1.0");
+
+    TCLAP::ValueArg<std::string> filterArg("f", "filter", "only the benchmarks with this in their name", false, "", "string");
+    TCLAP::ValueArg<std::size_t> samplesArg("n", "samples", "timed samples of every benchmark", false, 100, "size_t");
+    TCLAP::ValueArg<std::size_t> warmUpArg("w", "warm-up", "untimed samples for this long before, in ms", false, 100, "size_t");
+    TCLAP::ValueArg<std::string> jsonArg("j", "json", "also write the results to this file as json", false, "", "string");
+
+    cmd.add(filterArg);
+    cmd.add(samplesArg);
+    cmd.add(warmUpArg);
+    cmd.add(jsonArg);
+
+    // Parse the argv array.
+    cmd.parse(argc, argv);
+
+    // Get the value parsed by each arg.
+    args->filter = filterArg.getValue();
+    args->setting.samples = samplesArg.getValue();
+    args->setting.warm_up_ms = warmUpArg.getValue();
+    args->json = jsonArg.getValue();
+    if(args->setting.samples == 0){
+      std::cerr << "error: no samples" << std::endl;
+      return false;
+    }
+
+  } catch (TCLAP::ArgException &e){
+    std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+// a board with a fleet placed at random, a placement unit plans one fleet only
+static std::unique_ptr<Board> MakeFleet(){
+  ShipPlacementUnit placement_unit;
+  std::unique_ptr<Board> board(new Board());
+  for(auto placement : placement_unit.ShipPlacingPlan(StrategyPlaceShip::kRandom)){
+    bool success = board->PlaceAShip(placement.type, placement.head_location, placement.direction);
+    assert(success);
+  }
+  return board;
+}
+
+// what the enemy board looks like some way into a game: a third of it shot at, the hits on ships
+static void MarkMidGame(ImagineBoard & enemy_board, std::mt19937 & rng){
+  std::unique_ptr<Board> fleet = MakeFleet();
+  std::vector<size_t> locations(ClassicRules::kCellNum);
+  std::iota(locations.begin(), locations.end(), 0);
+  std::shuffle(locations.begin(), locations.end(), rng);
+  for(size_t i = 0; i < locations.size() / 3; ++i){
+    AttackResult res = fleet->Attack(locations[i]);
+    enemy_board.MarkAttack(res.location);
+    if(res.success){
+      enemy_board.MarkOccupied(res.location);
+      enemy_board.DestroyOneOnBoard(res.sink_ship_type);
+    }
+    enemy_board.UpdateLastAttackInfo(res);
+  }
+}
+
+static void BenchBoards(BenchmarkRunner & runner, std::mt19937 & rng){
+  std::unique_ptr<Board> board;
+  std::vector<size_t> order(ClassicRules::kCellNum);
+  std::iota(order.begin(), order.end(), 0);
+  runner.Run("board/attack", [&](){
+    board = MakeFleet();
+    std::shuffle(order.begin(), order.end(), rng);
+  }, [&](){
+    for(size_t location : order){
+      KeepValue(board->Attack(location));
+    }
+    return order.size();
+  });
+
+  ImagineBoard enemy_board;
+  MarkMidGame(enemy_board, rng);
+  runner.Run("imagine_board/does_ship_fit", [](){}, [&](){
+    size_t fits = 0;
+    for(ShipType type : GetShipTypeList()){
+      for(size_t location = 0; location < ClassicRules::kCellNum; ++location){
+        fits += enemy_board.DoesShipFit(type, location, Direction::kHorisontal);
+        fits += enemy_board.DoesShipFit(type, location, Direction::kVertical);
+      }
+    }
+    KeepValue(fits);
+    return GetShipTypeList().size() * ClassicRules::kCellNum * 2;
+  });
+
+  const size_t recalculations = 10;
+  ImagineBoard empty_board;
+  ProbabilityBoard empty_probability(empty_board);
+  runner.Run("probability_board/recalculate/empty", [](){}, [&](){
+    for(size_t i = 0; i < recalculations; ++i){
+      empty_probability.RecalculateProbability();
+    }
+    return recalculations;
+  });
+
+  ProbabilityBoard mid_game_probability(enemy_board);
+  runner.Run("probability_board/recalculate/mid_game", [](){}, [&](){
+    for(size_t i = 0; i < recalculations; ++i){
+      mid_game_probability.RecalculateProbability();
+    }
+    return recalculations;
+  });
+}
+
+// an operation is one move: deciding where to fire and taking in the result, the fleet answering is timed too
+static void BenchStrategies(BenchmarkRunner & runner){
+  const StrategyAttack strategies[] = {StrategyAttack::kRandom, StrategyAttack::kDFS, StrategyAttack::kProbabilitySimple,
+                                       StrategyAttack::kDFSProbability, StrategyAttack::kMonteCarlo};
+  Board my_board;
+  for(StrategyAttack strategy : strategies){
+    std::unique_ptr<Board> fleet;
+    std::unique_ptr<ClientBrain> brain;
+    runner.Run("attack_location_unit/" + StrategyAttackToString(strategy), [&](){
+      fleet = MakeFleet();
+      brain.reset(new ClientBrain(my_board));
+    }, [&](){
+      size_t moves = 0;
+      while(true){
+        AttackResult res = fleet->Attack(brain->GenerateNextAttackLocation(strategy));
+        brain->DigestAttackResult(res);
+        moves += 1;
+        if(res.attacker_win) return moves;
+      }
+    });
+  }
+}
+
+// a unit plans one fleet, so making the unit is timed with its plan
+static void BenchPlacement(BenchmarkRunner & runner){
+  const StrategyPlaceShip strategies[] = {StrategyPlaceShip::kFixed, StrategyPlaceShip::kRandom};
+  const size_t plans = 100;
+  for(StrategyPlaceShip strategy : strategies){
+    runner.Run("ship_placement_unit/" + StrategyPlaceShipToString(strategy), [](){}, [&](){
+      for(size_t i = 0; i < plans; ++i){
+        ShipPlacementUnit placement_unit;
+        KeepValue(placement_unit.ShipPlacingPlan(strategy));
+      }
+      return plans;
+    });
+  }
+}
+
+// a make writes a whole message, a resolve reads the body of one
+static void BenchCodecs(BenchmarkRunner & runner){
+  const size_t messages = 1000;
+  unsigned char buffer[kMaxBufferLength];
+  std::size_t length = 0;
+  ClientId cli_id = 0;
+  GameId game_id = 0;
+  auto nothing = [](){};
+
+  runner.Run("codec/make_request_attack", nothing, [&](){
+    for(size_t i = 0; i < messages; ++i){
+      MakeRequestAttack(buffer, &length, 1, static_cast<GameId>(i), i % 100);
+      KeepValue(buffer);
+    }
+    return messages;
+  });
+  std::size_t location = 0;
+  runner.Run("codec/resolve_request_attack", nothing, [&](){
+    for(size_t i = 0; i < messages; ++i){
+      ResolveRequestAttack(buffer + kHeaderLength, length - kHeaderLength, &cli_id, &game_id, &location);
+      KeepValue(location);
+    }
+    return messages;
+  });
+
+  runner.Run("codec/make_reply_attack", nothing, [&](){
+    for(size_t i = 0; i < messages; ++i){
+      MakeReplyAttack(buffer, &length, static_cast<GameId>(i), i % 2 == 0, kCruiser, false);
+      KeepValue(buffer);
+    }
+    return messages;
+  });
+  bool success = false;
+  ShipType type = kNotAShip;
+  bool attacker_win = false;
+  runner.Run("codec/resolve_reply_attack", nothing, [&](){
+    for(size_t i = 0; i < messages; ++i){
+      ResolveReplyAttack(buffer + kHeaderLength, length - kHeaderLength, &success, &type, &attacker_win);
+      KeepValue(type);
+    }
+    return messages;
+  });
+
+  runner.Run("codec/make_info_game_id", nothing, [&](){
+    for(size_t i = 0; i < messages; ++i){
+      MakeInfoGameId(buffer, &length, 1, static_cast<GameId>(i));
+      KeepValue(buffer);
+    }
+    return messages;
+  });
+  unsigned char version = 0;
+  runner.Run("codec/resolve_info_game_id", nothing, [&](){
+    for(size_t i = 0; i < messages; ++i){
+      ResolveInfoGameId(buffer + kHeaderLength, length - kHeaderLength, &cli_id, &game_id, &version);
+      KeepValue(game_id);
+    }
+    return messages;
+  });
+
+  runner.Run("codec/make_info_ready", nothing, [&](){
+    for(size_t i = 0; i < messages; ++i){
+      MakeInfoReady(buffer, &length, 1, static_cast<GameId>(i));
+      KeepValue(buffer);
+    }
+    return messages;
+  });
+  runner.Run("codec/resolve_info_ready", nothing, [&](){
+    for(size_t i = 0; i < messages; ++i){
+      ResolveInfoReady(buffer + kHeaderLength, length - kHeaderLength, &cli_id, &game_id);
+      KeepValue(game_id);
+    }
+    return messages;
+  });
+
+  runner.Run("codec/make_info_roll", nothing, [&](){
+    for(size_t i = 0; i < messages; ++i){
+      MakeInfoRoll(buffer, &length, 1, static_cast<GameId>(i), i);
+      KeepValue(buffer);
+    }
+    return messages;
+  });
+  unsigned long roll = 0;
+  runner.Run("codec/resolve_info_roll", nothing, [&](){
+    for(size_t i = 0; i < messages; ++i){
+      ResolveInfoRoll(buffer + kHeaderLength, length - kHeaderLength, &cli_id, &game_id, &roll);
+      KeepValue(roll);
+    }
+    return messages;
+  });
+
+  runner.Run("codec/make_request_match", nothing, [&](){
+    for(size_t i = 0; i < messages; ++i){
+      MakeRequestMatch(buffer, &length, static_cast<ClientId>(i), 3);
+      KeepValue(buffer);
+    }
+    return messages;
+  });
+  unsigned char strategy = 0;
+  runner.Run("codec/resolve_request_match", nothing, [&](){
+    for(size_t i = 0; i < messages; ++i){
+      ResolveRequestMatch(buffer + kHeaderLength, length - kHeaderLength, &cli_id, &strategy);
+      KeepValue(cli_id);
+    }
+    return messages;
+  });
+
+  runner.Run("codec/make_info_match", nothing, [&](){
+    for(size_t i = 0; i < messages; ++i){
+      MakeInfoMatch(buffer, &length, static_cast<GameId>(i), 1, 3);
+      KeepValue(buffer);
+    }
+    return messages;
+  });
+  runner.Run("codec/resolve_info_match", nothing, [&](){
+    for(size_t i = 0; i < messages; ++i){
+      ResolveInfoMatch(buffer + kHeaderLength, length - kHeaderLength, &cli_id, &strategy);
+      KeepValue(cli_id);
+    }
+    return messages;
+  });
+
+  runner.Run("codec/make_info_break_off", nothing, [&](){
+    for(size_t i = 0; i < messages; ++i){
+      MakeInfoBreakOff(buffer, &length, static_cast<GameId>(i));
+      KeepValue(buffer);
+    }
+    return messages;
+  });
+}
+
+int main(const int argc, const char** argv){
+  BenchArgs args;
+  if(!ParseArgs(argc, argv, &args)) return 1;
+
+  // the same boards and games every run
+  RandomUnit::Seed(1);
+  std::mt19937 rng(1);
+
+  BenchmarkRunner runner(args.setting, args.filter);
+  if(!runner.HasInstructionCounts()){
+    std::cerr << "instruction counters not available, instructions_per_op is left out" << std::endl;
+  }
+  BenchmarkRunner::PrintHeader();
+  BenchBoards(runner, rng);
+  BenchStrategies(runner);
+  BenchPlacement(runner);
+  BenchCodecs(runner);
+
+  if(!args.json.empty() && !runner.WriteJson(args.json)){
+    std::cerr << "error: can't write " << args.json << std::endl;
+    return 1;
+  }
+  return 0;
+}
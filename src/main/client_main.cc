@@ -6,16 +6,13 @@
 // and we main thread will never get the game result.
 //#define CLEAN_EXIT
 
-// if DEBUG is defined, turn on the code:
-// 1. verify the probability update algorithm
-//#define AI_DEBUG
-
 #include <thread>
 #include "tclap/CmdLine.h"
 #include "client/game_client.h"
 #include "graphic/game_ui.h"
 
-void ParseArgs(const int argc, const char** argv, ClientType* type, std::string* peer_ip, size_t* port, unsigned* client_id, unsigned* game_id){
+bool ParseArgs(const int argc, const char** argv, ClientType* type, std::string* peer_ip, size_t* port, unsigned* client_id, unsigned* game_id,
+               PacingSetting* pacing){
   try{
     TCLAP::CmdLine cmd("battleship game client", ' ', "1.0");
 
@@ -24,12 +21,16 @@ void ParseArgs(const int argc, const char** argv, ClientType* type, std::string*
     TCLAP::ValueArg<std::size_t> portArg("p", "port", "peer port", true, 0, "size_t");
     TCLAP::ValueArg<unsigned> idArg("i", "id", "client id", true, 0, "unsigned");
     TCLAP::ValueArg<unsigned> gameArg("g", "game", "game id", true, 0, "unsigned");
+    TCLAP::ValueArg<std::string> paceArg("", "pace", "move pacing: unpaced, fixed or vsync", false, "fixed", "string");
+    TCLAP::ValueArg<std::size_t> delayArg("", "delay", "delay before every move with fixed pacing, in ms", false, 100, "size_t");
 
     cmd.add(typeArg);
     cmd.add(ipArg);
     cmd.add(portArg);
     cmd.add(idArg);
     cmd.add(gameArg);
+    cmd.add(paceArg);
+    cmd.add(delayArg);
 
     // Parse the argv array.
     cmd.parse(argc, argv);
@@ -40,11 +41,18 @@ void ParseArgs(const int argc, const char** argv, ClientType* type, std::string*
     *port = portArg.getValue();
     *client_id = idArg.getValue();
     *game_id = gameArg.getValue();
+    if(!PacingModeFromString(paceArg.getValue(), &pacing->mode)){
+      std::cerr << "error: unknown pacing " << paceArg.getValue() << std::endl;
+      return false;
+    }
+    pacing->delay_ms = delayArg.getValue();
 
   } catch (TCLAP::ArgException &e){
     std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+    return false;
   }
 
+  return true;
 }
 
 void RunClient(GameClient& cli){
@@ -58,12 +66,17 @@ int main(const int argc, const char** argv){
   size_t port;
   unsigned client_id;
   unsigned game_id;
+  PacingSetting pacing;
 
-  ParseArgs(argc, argv, &type, &peer_ip, &port, &client_id, &game_id);
+  if(!ParseArgs(argc, argv, &type, &peer_ip, &port, &client_id, &game_id, &pacing)) return 1;
 
-  GameClient client(type, peer_ip, port, client_id, game_id, pthread_self());
+  GameClient client(type, peer_ip, port, client_id, game_id, pacing, pthread_self());
 
-  GameUi ui(client.GetRefMyBoard(), client.GetRefEnemyBoard(), client.GetRefProbabilityBoard());
+  GameUi ui(client.GetRefSnapshots());
+  Pacer & pacer = client.GetRefPacer();
+  ui.SetFrameListener([&pacer](){
+    pacer.OnFrame();
+  });
 
   std::thread cli_thread(RunClient, std::ref(client));
 
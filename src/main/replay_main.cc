@@ -0,0 +1,177 @@
+//
+// Replay of a recorded game: the boards at any move, where the brains stop matching the record, and play outs with other strategies.
+//
+
+// the probability of every cell is logged at trace level on every move, the boards are printed instead
+#define BATTLESHIP_LOG_LEVEL 2
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "tclap/CmdLine.h"
+#include "simulation/game_record_analysis.h"
+#include "simulation/game_replay.h"
+#include "utils/mapped_file.h"
+
+struct ReplayArgs{
+  std::string file;
+  GameId game_id = 0;
+  // the position to show, the end of the game if not set
+  bool move_set = false;
+  size_t move = 0;
+  size_t playouts = 0;
+  bool attack_a_set = false;
+  bool attack_b_set = false;
+  StrategyAttack attack_a = StrategyAttack::kDFSProbability;
+  StrategyAttack attack_b = StrategyAttack::kDFSProbability;
+  std::uint64_t seed = 0;
+};
+
+bool ParseArgs(const int argc, const char** argv, ReplayArgs* args){
+  try{
+    TCLAP::CmdLine cmd("battleship game replay", ' ', "1.0");
+
+    TCLAP::ValueArg<unsigned> gameArg("g", "game", "game id of the game to replay", true, 0, "unsigned");
+    TCLAP::ValueArg<std::size_t> moveArg("m", "move", "show the boards after this many moves, the end of the game if not given", false, 0, "size_t");
+    TCLAP::ValueArg<std::size_t> playoutsArg("p", "playouts", "play the game out from the move this many times", false, 0, "size_t");
+    TCLAP::ValueArg<std::string> attackAArg("", "attack-a", "attack strategy of player a in the play outs, the recorded one if not given", false, "dfs_probability", "string");
+    TCLAP::ValueArg<std::string> attackBArg("", "attack-b", "attack strategy of player b in the play outs, the recorded one if not given", false, "dfs_probability", "string");
+    TCLAP::ValueArg<std::uint64_t> seedArg("s", "seed", "seed of the play outs", false, 0, "uint64");
+    TCLAP::UnlabeledValueArg<std::string> fileArg("file", "record file written by the simulator", true, "", "file");
+
+    cmd.add(gameArg);
+    cmd.add(moveArg);
+    cmd.add(playoutsArg);
+    cmd.add(attackAArg);
+    cmd.add(attackBArg);
+    cmd.add(seedArg);
+    cmd.add(fileArg);
+
+    // Parse the argv array.
+    cmd.parse(argc, argv);
+
+    // Get the value parsed by each arg.
+    args->file = fileArg.getValue();
+    args->game_id = gameArg.getValue();
+    args->move_set = moveArg.isSet();
+    args->move = moveArg.getValue();
+    args->playouts = playoutsArg.getValue();
+    args->attack_a_set = attackAArg.isSet();
+    args->attack_b_set = attackBArg.isSet();
+    args->seed = seedArg.getValue();
+    if(!StrategyAttackFromString(attackAArg.getValue(), &args->attack_a)
+       || !StrategyAttackFromString(attackBArg.getValue(), &args->attack_b)){
+      std::cerr << "error: unknown strategy" << std::endl;
+      return false;
+    }
+
+  } catch (TCLAP::ArgException &e){
+    std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+// Every player's board as the other attacks it, '.' water, 'o' ship, 'x' hit and '-' miss, and beside
+// it what the attacker's probability board makes of the locations not attacked yet, 0 - 9.
+template<typename Rules>
+static void PrintBoards(BasicGameReplay<Rules> & replay){
+  const char* names[] = {"a", "b"};
+  for(size_t i = 0; i < 2; ++i){
+    typename BasicGameReplay<Rules>::HeadlessPlayer & player = replay.GetPlayer(i);
+    const BasicProbabilityBoard<Rules> & probability = replay.GetPlayer(1 - i).brain.GetRefProbBoard();
+    std::printf("\nboard of player %s\n", names[i]);
+    for(size_t row = 0; row < Rules::kDim; ++row){
+      std::string line;
+      for(size_t column = 0; column < Rules::kDim; ++column){
+        const char cells[] = {'.', 'o', '-', 'x'};
+        line += cells[player.board.GetState(row * Rules::kDim + column)];
+      }
+      line += "   ";
+      for(size_t column = 0; column < Rules::kDim; ++column){
+        size_t location = row * Rules::kDim + column;
+        float scale = probability.GetProbabilityScale(location);
+        if(player.board.GetState(location) & 2 || !std::isfinite(scale)) line += ' ';
+        else line += static_cast<char>('0' + static_cast<int>(scale * 9.0f + 0.5f));
+      }
+      std::printf("%s\n", line.c_str());
+    }
+  }
+}
+
+template<typename Rules>
+int Replay(const ReplayArgs & args, const MappedFile & file){
+  BasicGameRecord<Rules> record;
+  if(!FindGameRecord<Rules>(file.GetData(), file.GetLength(), args.game_id, &record)){
+    std::cerr << "error: no game " << args.game_id << " in " << args.file << std::endl;
+    return 1;
+  }
+  BasicGameRecordStats<Rules> stats;
+  if(!stats.AddGame(record)){
+    std::cerr << "error: the record of game " << args.game_id << " is broken" << std::endl;
+    return 1;
+  }
+  if(args.move > record.moves.size()){
+    std::cerr << "error: game " << args.game_id << " has " << record.moves.size() << " moves" << std::endl;
+    return 1;
+  }
+
+  const char* names[] = {"a", "b"};
+  std::printf("game %u, player a (client %u) %s against player b (client %u) %s, player %s fires first, player %s wins after %zu moves of both\n",
+              static_cast<unsigned>(record.game_id),
+              static_cast<unsigned>(record.players[0].cli_id), StrategyAttackToString(record.players[0].attack).c_str(),
+              static_cast<unsigned>(record.players[1].cli_id), StrategyAttackToString(record.players[1].attack).c_str(),
+              names[record.first], names[record.winner], record.moves.size());
+
+  BasicGameReplay<Rules> replay(record);
+  replay.Seek(args.move_set ? args.move : record.moves.size());
+  // the brains are checked up to the position
+  if(!record.seeded){
+    std::printf("not seeded, the brains can't be checked against the record\n");
+  }else if(replay.GetDivergence() == BasicGameReplay<Rules>::kNoDivergence){
+    std::printf("the brains fire every recorded move up to move %zu\n", replay.GetPosition());
+  }else if(replay.FleetsDiverged()){
+    std::printf("the brains plan other fleets than recorded\n");
+  }else{
+    std::printf("player %s would not fire move %zu as recorded\n", names[record.Mover(replay.GetDivergence())], replay.GetDivergence() + 1);
+  }
+  std::printf("after move %zu of %zu\n", replay.GetPosition(), record.moves.size());
+  PrintBoards(replay);
+
+  if(args.playouts == 0) return 0;
+  StrategyAttack attack_a = args.attack_a_set ? args.attack_a : record.players[0].attack;
+  StrategyAttack attack_b = args.attack_b_set ? args.attack_b : record.players[1].attack;
+  size_t wins[2] = {0, 0};
+  size_t moves[2] = {0, 0};
+  for(size_t i = 0; i < args.playouts; ++i){
+    MatchResult res = replay.PlayOut(attack_a, attack_b, RandomUnit::DeriveSeed(args.seed, i));
+    size_t winner = res.does_win[0] ? 0 : 1;
+    wins[winner] += 1;
+    moves[winner] += res.num_moves[winner];
+  }
+  std::printf("\n%zu play outs, player a %s against player b %s\n", args.playouts,
+              StrategyAttackToString(attack_a).c_str(), StrategyAttackToString(attack_b).c_str());
+  for(size_t i = 0; i < 2; ++i){
+    std::printf("player %s wins %zu, in %.2f moves on average\n", names[i], wins[i],
+                wins[i] == 0 ? 0.0 : static_cast<double>(moves[i]) / wins[i]);
+  }
+  return 0;
+}
+
+int main(const int argc, const char** argv){
+  ReplayArgs args;
+  if(!ParseArgs(argc, argv, &args)) return 1;
+
+  MappedFile file;
+  if(!file.Open(args.file)){
+    std::cerr << "error: can't open " << args.file << std::endl;
+    return 1;
+  }
+  if(CheckGameRecordFileHeader<ClassicRules>(file.GetData(), file.GetLength())) return Replay<ClassicRules>(args, file);
+  if(CheckGameRecordFileHeader<LargeRules>(file.GetData(), file.GetLength())) return Replay<LargeRules>(args, file);
+  if(CheckGameRecordFileHeader<HugeRules>(file.GetData(), file.GetLength())) return Replay<HugeRules>(args, file);
+  std::cerr << "error: " << args.file << " is not a record file" << std::endl;
+  return 1;
+}
@@ -0,0 +1,74 @@
+//
+// Matchmaking server, clients connect with --type matched and get paired or played here.
+//
+
+// the probability of every cell is logged at trace level on every move, millions of games can't afford it,
+// -DBATTLESHIP_LOG_LEVEL=0 brings it back
+#ifndef BATTLESHIP_LOG_LEVEL
+#define BATTLESHIP_LOG_LEVEL 2
+#endif
+
+#include <chrono>
+#include <string>
+#include "tclap/CmdLine.h"
+#include "client/async_game_host.h"
+#include "server/match_server.h"
+
+struct ServerArgs{
+  ServerSetting server;
+  size_t threads = 2;
+};
+
+bool ParseArgs(const int argc, const char** argv, ServerArgs* args){
+  try{
+    TCLAP::CmdLine cmd("battleship game matchmaking server", ' ', "1.0");
+
+    TCLAP::ValueArg<std::size_t> portArg("p", "port", "port to listen on", true, 0, "size_t");
+    TCLAP::ValueArg<std::string> modeArg("m", "mode", "relay: pair clients with each other, play: play every client here", false, "relay", "string");
+    TCLAP::ValueArg<std::size_t> gamesArg("n", "games", "stop taking connections once this many games are over, 0 runs for good", false, 0, "size_t");
+    TCLAP::ValueArg<std::size_t> batchArg("b", "batch", "messages coalesced into one write at most, 1 writes them one by one", false, AsyncConnection::kDefaultMaxBatch, "size_t");
+    TCLAP::ValueArg<std::size_t> threadsArg("j", "threads", "threads serving the connections", false, 2, "size_t");
+
+    cmd.add(portArg);
+    cmd.add(modeArg);
+    cmd.add(gamesArg);
+    cmd.add(batchArg);
+    cmd.add(threadsArg);
+
+    // Parse the argv array.
+    cmd.parse(argc, argv);
+
+    // Get the value parsed by each arg.
+    args->server.port = portArg.getValue();
+    args->server.max_games = gamesArg.getValue();
+    args->server.batch = batchArg.getValue();
+    args->threads = threadsArg.getValue() > 0 ? threadsArg.getValue() : 1;
+    if(!ServerModeFromString(modeArg.getValue(), &args->server.mode)){
+      std::cerr << "error: unknown mode" << std::endl;
+      return false;
+    }
+
+  } catch (TCLAP::ArgException &e){
+    std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(const int argc, const char** argv){
+  ServerArgs args;
+  if(!ParseArgs(argc, argv, &args)) return 1;
+
+  asio::io_service io_service;
+  MatchServer server(io_service, args.server);
+  auto start = std::chrono::steady_clock::now();
+  server.Start();
+  AsyncGameHost::Run(io_service, args.threads);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  ServerResult res = server.GetResult();
+  std::cerr << res.matched << " games matched, " << res.finished << " finished, " << res.broken_off << " broken off, "
+            << seconds << "s on " << args.threads << " threads" << std::endl;
+  return res.broken_off == 0 ? 0 : 1;
+}
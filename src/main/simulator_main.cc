@@ -0,0 +1,184 @@
+//
+// Headless simulator, plays AI-vs-AI games in one process without sockets or ui.
+//
+
+// the probability of every cell is logged at trace level on every move, millions of games can't afford it,
+// -DBATTLESHIP_LOG_LEVEL=0 brings it back
+#ifndef BATTLESHIP_LOG_LEVEL
+#define BATTLESHIP_LOG_LEVEL 2
+#endif
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "tclap/CmdLine.h"
+#include "simulation/headless_match.h"
+#include "simulation/tournament.h"
+
+// the rules a run plays
+enum class SimulatorRules{
+  kClassic,
+  kLarge,
+  kHuge
+};
+
+// return false if the name does not match any rules
+static bool SimulatorRulesFromString(const std::string & name, SimulatorRules* rules){
+  if(name == "classic") *rules = SimulatorRules::kClassic;
+  else if(name == "large") *rules = SimulatorRules::kLarge;
+  else if(name == "huge") *rules = SimulatorRules::kHuge;
+  else return false;
+  return true;
+}
+
+struct SimulatorArgs{
+  SimulatorRules rules = SimulatorRules::kClassic;
+  size_t games = 1;
+  GameId first_game_id = 0;
+  StrategyAttack attack_a = StrategyAttack::kDFSProbability;
+  StrategyAttack attack_b = StrategyAttack::kDFSProbability;
+  StrategyPlaceShip place_a = StrategyPlaceShip::kRandom;
+  StrategyPlaceShip place_b = StrategyPlaceShip::kRandom;
+  bool tournament = false;
+  size_t threads = 0;
+  bool seeded = false;
+  std::uint64_t seed = 0;
+  std::string record_prefix;
+  std::uint64_t record_file_mb = 1024;
+};
+
+bool ParseArgs(const int argc, const char** argv, SimulatorArgs* args){
+  try{
+    TCLAP::CmdLine cmd("battleship game headless simulator", ' ', "1.0");
+
+    TCLAP::ValueArg<std::string> rulesArg("r", "rules", "classic (10x10), large (15x15) or huge (20x20)", false, "classic", "string");
+    TCLAP::ValueArg<std::size_t> gamesArg("n", "games", "number of games to play, per strategy pair in a tournament", false, 1, "size_t");
+    TCLAP::ValueArg<unsigned> gameArg("g", "game", "game id of the first game", false, 0, "unsigned");
+    TCLAP::ValueArg<std::string> attackAArg("", "attack-a", "attack strategy of player a: random, dfs, probability, dfs_probability or monte_carlo", false, "dfs_probability", "string");
+    TCLAP::ValueArg<std::string> attackBArg("", "attack-b", "attack strategy of player b: random, dfs, probability, dfs_probability or monte_carlo", false, "dfs_probability", "string");
+    TCLAP::ValueArg<std::string> placeAArg("", "place-a", "ship placement strategy of player a: fixed or random", false, "random", "string");
+    TCLAP::ValueArg<std::string> placeBArg("", "place-b", "ship placement strategy of player b: fixed or random", false, "random", "string");
+    TCLAP::SwitchArg tournamentArg("", "tournament", "play every attack strategy against every placement strategy, player b attacks back with attack-b and player a places with place-a", false);
+    TCLAP::ValueArg<std::size_t> threadsArg("j", "threads", "tournament worker threads, 0 for one per core", false, 0, "size_t");
+    TCLAP::ValueArg<std::uint64_t> seedArg("s", "seed", "seed of the random generators, the same seed replays the same games; random if not given", false, 0, "uint64");
+    TCLAP::ValueArg<std::string> recordArg("", "record", "record every game into files prefix.000000.bsgr, prefix.000001.bsgr, ...", false, "", "prefix");
+    TCLAP::ValueArg<std::uint64_t> recordMbArg("", "record-mb", "start a new record file once one has this many megabytes", false, 1024, "uint64");
+
+    cmd.add(rulesArg);
+    cmd.add(gamesArg);
+    cmd.add(gameArg);
+    cmd.add(attackAArg);
+    cmd.add(attackBArg);
+    cmd.add(placeAArg);
+    cmd.add(placeBArg);
+    cmd.add(tournamentArg);
+    cmd.add(threadsArg);
+    cmd.add(seedArg);
+    cmd.add(recordArg);
+    cmd.add(recordMbArg);
+
+    // Parse the argv array.
+    cmd.parse(argc, argv);
+
+    // Get the value parsed by each arg.
+    args->games = gamesArg.getValue();
+    args->first_game_id = gameArg.getValue();
+    args->tournament = tournamentArg.getValue();
+    args->threads = threadsArg.getValue();
+    args->seeded = seedArg.isSet();
+    args->seed = seedArg.getValue();
+    args->record_prefix = recordArg.getValue();
+    args->record_file_mb = recordMbArg.getValue();
+    if(!SimulatorRulesFromString(rulesArg.getValue(), &args->rules)){
+      std::cerr << "error: unknown rules" << std::endl;
+      return false;
+    }
+    if(!StrategyAttackFromString(attackAArg.getValue(), &args->attack_a)
+       || !StrategyAttackFromString(attackBArg.getValue(), &args->attack_b)
+       || !StrategyPlaceShipFromString(placeAArg.getValue(), &args->place_a)
+       || !StrategyPlaceShipFromString(placeBArg.getValue(), &args->place_b)){
+      std::cerr << "error: unknown strategy" << std::endl;
+      return false;
+    }
+
+  } catch (TCLAP::ArgException &e){
+    std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+template<typename Rules>
+int Simulate(const SimulatorArgs & args){
+  if(args.tournament){
+    TournamentSetting setting;
+    setting.games_per_pair = args.games;
+    setting.num_threads = args.threads;
+    setting.defender_attack = args.attack_b;
+    setting.challenger_place = args.place_a;
+    setting.seeded = args.seeded;
+    setting.seed = args.seed;
+    setting.record_prefix = args.record_prefix;
+    setting.record_file_bytes = args.record_file_mb << 20;
+    BasicTournament<Rules> tournament(setting);
+    BasicTournament<Rules>::PrintResults(tournament.Run());
+    if(tournament.IsRecordFailed()){
+      std::cerr << "error: can't write the records to " << args.record_prefix << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  // player a always gets the higher client id, so it fires first
+  PlayerSetting player_a(1, args.attack_a, args.place_a);
+  PlayerSetting player_b(0, args.attack_b, args.place_b);
+
+  std::unique_ptr<BasicGameRecordWriter<Rules>> writer;
+  std::unique_ptr<BasicGameRecordBlock<Rules>> block;
+  BasicGameRecord<Rules> record;
+  if(!args.record_prefix.empty()){
+    writer.reset(new BasicGameRecordWriter<Rules>(args.record_prefix, args.record_file_mb << 20));
+    block.reset(new BasicGameRecordBlock<Rules>());
+  }
+
+  for(size_t i = 0; i < args.games; ++i){
+    GameId game_id = static_cast<GameId>(args.first_game_id + i);
+    BasicHeadlessMatch<Rules> match(player_a, player_b, game_id);
+    if(args.seeded) match.SetSeed(RandomUnit::DeriveSeed(args.seed, game_id));
+    if(writer) match.SetRecord(&record);
+    match.Play().Log();
+    if(writer) writer->Add(*block, record);
+  }
+
+  if(writer){
+    writer->Write(*block);
+    writer->Close();
+    if(writer->IsFailed()){
+      std::cerr << "error: can't write the records to " << args.record_prefix << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int main(const int argc, const char** argv){
+  SimulatorArgs args;
+  if(!ParseArgs(argc, argv, &args)) return 1;
+
+  switch(args.rules){
+    case SimulatorRules::kClassic:{
+      return Simulate<ClassicRules>(args);
+    }
+    case SimulatorRules::kLarge:{
+      return Simulate<LargeRules>(args);
+    }
+    case SimulatorRules::kHuge:{
+      return Simulate<HugeRules>(args);
+    }
+    default:{
+      assert(false);
+      return 1;
+    }
+  }
+}
@@ -0,0 +1,251 @@
+//
+// Server pairing the clients that ask it for games, and relaying or playing them.
+//
+
+#ifndef BATTLESHIP_SERVER_MATCH_SERVER_H
+#define BATTLESHIP_SERVER_MATCH_SERVER_H
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "client/async_connection.h"
+#include "client/async_game_client.h"
+
+enum class ServerMode{
+  // pairs two clients asking for the same strategy and passes their messages on
+  kRelay,
+  // plays every client itself, with the strategy the client asked for
+  kPlay
+};
+
+static bool ServerModeFromString(const std::string & name, ServerMode* mode){
+  if(name == "relay") *mode = ServerMode::kRelay;
+  else if(name == "play") *mode = ServerMode::kPlay;
+  else return false;
+  return true;
+}
+
+struct ServerSetting{
+  size_t port = 0;
+  ServerMode mode = ServerMode::kRelay;
+  // the server stops taking connections once this many games are over, 0 keeps it going
+  size_t max_games = 0;
+  size_t batch = AsyncConnection::kDefaultMaxBatch;
+};
+
+struct ServerResult{
+  size_t matched = 0;
+  size_t finished = 0;
+  size_t broken_off = 0;
+};
+
+// Every connection is served on its own strand and keeps its own table of the games on it,
+// the sessions it plays and the games it relays, so no lock is shared by all of them. Only
+// matching takes a lock, the one of the pool of the strategy asked for.
+// The game ids the server makes are unique over all connections and never kLobbyGameId.
+// On linux asio waits on the sockets with epoll, the threads running the io_service share it.
+class MatchServer{
+public:
+  // the client asking second fires first, its client id is the higher
+  static const ClientId kFirstClientId = 0;
+  static const ClientId kSecondClientId = 1;
+
+  MatchServer(asio::io_service & io_service, const ServerSetting & setting):
+    io_service_(io_service),
+    setting_(setting),
+    acceptor_(io_service),
+    accept_strand_(io_service){
+  }
+
+  // accepting once this returns
+  void Start(){
+    tcp::endpoint endpoint(tcp::v4(), setting_.port);
+    acceptor_.open(endpoint.protocol());
+    acceptor_.set_option(tcp::acceptor::reuse_address(true));
+    acceptor_.bind(endpoint);
+    acceptor_.listen();
+    accept_strand_.dispatch([this](){
+      AcceptNext();
+    });
+  }
+
+  size_t GetPort() const{
+    return acceptor_.local_endpoint().port();
+  }
+
+  ServerResult GetResult() const{
+    std::lock_guard<std::mutex> lock(result_mutex_);
+    return result_;
+  }
+
+private:
+  static const size_t kPoolNum = static_cast<size_t>(StrategyAttack::kMonteCarlo) + 1;
+  static const size_t kReportEvery = 1000;
+
+  // a connection for every game asked for and not matched yet, of one strategy
+  struct Pool{
+    std::mutex mutex;
+    std::deque<std::shared_ptr<AsyncConnection>> waiting;
+  };
+
+  asio::io_service & io_service_;
+  ServerSetting setting_;
+  tcp::acceptor acceptor_;
+  // the acceptor is only touched on it
+  asio::io_service::strand accept_strand_;
+  bool stopped_ = false;
+
+  Pool pools_[kPoolNum];
+  std::atomic<GameId> next_game_id_{0};
+
+  mutable std::mutex result_mutex_;
+  ServerResult result_;
+
+  void AcceptNext(){
+    if(stopped_) return;
+    std::shared_ptr<AsyncConnection> connection = std::make_shared<AsyncConnection>(io_service_, setting_.batch);
+    acceptor_.async_accept(connection->GetRefSocket(), accept_strand_.wrap([this, connection](const asio::error_code & ec){
+      if(ec){
+        if(!stopped_) Logger("can't accept a connection: " + ec.message());
+        return;
+      }
+      connection->Start([this](const std::shared_ptr<AsyncConnection> & connection, const FrameView & frame){
+        OnFrame(connection, frame);
+      });
+      AcceptNext();
+    }));
+  }
+
+  // on the strand of the connection, for a request or a message of a game the connection doesn't know
+  void OnFrame(const std::shared_ptr<AsyncConnection> & connection, const FrameView & frame){
+    if(frame.type != MessageType::kRequestMatch){
+      Logger("message of unknown game " + std::to_string(frame.game_id) + " dropped");
+      return;
+    }
+    // the server gives the client id to play under, the one asked with is not needed
+    ClientId cli_id = 0;
+    unsigned char strategy = 0;
+    if(!ResolveRequestMatch(frame.GetBody(), frame.GetBodyLength(), &cli_id, &strategy)){
+      Logger("malformed request dropped");
+      return;
+    }
+    if(strategy >= kPoolNum){
+      Logger("request for unknown strategy " + std::to_string(strategy) + " dropped");
+      return;
+    }
+    switch(setting_.mode){
+      case ServerMode::kRelay:{
+        Match(connection, strategy);
+        break;
+      }
+      case ServerMode::kPlay:{
+        Play(connection, strategy);
+        break;
+      }
+      default:{
+        assert(false);
+      }
+    }
+  }
+
+  // pair the client with one waiting on another connection, or have it wait
+  void Match(const std::shared_ptr<AsyncConnection> & connection, unsigned char strategy){
+    Pool & pool = pools_[strategy];
+    std::shared_ptr<AsyncConnection> peer;
+    {
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      auto it = pool.waiting.begin();
+      while(it != pool.waiting.end()){
+        if((*it)->HasFailed()){
+          it = pool.waiting.erase(it);
+          continue;
+        }
+        if(*it != connection) break;
+        ++it;
+      }
+      if(it == pool.waiting.end()){
+        pool.waiting.push_back(connection);
+        return;
+      }
+      peer = *it;
+      pool.waiting.erase(it);
+    }
+
+    GameId game_id = NextGameId();
+    RecordMatched();
+    // both ends report a game broken off by a failed connection, it is over once
+    std::shared_ptr<std::atomic<bool>> over = std::make_shared<std::atomic<bool>>(false);
+    auto on_over = [this, over](GameId, bool finished){
+      if(!over->exchange(true)) RecordOver(finished);
+    };
+    // each side relays before its client hears of the game, so nothing of the game arrives unrelayed
+    peer->Relay(game_id, connection, on_over);
+    SendInfoMatch(peer, game_id, kFirstClientId, strategy);
+    connection->Relay(game_id, peer, on_over);
+    SendInfoMatch(connection, game_id, kSecondClientId, strategy);
+  }
+
+  // play the client right away on its own connection
+  void Play(const std::shared_ptr<AsyncConnection> & connection, unsigned char strategy){
+    GameId game_id = NextGameId();
+    RecordMatched();
+    // make_shared takes it by reference, a copy needs no definition of the constant
+    ClientId cli_id = kFirstClientId;
+    auto game = std::make_shared<AsyncGameClient>(connection, cli_id, game_id, static_cast<StrategyAttack>(strategy),
+                                                  [this](const AsyncGameResult & res){
+      RecordOver(res.finished);
+    });
+    // the client hears of the game before the first message of it
+    SendInfoMatch(connection, game_id, kSecondClientId, strategy);
+    game->Start();
+  }
+
+  void SendInfoMatch(const std::shared_ptr<AsyncConnection> & connection, GameId game_id, ClientId cli_id, unsigned char strategy){
+    Frame reply;
+    MakeInfoMatch(reply.data, &reply.length, game_id, cli_id, strategy);
+    connection->AsyncSend(reply, [](const asio::error_code &){});
+  }
+
+  GameId NextGameId(){
+    GameId game_id = next_game_id_++;
+    assert(game_id != kLobbyGameId);
+    return game_id;
+  }
+
+  void RecordMatched(){
+    std::lock_guard<std::mutex> lock(result_mutex_);
+    result_.matched += 1;
+  }
+
+  void RecordOver(bool finished){
+    size_t over = 0;
+    {
+      std::lock_guard<std::mutex> lock(result_mutex_);
+      if(finished){
+        result_.finished += 1;
+      }else{
+        result_.broken_off += 1;
+      }
+      over = result_.finished + result_.broken_off;
+    }
+    if(over % kReportEvery == 0) Logger(std::to_string(over) + " games over");
+    if(setting_.max_games > 0 && over == setting_.max_games) Stop();
+  }
+
+  // take no more connections, the ones open end as their clients leave
+  void Stop(){
+    accept_strand_.dispatch([this](){
+      stopped_ = true;
+      asio::error_code ignored;
+      acceptor_.close(ignored);
+    });
+    for(Pool & pool : pools_){
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      pool.waiting.clear();
+    }
+  }
+};
+
+#endif //BATTLESHIP_SERVER_MATCH_SERVER_H
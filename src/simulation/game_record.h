@@ -0,0 +1,351 @@
+//
+// Compact binary records of whole games: both fleets, every move and how long the game took.
+//
+
+#ifndef BATTLESHIP_GAME_GAME_RECORD_H
+#define BATTLESHIP_GAME_GAME_RECORD_H
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "ai/attack_location_unit.h"
+#include "ai/ship_placement_unit.h"
+#include "client/client_common.h"
+#include "core/game/game_common.h"
+#include "core/networking/serialization.h"
+#include "utils/fixed_vector.h"
+
+// A file is a header and blocks, a block is a header and the records of whole games, so a block
+// can be read without the ones before it:
+//
+// `"BSGR" | VERSION (1 Byte) | DIM (1 Byte) | SHIP_NUM (1 Byte) | 0 (1 Byte)`
+//
+// `BLOCK_LENGTH (4 Byte) | GAME_NUM (4 Byte) | GAME_NUM x RECORD`
+//
+// `RECORD_LENGTH (varint) | GAME_ID_DELTA (varint) | FLAGS (1 Byte) | [SEED (8 Byte)] | DURATION_NS (varint) |
+//  2 x PLAYER | MOVE_NUM (varint) | MOVE_NUM x LOCATION (varint)`
+//
+// `CLIENT_ID (varint) | ATTACK_STRATEGY << 4 | PLACE_STRATEGY (1 Byte) | SHIP_NUM x (varint)((LOCATION * 2 + DIRECTION) * 4 + TYPE)`
+//
+// A file the writer closed ends with an index, a block of no games holding where every block before it
+// starts and then where the index itself starts, so a reader can split the file without reading it first:
+//
+// `BLOCK_LENGTH (4 Byte) | 0 (4 Byte) | BLOCK_NUM x BLOCK_OFFSET (8 Byte) | INDEX_OFFSET (8 Byte)`
+//
+// Fixed size numbers are little endian. The game id is the difference to the game before in the block, zigzag
+// encoded, the first game of a block takes it from 0. A move is only its location, a byte up to 128 cells:
+// the players take turns from the one FLAGS names, and what a move hit follows from the fleet it was fired at.
+static const unsigned char kGameRecordMagic[4] = {'B', 'S', 'G', 'R'};
+static const unsigned char kGameRecordVersion = 1;
+static const std::size_t kGameRecordFileHeaderLength = 8;
+static const std::size_t kGameRecordBlockHeaderLength = 8;
+
+// the bits of FLAGS
+static const unsigned char kGameRecordSecondWins = 1 << 0;
+static const unsigned char kGameRecordSecondFiresFirst = 1 << 1;
+static const unsigned char kGameRecordSeeded = 1 << 2;
+
+template<typename Rules>
+struct BasicGameRecord{
+  typedef FixedVector<ShipPlacementInfo, Rules::kShipNum> Fleet;
+
+  struct Player{
+    ClientId cli_id = 0;
+    StrategyAttack attack = StrategyAttack::kRandom;
+    StrategyPlaceShip place = StrategyPlaceShip::kRandom;
+    Fleet fleet;
+  };
+
+  GameId game_id = 0;
+  bool seeded = false;
+  std::uint64_t seed = 0;
+  std::uint64_t duration_ns = 0;
+  Player players[2];
+  // index of the player making the first move and of the winner
+  std::size_t first = 0;
+  std::size_t winner = 0;
+  // locations, the first player's move first, the winner's move last
+  FixedVector<std::uint16_t, 2 * Rules::kCellNum> moves;
+
+  // index of the player making the move
+  std::size_t Mover(std::size_t move) const{
+    return (first + move) % 2;
+  }
+
+  void Clear(){
+    players[0].fleet.clear();
+    players[1].fleet.clear();
+    moves.clear();
+  }
+};
+
+namespace game_record{
+  using serialization::FixedField;
+  using serialization::VarintField;
+
+  static std::uint64_t ZigZag(std::int64_t value){
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+  }
+
+  static std::int64_t UnZigZag(std::uint64_t value){
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+  }
+
+  template<typename Rules>
+  struct Codec{
+    typedef BasicGameRecord<Rules> GameRecord;
+
+    // the longest record, its length in front included
+    static const std::size_t kMaxPlayerLength = VarintField::kMaxLength + 1 + Rules::kShipNum * 3;
+    static const std::size_t kMaxBodyLength = 2 * VarintField::kMaxLength + 1 + 8 + VarintField::kMaxLength
+                                              + 2 * kMaxPlayerLength + 3 + 2 * Rules::kCellNum * 2;
+    static const std::size_t kMaxRecordLength = 3 + kMaxBodyLength;
+
+    // the body of the record, without its length, returns the length of it
+    static std::size_t EncodeBody(const GameRecord & record, GameId last_game_id, unsigned char* out){
+      std::size_t offset = 0;
+      VarintField::Write(out, &offset, ZigZag(static_cast<std::int64_t>(record.game_id) - static_cast<std::int64_t>(last_game_id)));
+      unsigned char flags = 0;
+      if(record.winner == 1) flags |= kGameRecordSecondWins;
+      if(record.first == 1) flags |= kGameRecordSecondFiresFirst;
+      if(record.seeded) flags |= kGameRecordSeeded;
+      out[offset++] = flags;
+      if(record.seeded) FixedField<8>::Write(out, &offset, record.seed);
+      VarintField::Write(out, &offset, record.duration_ns);
+      for(const typename GameRecord::Player & player : record.players){
+        VarintField::Write(out, &offset, player.cli_id);
+        out[offset++] = static_cast<unsigned char>(static_cast<unsigned>(player.attack) << 4 | static_cast<unsigned>(player.place));
+        assert(player.fleet.size() == Rules::kShipNum);
+        for(const ShipPlacementInfo & placement : player.fleet){
+          VarintField::Write(out, &offset, (placement.head_location * 2 + placement.direction) * 4 + placement.type);
+        }
+      }
+      VarintField::Write(out, &offset, record.moves.size());
+      for(std::uint16_t location : record.moves){
+        VarintField::Write(out, &offset, location);
+      }
+      assert(offset <= kMaxBodyLength);
+      return offset;
+    }
+
+    // the record at *offset, moving the offset past it. false if the bytes are not a record of these rules
+    static bool Decode(const unsigned char* data, std::size_t length, std::size_t* offset, GameId last_game_id, GameRecord* record){
+      std::uint64_t record_length = 0;
+      if(!VarintField::Read(data, length, offset, &record_length) || record_length > length - *offset) return false;
+      std::size_t end = *offset + static_cast<std::size_t>(record_length);
+      record->Clear();
+
+      std::uint64_t value = 0;
+      if(!VarintField::Read(data, end, offset, &value)) return false;
+      record->game_id = static_cast<GameId>(static_cast<std::int64_t>(last_game_id) + UnZigZag(value));
+      if(*offset >= end) return false;
+      unsigned char flags = data[(*offset)++];
+      record->winner = (flags & kGameRecordSecondWins) ? 1 : 0;
+      record->first = (flags & kGameRecordSecondFiresFirst) ? 1 : 0;
+      record->seeded = (flags & kGameRecordSeeded) != 0;
+      record->seed = 0;
+      if(record->seeded){
+        if(!FixedField<8>::Read(data, end, offset, &record->seed)) return false;
+      }
+      if(!VarintField::Read(data, end, offset, &record->duration_ns)) return false;
+      for(typename GameRecord::Player & player : record->players){
+        if(!VarintField::Read(data, end, offset, &value) || *offset >= end) return false;
+        player.cli_id = static_cast<ClientId>(value);
+        unsigned char strategies = data[(*offset)++];
+        if((strategies >> 4) >= kStrategyAttackNum
+           || (strategies & 0x0F) > static_cast<unsigned>(StrategyPlaceShip::kRandom)) return false;
+        player.attack = static_cast<StrategyAttack>(strategies >> 4);
+        player.place = static_cast<StrategyPlaceShip>(strategies & 0x0F);
+        for(std::size_t i = 0; i < Rules::kShipNum; ++i){
+          if(!VarintField::Read(data, end, offset, &value)) return false;
+          std::size_t location = static_cast<std::size_t>(value / 8);
+          if(location >= Rules::kCellNum) return false;
+          player.fleet.emplace_back(static_cast<ShipType>(value % 4), location, static_cast<Direction>(value / 4 % 2));
+        }
+      }
+      std::uint64_t move_num = 0;
+      if(!VarintField::Read(data, end, offset, &move_num) || move_num > 2 * Rules::kCellNum) return false;
+      for(std::uint64_t i = 0; i < move_num; ++i){
+        if(!VarintField::Read(data, end, offset, &value) || value >= Rules::kCellNum) return false;
+        record->moves.push_back(static_cast<std::uint16_t>(value));
+      }
+      return *offset == end;
+    }
+  };
+}
+
+template<typename Rules>
+static void WriteGameRecordFileHeader(unsigned char* out){
+  static_assert(Rules::kDim < 256 && Rules::kShipNum < 256, "the file header has a byte for each");
+  std::memcpy(out, kGameRecordMagic, sizeof(kGameRecordMagic));
+  out[4] = kGameRecordVersion;
+  out[5] = static_cast<unsigned char>(Rules::kDim);
+  out[6] = static_cast<unsigned char>(Rules::kShipNum);
+  out[7] = 0;
+}
+
+// false if it is not the header of a file of records of these rules
+template<typename Rules>
+static bool CheckGameRecordFileHeader(const unsigned char* data, std::size_t length){
+  unsigned char header[kGameRecordFileHeaderLength];
+  WriteGameRecordFileHeader<Rules>(header);
+  return length >= kGameRecordFileHeaderLength && std::memcmp(data, header, kGameRecordFileHeaderLength) == 0;
+}
+
+// Games encoded one after another into a block of at most kCapacity bytes. Every thread recording
+// fills a block of its own, so recording a game takes no lock, and hands it to the writer once full.
+template<typename Rules>
+class BasicGameRecordBlock{
+public:
+  typedef BasicGameRecord<Rules> GameRecord;
+  typedef game_record::Codec<Rules> Codec;
+
+  static const std::size_t kCapacity = 1 << 16;
+
+  // false if the block is too full to be sure the record fits, nothing is added then
+  bool Add(const GameRecord & record){
+    if(kCapacity - length_ < Codec::kMaxRecordLength) return false;
+    unsigned char body[Codec::kMaxBodyLength];
+    std::size_t body_length = Codec::EncodeBody(record, last_game_id_, body);
+    serialization::VarintField::Write(records_, &length_, body_length);
+    std::memcpy(records_ + length_, body, body_length);
+    length_ += body_length;
+    last_game_id_ = record.game_id;
+    game_num_ += 1;
+    return true;
+  }
+
+  void Clear(){
+    length_ = 0;
+    game_num_ = 0;
+    last_game_id_ = 0;
+  }
+
+  bool IsEmpty() const{
+    return game_num_ == 0;
+  }
+
+  // the block header of the records
+  void WriteHeader(unsigned char* out) const{
+    std::size_t offset = 0;
+    serialization::FixedField<4>::Write(out, &offset, length_);
+    serialization::FixedField<4>::Write(out, &offset, game_num_);
+  }
+
+  const unsigned char* GetRecords() const{
+    return records_;
+  }
+
+  std::size_t GetLength() const{
+    return length_;
+  }
+
+  std::size_t GetGameNum() const{
+    return game_num_;
+  }
+
+private:
+  unsigned char records_[kCapacity];
+  std::size_t length_ = 0;
+  std::size_t game_num_ = 0;
+  GameId last_game_id_ = 0;
+};
+
+// The records of one block, read in place
+template<typename Rules>
+class BasicGameRecordBlockReader{
+public:
+  typedef BasicGameRecord<Rules> GameRecord;
+
+  // the bytes after the block header
+  BasicGameRecordBlockReader(const unsigned char* records, std::size_t length, std::size_t game_num):
+    records_(records),
+    length_(length),
+    game_num_(game_num){
+  }
+
+  // false once every game was read, or if the block is broken
+  bool Next(GameRecord* record){
+    if(read_ == game_num_) return false;
+    if(!game_record::Codec<Rules>::Decode(records_, length_, &offset_, last_game_id_, record)) return false;
+    last_game_id_ = record->game_id;
+    read_ += 1;
+    return true;
+  }
+
+  // every game was read and nothing is left over
+  bool IsDone() const{
+    return read_ == game_num_ && offset_ == length_;
+  }
+
+private:
+  const unsigned char* records_;
+  std::size_t length_;
+  std::size_t game_num_;
+  std::size_t offset_ = 0;
+  std::size_t read_ = 0;
+  GameId last_game_id_ = 0;
+};
+
+// the header of the block at *offset, moving the offset to its records. false if the file ends before the block does
+static bool ReadGameRecordBlockHeader(const unsigned char* data, std::size_t length, std::size_t* offset,
+                                      std::size_t* block_length, std::size_t* game_num){
+  std::uint64_t value = 0;
+  if(!serialization::FixedField<4>::Read(data, length, offset, &value)) return false;
+  *block_length = static_cast<std::size_t>(value);
+  if(!serialization::FixedField<4>::Read(data, length, offset, &value)) return false;
+  *game_num = static_cast<std::size_t>(value);
+  return *block_length <= length - *offset;
+}
+
+// the block offsets from the index at the end of a whole record file, and where the index starts.
+// false if the file has no index, when the writer didn't finish it
+static bool ReadGameRecordIndex(const unsigned char* data, std::size_t length, std::vector<std::size_t>* block_offsets,
+                                std::size_t* index_offset){
+  std::uint64_t value = 0;
+  std::size_t offset = length - 8;
+  if(length < kGameRecordFileHeaderLength + kGameRecordBlockHeaderLength + 8
+     || !serialization::FixedField<8>::Read(data, length, &offset, &value)
+     || value < kGameRecordFileHeaderLength || value > length - kGameRecordBlockHeaderLength - 8) return false;
+  offset = static_cast<std::size_t>(value);
+  std::size_t index_length = 0;
+  std::size_t game_num = 0;
+  if(!ReadGameRecordBlockHeader(data, length, &offset, &index_length, &game_num)
+     || game_num != 0 || offset + index_length != length || index_length % 8 != 0) return false;
+  *index_offset = static_cast<std::size_t>(value);
+  block_offsets->clear();
+  std::size_t last = 0;
+  for(std::size_t i = 0; i + 1 < index_length / 8; ++i){
+    serialization::FixedField<8>::Read(data, length, &offset, &value);
+    // the blocks go up to the index, one after another
+    if(value < kGameRecordFileHeaderLength || value >= *index_offset || (i > 0 && value <= last)) return false;
+    last = static_cast<std::size_t>(value);
+    block_offsets->push_back(last);
+  }
+  return true;
+}
+
+// the first game of the id in a whole record file, read from the start. false if there is none
+template<typename Rules>
+static bool FindGameRecord(const unsigned char* data, std::size_t length, GameId game_id, BasicGameRecord<Rules>* record){
+  if(!CheckGameRecordFileHeader<Rules>(data, length)) return false;
+  std::size_t offset = kGameRecordFileHeaderLength;
+  while(offset < length){
+    std::size_t block_length = 0;
+    std::size_t game_num = 0;
+    if(!ReadGameRecordBlockHeader(data, length, &offset, &block_length, &game_num)) return false;
+    BasicGameRecordBlockReader<Rules> reader(data + offset, block_length, game_num);
+    while(reader.Next(record)){
+      if(record->game_id == game_id) return true;
+    }
+    offset += block_length;
+  }
+  return false;
+}
+
+typedef BasicGameRecord<ClassicRules> GameRecord;
+typedef BasicGameRecordBlock<ClassicRules> GameRecordBlock;
+typedef BasicGameRecordBlockReader<ClassicRules> GameRecordBlockReader;
+
+#endif //BATTLESHIP_GAME_GAME_RECORD_H
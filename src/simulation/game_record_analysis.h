@@ -0,0 +1,352 @@
+//
+// Statistics over files of game records, read in place from memory mapped files by a pool of threads.
+//
+
+#ifndef BATTLESHIP_GAME_GAME_RECORD_ANALYSIS_H
+#define BATTLESHIP_GAME_GAME_RECORD_ANALYSIS_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/exception/exception.h"
+#include "core/game/board.h"
+#include "simulation/game_record.h"
+#include "utils/mapped_file.h"
+#include "utils/thread_pool.h"
+
+// what the players attacking with one strategy did, plain counters so partial results merge by addition
+template<typename Rules>
+struct BasicStrategyStats{
+  static const std::size_t kCellNum = Rules::kCellNum;
+
+  std::uint64_t players = 0;
+  std::uint64_t wins = 0;
+  // shots at and hits on every location
+  std::uint64_t shots[kCellNum] = {};
+  std::uint64_t hits[kCellNum] = {};
+  // shots and hits of the m-th move of a player, from 0
+  std::uint64_t move_shots[kCellNum] = {};
+  std::uint64_t move_hits[kCellNum] = {};
+  // wins_in[m] is the number of games won in m moves
+  std::uint64_t wins_in[kCellNum + 1] = {};
+  // first_sink[m] is the number of players who sank their first ship with their m-th move, from 1
+  std::uint64_t first_sink[kCellNum + 1] = {};
+
+  void Add(const BasicStrategyStats & other){
+    players += other.players;
+    wins += other.wins;
+    for(std::size_t i = 0; i < kCellNum; ++i){
+      shots[i] += other.shots[i];
+      hits[i] += other.hits[i];
+      move_shots[i] += other.move_shots[i];
+      move_hits[i] += other.move_hits[i];
+    }
+    for(std::size_t i = 0; i <= kCellNum; ++i){
+      wins_in[i] += other.wins_in[i];
+      first_sink[i] += other.first_sink[i];
+    }
+  }
+
+  // the mean of a histogram over 0 - kCellNum
+  static double Mean(const std::uint64_t* histogram){
+    double sum = 0.0;
+    std::uint64_t count = 0;
+    for(std::size_t i = 0; i <= kCellNum; ++i){
+      sum += static_cast<double>(i) * histogram[i];
+      count += histogram[i];
+    }
+    return count == 0 ? 0.0 : sum / count;
+  }
+
+  // smallest m such that at least `percentile` of the histogram is at m or below
+  static std::size_t Percentile(const std::uint64_t* histogram, double percentile){
+    std::uint64_t count = 0;
+    for(std::size_t i = 0; i <= kCellNum; ++i){
+      count += histogram[i];
+    }
+    if(count == 0) return 0;
+    double target = percentile * count;
+    std::uint64_t seen = 0;
+    for(std::size_t i = 0; i <= kCellNum; ++i){
+      seen += histogram[i];
+      if(seen > 0 && seen >= target) return i;
+    }
+    return kCellNum;
+  }
+};
+
+template<typename Rules>
+struct BasicGameRecordStats{
+  typedef BasicGameRecord<Rules> GameRecord;
+  typedef BasicStrategyStats<Rules> StrategyStats;
+  static const std::size_t kCellNum = Rules::kCellNum;
+  static const unsigned char kOccupied = BasicBoard<Rules>::OCCUPIED;
+
+  std::uint64_t games = 0;
+  // records that don't decode or whose moves don't fit their fleets, and blocks cut short or with bytes left over
+  std::uint64_t broken = 0;
+  std::uint64_t duration_ns = 0;
+  // by the attack strategy of the player
+  StrategyStats strategies[kStrategyAttackNum];
+
+  // the moves are fired at the fleets again to know what they hit, false if they don't fit
+  bool AddGame(const GameRecord & record){
+    BasicBoard<Rules> boards[2];
+    for(std::size_t i = 0; i < 2; ++i){
+      for(const ShipPlacementInfo & placement : record.players[i].fleet){
+        if(!boards[i].PlaceAShip(placement.type, placement.head_location, placement.direction)) return false;
+      }
+    }
+
+    std::size_t moves[2] = {0, 0};
+    bool sank[2] = {false, false};
+    // nothing is counted until the whole game checks out, a broken record adds nothing
+    StrategyStats* stats[2] = {&strategies[static_cast<std::size_t>(record.players[0].attack)],
+                               &strategies[static_cast<std::size_t>(record.players[1].attack)]};
+    std::size_t first_sink[2] = {0, 0};
+    bool won = false;
+    for(std::size_t move = 0; move < record.moves.size(); ++move){
+      std::size_t mover = record.Mover(move);
+      std::size_t location = record.moves[move];
+      try{
+        AttackResult res = boards[1 - mover].Attack(location);
+        if(res.sink_ship_type != kNotAShip && !sank[mover]){
+          sank[mover] = true;
+          first_sink[mover] = moves[mover] + 1;
+        }
+        won = res.attacker_win;
+      }catch(const GameException &){
+        return false;
+      }
+      moves[mover] += 1;
+      if(won && move + 1 != record.moves.size()) return false;
+    }
+    if(!won || record.Mover(record.moves.size() - 1) != record.winner) return false;
+
+    // the boards are the end of the game now, a shot hit if the location is occupied
+    for(std::size_t move = 0; move < record.moves.size(); ++move){
+      std::size_t mover = record.Mover(move);
+      std::size_t location = record.moves[move];
+      bool hit = boards[1 - mover].GetState(location) & kOccupied;
+      std::size_t nth = move / 2;
+      stats[mover]->shots[location] += 1;
+      stats[mover]->move_shots[nth] += 1;
+      if(hit){
+        stats[mover]->hits[location] += 1;
+        stats[mover]->move_hits[nth] += 1;
+      }
+    }
+    for(std::size_t i = 0; i < 2; ++i){
+      stats[i]->players += 1;
+      if(first_sink[i] > 0) stats[i]->first_sink[first_sink[i]] += 1;
+    }
+    stats[record.winner]->wins += 1;
+    stats[record.winner]->wins_in[moves[record.winner]] += 1;
+    games += 1;
+    duration_ns += record.duration_ns;
+    return true;
+  }
+
+  void Add(const BasicGameRecordStats & other){
+    games += other.games;
+    broken += other.broken;
+    duration_ns += other.duration_ns;
+    for(std::size_t i = 0; i < kStrategyAttackNum; ++i){
+      strategies[i].Add(other.strategies[i]);
+    }
+  }
+
+  // csv tables one after another, a blank line between them, only the strategies someone played
+  void Print(std::FILE* out) const{
+    std::fprintf(out, "games,broken,mean_game_us\n%llu,%llu,%.2f\n\n",
+                 static_cast<unsigned long long>(games), static_cast<unsigned long long>(broken),
+                 games == 0 ? 0.0 : duration_ns / 1000.0 / games);
+
+    std::fprintf(out, "strategy,players,wins,win_rate,mean_moves_to_win,p50_moves_to_win,p90_moves_to_win,mean_first_sink\n");
+    ForEachPlayed([out](const std::string & name, const StrategyStats & stats){
+      std::fprintf(out, "%s,%llu,%llu,%.4f,%.2f,%zu,%zu,%.2f\n", name.c_str(),
+                   static_cast<unsigned long long>(stats.players), static_cast<unsigned long long>(stats.wins),
+                   static_cast<double>(stats.wins) / stats.players,
+                   StrategyStats::Mean(stats.wins_in), StrategyStats::Percentile(stats.wins_in, 0.5),
+                   StrategyStats::Percentile(stats.wins_in, 0.9), StrategyStats::Mean(stats.first_sink));
+    });
+
+    std::fprintf(out, "\nstrategy,move,shots,hits,hit_rate\n");
+    ForEachPlayed([out](const std::string & name, const StrategyStats & stats){
+      for(std::size_t m = 0; m < kCellNum && stats.move_shots[m] > 0; ++m){
+        std::fprintf(out, "%s,%zu,%llu,%llu,%.4f\n", name.c_str(), m + 1,
+                     static_cast<unsigned long long>(stats.move_shots[m]), static_cast<unsigned long long>(stats.move_hits[m]),
+                     static_cast<double>(stats.move_hits[m]) / stats.move_shots[m]);
+      }
+    });
+
+    PrintHistogram(out, "moves,wins", &StrategyStats::wins_in);
+    PrintHistogram(out, "move,first_sinks", &StrategyStats::first_sink);
+
+    std::fprintf(out, "\nstrategy,location,row,column,shots,hits\n");
+    ForEachPlayed([out](const std::string & name, const StrategyStats & stats){
+      for(std::size_t location = 0; location < kCellNum; ++location){
+        std::fprintf(out, "%s,%zu,%zu,%zu,%llu,%llu\n", name.c_str(), location, location / Rules::kDim, location % Rules::kDim,
+                     static_cast<unsigned long long>(stats.shots[location]), static_cast<unsigned long long>(stats.hits[location]));
+      }
+    });
+  }
+
+private:
+  template<typename Handler>
+  void ForEachPlayed(Handler handler) const{
+    for(std::size_t i = 0; i < kStrategyAttackNum; ++i){
+      if(strategies[i].players > 0) handler(StrategyAttackToString(static_cast<StrategyAttack>(i)), strategies[i]);
+    }
+  }
+
+  // the non zero bins
+  void PrintHistogram(std::FILE* out, const char* columns, const std::uint64_t (StrategyStats::*histogram)[kCellNum + 1]) const{
+    std::fprintf(out, "\nstrategy,%s\n", columns);
+    ForEachPlayed([out, histogram](const std::string & name, const StrategyStats & stats){
+      for(std::size_t i = 0; i <= kCellNum; ++i){
+        if((stats.*histogram)[i] == 0) continue;
+        std::fprintf(out, "%s,%zu,%llu\n", name.c_str(), i, static_cast<unsigned long long>((stats.*histogram)[i]));
+      }
+    });
+  }
+};
+
+// Reads every game of some record files. The files are mapped, not read, and cut into chunks of
+// whole blocks, a few megabytes each, at the block offsets of the index at the end of a file. Every
+// worker takes the next chunk until none is left and counts into stats of its own, the records are
+// decoded one at a time on its stack. A chunk's pages are released once it is read, so the files can
+// be any size.
+template<typename Rules>
+class BasicGameRecordAnalysis{
+public:
+  typedef BasicGameRecord<Rules> GameRecord;
+  typedef BasicGameRecordStats<Rules> GameRecordStats;
+
+  // the least a chunk holds, but for the last one of a file
+  static const std::size_t kChunkLength = 4 << 20;
+
+  // num_threads == 0 means one worker per hardware thread
+  explicit BasicGameRecordAnalysis(std::size_t num_threads = 0, std::size_t chunk_length = kChunkLength):
+    num_threads_(num_threads),
+    chunk_length_(chunk_length){
+  }
+
+  // false if the file can't be mapped or holds records of other rules
+  bool AddFile(const std::string & path){
+    std::unique_ptr<MappedFile> file(new MappedFile());
+    if(!file->Open(path)) return false;
+    if(!CheckGameRecordFileHeader<Rules>(file->GetData(), file->GetLength())) return false;
+
+    // the index at the end is all that is read here, the chunks start at the blocks it names
+    std::vector<std::size_t> block_offsets;
+    std::size_t end = 0;
+    if(ReadGameRecordIndex(file->GetData(), file->GetLength(), &block_offsets, &end)){
+      std::size_t chunk_begin = block_offsets.empty() ? end : block_offsets[0];
+      for(std::size_t block_offset : block_offsets){
+        if(block_offset - chunk_begin >= chunk_length_){
+          chunks_.push_back(Chunk{file.get(), chunk_begin, block_offset});
+          chunk_begin = block_offset;
+        }
+      }
+      if(end > chunk_begin) chunks_.push_back(Chunk{file.get(), chunk_begin, end});
+      files_.push_back(std::move(file));
+      return true;
+    }
+
+    // the writer didn't finish the file, the block headers are walked instead
+    std::size_t offset = kGameRecordFileHeaderLength;
+    std::size_t chunk_begin = offset;
+    while(offset < file->GetLength()){
+      std::size_t block_begin = offset;
+      std::size_t length = 0;
+      std::size_t game_num = 0;
+      if(!ReadGameRecordBlockHeader(file->GetData(), file->GetLength(), &offset, &length, &game_num)){
+        cut_blocks_ += 1;
+        offset = block_begin;
+        break;
+      }
+      offset += length;
+      if(offset - chunk_begin >= chunk_length_){
+        chunks_.push_back(Chunk{file.get(), chunk_begin, offset});
+        chunk_begin = offset;
+      }
+    }
+    if(offset > chunk_begin) chunks_.push_back(Chunk{file.get(), chunk_begin, offset});
+    files_.push_back(std::move(file));
+    return true;
+  }
+
+  GameRecordStats Run(){
+    ThreadPool pool(num_threads_);
+    std::vector<std::unique_ptr<GameRecordStats>> worker_stats;
+    std::atomic<std::size_t> next_chunk{0};
+    for(std::size_t i = 0; i < pool.GetThreadNum(); ++i){
+      worker_stats.emplace_back(new GameRecordStats());
+      GameRecordStats* stats = worker_stats.back().get();
+      pool.Submit([this, stats, &next_chunk](){
+        for(std::size_t chunk = next_chunk.fetch_add(1); chunk < chunks_.size(); chunk = next_chunk.fetch_add(1)){
+          ReadChunk(chunks_[chunk], stats);
+        }
+      });
+    }
+    pool.Wait();
+
+    GameRecordStats total;
+    total.broken = cut_blocks_;
+    for(const std::unique_ptr<GameRecordStats> & stats : worker_stats){
+      total.Add(*stats);
+    }
+    return total;
+  }
+
+  std::size_t GetChunkNum() const{
+    return chunks_.size();
+  }
+
+private:
+  struct Chunk{
+    const MappedFile* file;
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  std::size_t num_threads_;
+  std::size_t chunk_length_;
+  std::vector<std::unique_ptr<MappedFile>> files_;
+  std::vector<Chunk> chunks_;
+  std::uint64_t cut_blocks_ = 0;
+
+  static void ReadChunk(const Chunk & chunk, GameRecordStats* stats){
+    const unsigned char* data = chunk.file->GetData();
+    std::size_t offset = chunk.begin;
+    GameRecord record;
+    while(offset < chunk.end){
+      std::size_t length = 0;
+      std::size_t game_num = 0;
+      // a block running past the next one, or an index of the wrong blocks
+      if(!ReadGameRecordBlockHeader(data, chunk.end, &offset, &length, &game_num)){
+        stats->broken += 1;
+        break;
+      }
+      BasicGameRecordBlockReader<Rules> reader(data + offset, length, game_num);
+      std::size_t read = 0;
+      while(reader.Next(&record)){
+        read += 1;
+        if(!stats->AddGame(record)) stats->broken += 1;
+      }
+      // the rest of a broken block can't be found, bytes left over after every game break the block too
+      if(!reader.IsDone()) stats->broken += read == game_num ? 1 : game_num - read;
+      offset += length;
+    }
+    chunk.file->Release(chunk.begin, chunk.end - chunk.begin);
+  }
+};
+
+typedef BasicGameRecordStats<ClassicRules> GameRecordStats;
+typedef BasicGameRecordAnalysis<ClassicRules> GameRecordAnalysis;
+
+#endif //BATTLESHIP_GAME_GAME_RECORD_ANALYSIS_H
@@ -0,0 +1,153 @@
+//
+// Streaming writer of game records into a series of files, a new file once one is big enough.
+//
+
+#ifndef BATTLESHIP_GAME_GAME_RECORD_WRITER_H
+#define BATTLESHIP_GAME_GAME_RECORD_WRITER_H
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "simulation/game_record.h"
+
+// Blocks from any number of threads go to prefix.000000.bsgr, prefix.000001.bsgr and so on. A file
+// is closed once it holds max_file_bytes or more and ends with an index of its blocks. A block is never
+// split over two files, so every file can be read on its own. Taking the lock once a block, tens of
+// kilobytes, costs the games nothing.
+template<typename Rules>
+class BasicGameRecordWriter{
+public:
+  typedef BasicGameRecord<Rules> GameRecord;
+  typedef BasicGameRecordBlock<Rules> GameRecordBlock;
+
+  // the bytes handed to stdio at once
+  static const std::size_t kFileBufferLength = 1 << 20;
+
+  BasicGameRecordWriter(const std::string & prefix, std::uint64_t max_file_bytes):
+    prefix_(prefix),
+    max_file_bytes_(max_file_bytes){
+  }
+
+  ~BasicGameRecordWriter(){
+    Close();
+  }
+
+  BasicGameRecordWriter(const BasicGameRecordWriter &) = delete;
+  BasicGameRecordWriter & operator=(const BasicGameRecordWriter &) = delete;
+
+  // false if the block couldn't be written, the writer writes nothing more then
+  bool Write(const GameRecordBlock & block){
+    if(block.IsEmpty()) return true;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(failed_) return false;
+    if(file_ == nullptr && !OpenNext()) return false;
+
+    unsigned char header[kGameRecordBlockHeaderLength];
+    block.WriteHeader(header);
+    block_offsets_.push_back(file_bytes_);
+    if(std::fwrite(header, 1, sizeof(header), file_) != sizeof(header)
+       || std::fwrite(block.GetRecords(), 1, block.GetLength(), file_) != block.GetLength()){
+      failed_ = true;
+      return false;
+    }
+    file_bytes_ += sizeof(header) + block.GetLength();
+    game_num_ += block.GetGameNum();
+    if(file_bytes_ >= max_file_bytes_) CloseFile();
+    return true;
+  }
+
+  // the games of a block of the calling thread's, when it is full the block goes to the file and is cleared
+  bool Add(GameRecordBlock & block, const GameRecord & record){
+    if(block.Add(record)) return true;
+    bool success = Write(block);
+    block.Clear();
+    bool added = block.Add(record);
+    assert(added);
+    return success && added;
+  }
+
+  void Close(){
+    std::lock_guard<std::mutex> lock(mutex_);
+    CloseFile();
+  }
+
+  // every file written to, in order
+  std::vector<std::string> GetFileNames() const{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return file_names_;
+  }
+
+  std::uint64_t GetGameNum() const{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return game_num_;
+  }
+
+  bool IsFailed() const{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_;
+  }
+
+private:
+  std::string prefix_;
+  std::uint64_t max_file_bytes_;
+
+  mutable std::mutex mutex_;
+  std::FILE* file_ = nullptr;
+  std::vector<char> file_buffer_;
+  std::uint64_t file_bytes_ = 0;
+  // where the blocks of the open file start, for its index
+  std::vector<std::uint64_t> block_offsets_;
+  std::uint64_t game_num_ = 0;
+  std::vector<std::string> file_names_;
+  bool failed_ = false;
+
+  bool OpenNext(){
+    char number[16];
+    std::snprintf(number, sizeof(number), ".%06zu.bsgr", file_names_.size());
+    std::string name = prefix_ + number;
+    file_ = std::fopen(name.c_str(), "wb");
+    if(file_ == nullptr){
+      failed_ = true;
+      return false;
+    }
+    file_buffer_.resize(kFileBufferLength);
+    std::setvbuf(file_, file_buffer_.data(), _IOFBF, file_buffer_.size());
+    unsigned char header[kGameRecordFileHeaderLength];
+    WriteGameRecordFileHeader<Rules>(header);
+    if(std::fwrite(header, 1, sizeof(header), file_) != sizeof(header)){
+      failed_ = true;
+      return false;
+    }
+    file_bytes_ = sizeof(header);
+    block_offsets_.clear();
+    file_names_.push_back(name);
+    return true;
+  }
+
+  void CloseFile(){
+    if(file_ == nullptr) return;
+    if(!failed_) WriteIndex();
+    if(std::fclose(file_) != 0) failed_ = true;
+    file_ = nullptr;
+  }
+  // the offsets of the blocks and of the index itself, as a block of no games
+  void WriteIndex(){
+    std::vector<unsigned char> index(kGameRecordBlockHeaderLength + 8 * (block_offsets_.size() + 1));
+    std::size_t offset = 0;
+    serialization::FixedField<4>::Write(index.data(), &offset, index.size() - kGameRecordBlockHeaderLength);
+    serialization::FixedField<4>::Write(index.data(), &offset, 0);
+    for(std::uint64_t block_offset : block_offsets_){
+      serialization::FixedField<8>::Write(index.data(), &offset, block_offset);
+    }
+    serialization::FixedField<8>::Write(index.data(), &offset, file_bytes_);
+    if(std::fwrite(index.data(), 1, index.size(), file_) != index.size()) failed_ = true;
+  }
+
+};
+
+typedef BasicGameRecordWriter<ClassicRules> GameRecordWriter;
+
+#endif //BATTLESHIP_GAME_GAME_RECORD_WRITER_H
@@ -0,0 +1,273 @@
+//
+// Replay of a recorded game, move by move in both directions, with the boards and brains of both players.
+//
+
+#ifndef BATTLESHIP_GAME_GAME_REPLAY_H
+#define BATTLESHIP_GAME_GAME_REPLAY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "ai/random_unit.h"
+#include "simulation/game_record.h"
+#include "simulation/headless_match.h"
+
+// GameReplay plays a recorded game again the way BasicHeadlessMatch played it: the same random
+// stream from the seed of the record, the fleets planned and every attack location generated by the
+// brains, so their boards, imagine boards and probability boards go through the same states. The
+// move fired is always the recorded one. Where a brain would have fired somewhere else the replay
+// notes the first such move, from there on the brains no longer see what the original players saw.
+// Monte Carlo decides within a wall time budget, a game with it can diverge on any replay.
+//
+// The whole state is copied into a checkpoint every checkpoint_interval moves on the way forward,
+// going back restores the checkpoint before the position and plays on from it, so any position is
+// at most checkpoint_interval - 1 moves away.
+//
+// The replay draws from a generator of its own, swapped in for the calling thread's while it plays.
+template<typename Rules>
+class BasicGameReplay{
+public:
+  typedef BasicGameRecord<Rules> GameRecord;
+  typedef BasicHeadlessPlayer<Rules> HeadlessPlayer;
+
+  static const std::size_t kCheckpointInterval = 16;
+  // no move diverged
+  static const std::size_t kNoDivergence = static_cast<std::size_t>(-1);
+
+  // the record has to be a whole game, one the analysis doesn't count as broken
+  explicit BasicGameReplay(const GameRecord & record, std::size_t checkpoint_interval = kCheckpointInterval):
+    record_(record),
+    checkpoint_interval_(checkpoint_interval),
+    live_(NewState()){
+    assert(checkpoint_interval_ > 0);
+    // nothing to check the choices of the brains against without the seed
+    if(record_.seeded) live_->engine.Seed(record_.seed);
+    else divergence_ = 0;
+    {
+      EngineSwap swap(live_->engine);
+      PlaceShips(*live_, 0);
+      PlaceShips(*live_, 1);
+    }
+    checkpoints_.emplace_back(NewState());
+    *checkpoints_.back() = *live_;
+  }
+
+  const GameRecord & GetRecord() const{
+    return record_;
+  }
+
+  // the number of moves played
+  std::size_t GetPosition() const{
+    return position_;
+  }
+
+  std::size_t GetMoveNum() const{
+    return record_.moves.size();
+  }
+
+  // index of the player who fires the move at the position, in the record
+  std::size_t GetMover() const{
+    return record_.Mover(position_);
+  }
+
+  // the first move a brain would have fired differently, 0 also if the fleets differ or the record has no seed
+  std::size_t GetDivergence() const{
+    return divergence_;
+  }
+
+  // a brain planned another fleet than the recorded one
+  bool FleetsDiverged() const{
+    return fleets_diverged_;
+  }
+
+  // the player of the record at the position: its own board, the enemy as its brain knows it and the probability board
+  HeadlessPlayer & GetPlayer(std::size_t index){
+    return live_->Player(index);
+  }
+
+  // false at the end of the game
+  bool StepForward(){
+    if(position_ == record_.moves.size()) return false;
+    {
+      EngineSwap swap(live_->engine);
+      PlayRecordedMove(*live_, position_);
+    }
+    position_ += 1;
+    if(position_ % checkpoint_interval_ == 0 && position_ / checkpoint_interval_ == checkpoints_.size()){
+      checkpoints_.emplace_back(NewState());
+      *checkpoints_.back() = *live_;
+    }
+    return true;
+  }
+
+  // false at the start of the game
+  bool StepBackward(){
+    if(position_ == 0) return false;
+    Seek(position_ - 1);
+    return true;
+  }
+
+  // to the position after the first `position` moves
+  void Seek(std::size_t position){
+    assert(position <= record_.moves.size());
+    std::size_t checkpoint = std::min(position / checkpoint_interval_, checkpoints_.size() - 1);
+    // back, or forward past a checkpoint already taken
+    if(position < position_ || checkpoint * checkpoint_interval_ > position_){
+      *live_ = *checkpoints_[checkpoint];
+      position_ = checkpoint * checkpoint_interval_;
+    }
+    while(position_ < position){
+      StepForward();
+    }
+  }
+
+  // Plays on from the position to the end with other attack strategies and a random stream from the seed,
+  // the replay stays where it is. branch gets the game as it went, with the recorded moves up to the position.
+  MatchResult PlayOut(StrategyAttack attack_a, StrategyAttack attack_b, std::uint64_t seed, GameRecord* branch = nullptr){
+    std::unique_ptr<State> state(NewState());
+    *state = *live_;
+    state->Player(0).setting.attack_strategy = attack_a;
+    state->Player(1).setting.attack_strategy = attack_b;
+    state->engine.Seed(seed);
+    if(branch){
+      *branch = record_;
+      branch->seeded = false;
+      branch->seed = 0;
+      branch->duration_ns = 0;
+      branch->players[0].attack = attack_a;
+      branch->players[1].attack = attack_b;
+      branch->moves.clear();
+      for(std::size_t move = 0; move < position_; ++move){
+        branch->moves.push_back(record_.moves[move]);
+      }
+    }
+
+    {
+      EngineSwap swap(state->engine);
+      for(std::size_t move = position_; !IsOver(*state); ++move){
+        std::size_t location = PlayMove(*state, move, nullptr);
+        if(branch) branch->moves.push_back(static_cast<std::uint16_t>(location));
+      }
+    }
+
+    MatchResult res;
+    res.game_id = record_.game_id;
+    for(std::size_t i = 0; i < 2; ++i){
+      res.cli_id[i] = record_.players[i].cli_id;
+      res.does_win[i] = state->Player(i).is_winner_me;
+      res.num_moves[i] = state->Player(i).board.GetNumMoves();
+    }
+    if(branch) branch->winner = res.does_win[0] ? 0 : 1;
+    return res;
+  }
+
+private:
+  // everything the players of the match have, and the random stream they draw from
+  struct State{
+    HeadlessPlayer player_a;
+    HeadlessPlayer player_b;
+    Xoshiro256 engine;
+
+    State(const PlayerSetting & a, const PlayerSetting & b):
+      player_a(a),
+      player_b(b){
+    }
+
+    HeadlessPlayer & Player(std::size_t index){
+      return index == 0 ? player_a : player_b;
+    }
+  };
+
+  // the calling thread draws from engine while it lives
+  struct EngineSwap{
+    Xoshiro256 & engine;
+
+    explicit EngineSwap(Xoshiro256 & engine):
+      engine(engine){
+      std::swap(RandomUnit::Engine(), engine);
+    }
+
+    ~EngineSwap(){
+      std::swap(RandomUnit::Engine(), engine);
+    }
+  };
+
+  GameRecord record_;
+  std::size_t checkpoint_interval_;
+  std::unique_ptr<State> live_;
+  std::size_t position_ = 0;
+  // checkpoints_[i] is the state after i * checkpoint_interval_ moves
+  std::vector<std::unique_ptr<State>> checkpoints_;
+  std::size_t divergence_ = kNoDivergence;
+  bool fleets_diverged_ = false;
+
+  State* NewState() const{
+    return new State(PlayerSetting(record_.players[0].cli_id, record_.players[0].attack, record_.players[0].place),
+                     PlayerSetting(record_.players[1].cli_id, record_.players[1].attack, record_.players[1].place));
+  }
+
+  static bool IsOver(State & state){
+    return state.player_a.is_winner_me || state.player_b.is_winner_me;
+  }
+
+  // the plan draws what it drew in the match, the recorded fleet goes on the board
+  void PlaceShips(State & state, std::size_t index){
+    HeadlessPlayer & player = state.Player(index);
+    typename BasicClientBrain<Rules>::ShipPlacingPlanList plan = player.brain.GenerateShipPlacingPlan(player.setting.place_strategy);
+    const typename GameRecord::Fleet & fleet = record_.players[index].fleet;
+    bool same = plan.size() == fleet.size();
+    for(std::size_t i = 0; same && i < plan.size(); ++i){
+      same = plan[i].type == fleet[i].type && plan[i].head_location == fleet[i].head_location && plan[i].direction == fleet[i].direction;
+    }
+    if(!same){
+      fleets_diverged_ = true;
+      divergence_ = 0;
+    }
+    for(const ShipPlacementInfo & placement : fleet){
+      bool success = player.board.PlaceAShip(placement.type, placement.head_location, placement.direction);
+      assert(success);
+    }
+  }
+
+  void PlayRecordedMove(State & state, std::size_t move){
+    std::size_t recorded = record_.moves[move];
+    std::size_t location = PlayMove(state, move, &recorded);
+    if(location != recorded && divergence_ == kNoDivergence) divergence_ = move;
+  }
+
+  // mirror of BasicHeadlessMatch::MakeOneMove, but fires at *recorded if given
+  // return the location the brain generated
+  std::size_t PlayMove(State & state, std::size_t move, const std::size_t* recorded){
+    std::size_t mover = record_.Mover(move);
+    HeadlessPlayer & attacker = state.Player(mover);
+    HeadlessPlayer & defender = state.Player(1 - mover);
+    attacker.board.IncrementOneMove();
+    defender.brain.GetRefEnemyBoard().IncrementOneMove();
+
+    std::size_t location = attacker.brain.GenerateNextAttackLocation(attacker.setting.attack_strategy);
+    AttackResult res = defender.board.Attack(recorded ? *recorded : location);
+    attacker.brain.DigestAttackResult(res);
+    if(res.attacker_win){
+      attacker.is_winner_me = true;
+      SetWinnerLoserOnBoards(state.player_a);
+      SetWinnerLoserOnBoards(state.player_b);
+    }
+    return location;
+  }
+
+  static void SetWinnerLoserOnBoards(HeadlessPlayer & player){
+    player.board.SetGameOver();
+    player.brain.GetRefEnemyBoard().SetGameOver();
+    if(player.is_winner_me){
+      player.board.SetThisWinner();
+    }else{
+      player.brain.GetRefEnemyBoard().SetThisWinner();
+    }
+  }
+};
+
+typedef BasicGameReplay<ClassicRules> GameReplay;
+
+#endif //BATTLESHIP_GAME_GAME_REPLAY_H
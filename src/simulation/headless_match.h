@@ -0,0 +1,175 @@
+//
+// Headless in-process match between two AI players, no sockets involved.
+//
+
+#ifndef BATTLESHIP_GAME_HEADLESS_MATCH_H
+#define BATTLESHIP_GAME_HEADLESS_MATCH_H
+
+#include <chrono>
+#include <cstdint>
+#include "client/client_common.h"
+#include "client/client_brain.h"
+#include "core/game/board.h"
+#include "ai/random_unit.h"
+#include "simulation/game_record.h"
+#include "utils/utils.h"
+
+struct PlayerSetting{
+  ClientId cli_id;
+  StrategyAttack attack_strategy;
+  StrategyPlaceShip place_strategy;
+
+  PlayerSetting(ClientId cli_id, StrategyAttack attack_strategy, StrategyPlaceShip place_strategy):
+    cli_id(cli_id),
+    attack_strategy(attack_strategy),
+    place_strategy(place_strategy){};
+};
+
+struct MatchResult{
+  GameId game_id;
+  ClientId cli_id[2];
+  bool does_win[2];
+  size_t num_moves[2];
+
+  void Log() const{
+    LogResult(cli_id[0], game_id, does_win[0], num_moves[0]);
+    LogResult(cli_id[1], game_id, does_win[1], num_moves[1]);
+  }
+};
+
+// one side of a headless match, it owns everything a GameClient owns except the talker
+template<typename Rules>
+struct BasicHeadlessPlayer{
+  PlayerSetting setting;
+  BasicBoard<Rules> board;
+  BasicClientBrain<Rules> brain;
+  bool is_winner_me = false;
+
+  BasicHeadlessPlayer(const PlayerSetting & setting):
+    setting(setting),
+    brain(board){
+  }
+};
+
+// HeadlessMatch plays the same game two GameClients would play over the network,
+// but calls Board::Attack and ClientBrain::DigestAttackResult directly, so there is
+// no talker, no socket and no sleep between turns. Unlike the network game it plays any rules.
+template<typename Rules>
+class BasicHeadlessMatch{
+public:
+  typedef BasicHeadlessPlayer<Rules> HeadlessPlayer;
+
+  BasicHeadlessMatch(const PlayerSetting & a, const PlayerSetting & b, GameId game_id):
+    game_id_(game_id),
+    player_a_(a),
+    player_b_(b){
+  }
+
+  // draw everything random in the match from this seed, so the match can be played again
+  void SetSeed(std::uint64_t seed){
+    seeded_ = true;
+    seed_ = seed;
+  }
+
+  // the next Play writes the whole game into record, player a is the first player of it
+  void SetRecord(BasicGameRecord<Rules>* record){
+    record_ = record;
+  }
+
+  MatchResult Play(){
+    auto start = record_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    if(record_) record_->Clear();
+    if(seeded_) RandomUnit::Seed(seed_);
+    PlaceShips(player_a_, 0);
+    PlaceShips(player_b_, 1);
+
+    // same rule as ClientTalker::DecideWhoFireFirst, the higher client id fires first
+    assert(player_a_.setting.cli_id != player_b_.setting.cli_id);
+    bool a_turn = player_a_.setting.cli_id > player_b_.setting.cli_id;
+    bool a_first = a_turn;
+
+    while(true){
+      HeadlessPlayer & attacker = a_turn ? player_a_ : player_b_;
+      HeadlessPlayer & defender = a_turn ? player_b_ : player_a_;
+      if(MakeOneMove(attacker, defender)){
+        attacker.is_winner_me = true;
+        break;
+      }
+      a_turn = !a_turn;
+    }
+
+    SetWinnerLoserOnBoards(player_a_);
+    SetWinnerLoserOnBoards(player_b_);
+
+    MatchResult res;
+    res.game_id = game_id_;
+    res.cli_id[0] = player_a_.setting.cli_id;
+    res.cli_id[1] = player_b_.setting.cli_id;
+    res.does_win[0] = player_a_.is_winner_me;
+    res.does_win[1] = player_b_.is_winner_me;
+    res.num_moves[0] = player_a_.board.GetNumMoves();
+    res.num_moves[1] = player_b_.board.GetNumMoves();
+    if(record_) FinishRecord(a_first, std::chrono::steady_clock::now() - start);
+    return res;
+  }
+
+private:
+  GameId game_id_;
+  HeadlessPlayer player_a_;
+  HeadlessPlayer player_b_;
+  bool seeded_ = false;
+  std::uint64_t seed_ = 0;
+  BasicGameRecord<Rules>* record_ = nullptr;
+
+  // index is the player's in the record
+  void PlaceShips(HeadlessPlayer & player, std::size_t index){
+    typename BasicClientBrain<Rules>::ShipPlacingPlanList plan = player.brain.GenerateShipPlacingPlan(player.setting.place_strategy);
+    for(auto placement : plan){
+      bool success = player.board.PlaceAShip(placement.type, placement.head_location, placement.direction);
+      assert(success);
+    }
+    if(record_) record_->players[index].fleet = plan;
+  }
+
+  // mirror of GameClient::MakeOneMove and GameClient::WaitForEnemyAndReplyWithResult
+  // return true if the attacker wins
+  bool MakeOneMove(HeadlessPlayer & attacker, HeadlessPlayer & defender){
+    attacker.board.IncrementOneMove();
+    defender.brain.GetRefEnemyBoard().IncrementOneMove();
+
+    size_t location = attacker.brain.GenerateNextAttackLocation(attacker.setting.attack_strategy);
+    AttackResult res = defender.board.Attack(location);
+    attacker.brain.DigestAttackResult(res);
+    if(record_) record_->moves.push_back(static_cast<std::uint16_t>(location));
+    return res.attacker_win;
+  }
+
+  void FinishRecord(bool a_first, std::chrono::steady_clock::duration duration){
+    record_->game_id = game_id_;
+    record_->seeded = seeded_;
+    record_->seed = seed_;
+    record_->duration_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    const HeadlessPlayer* players[] = {&player_a_, &player_b_};
+    for(std::size_t i = 0; i < 2; ++i){
+      record_->players[i].cli_id = players[i]->setting.cli_id;
+      record_->players[i].attack = players[i]->setting.attack_strategy;
+      record_->players[i].place = players[i]->setting.place_strategy;
+    }
+    record_->first = a_first ? 0 : 1;
+    record_->winner = player_a_.is_winner_me ? 0 : 1;
+  }
+
+  void SetWinnerLoserOnBoards(HeadlessPlayer & player){
+    player.board.SetGameOver();
+    player.brain.GetRefEnemyBoard().SetGameOver();
+    if(player.is_winner_me){
+      player.board.SetThisWinner();
+    }else{
+      player.brain.GetRefEnemyBoard().SetThisWinner();
+    }
+  }
+};
+
+typedef BasicHeadlessMatch<ClassicRules> HeadlessMatch;
+
+#endif //BATTLESHIP_GAME_HEADLESS_MATCH_H
@@ -0,0 +1,272 @@
+//
+// Tournament over every StrategyAttack x StrategyPlaceShip pair, spread over a thread pool.
+//
+
+#ifndef BATTLESHIP_GAME_TOURNAMENT_H
+#define BATTLESHIP_GAME_TOURNAMENT_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include "simulation/game_record_writer.h"
+#include "simulation/headless_match.h"
+#include "utils/log.h"
+#include "utils/thread_pool.h"
+
+static const StrategyAttack kTournamentAttackList[] = {
+  StrategyAttack::kRandom,
+  StrategyAttack::kDFS,
+  StrategyAttack::kProbabilitySimple,
+  StrategyAttack::kDFSProbability,
+  StrategyAttack::kMonteCarlo
+};
+
+static const StrategyPlaceShip kTournamentPlaceShipList[] = {
+  StrategyPlaceShip::kFixed,
+  StrategyPlaceShip::kRandom
+};
+
+struct TournamentSetting{
+  // games played by every (attack, placement) pair
+  size_t games_per_pair = 1000;
+  // 0 means one worker per hardware thread
+  size_t num_threads = 0;
+  // games one task plays in a row, big enough to hide the scheduling cost
+  size_t games_per_task = 64;
+  // the defender attacks back with this strategy
+  StrategyAttack defender_attack = StrategyAttack::kDFSProbability;
+  // the challenger hides its own ships with this strategy
+  StrategyPlaceShip challenger_place = StrategyPlaceShip::kRandom;
+  // seed every game from this seed, the same seed plays the same games
+  bool seeded = false;
+  std::uint64_t seed = 0;
+  // record every game into files of this prefix, none if empty
+  std::string record_prefix;
+  // a new file once one has this many bytes
+  std::uint64_t record_file_bytes = std::uint64_t(1) << 30;
+};
+
+// what one pair gathered, plain counters so partial results merge by addition
+template<typename Rules>
+struct BasicPairStats{
+  static const std::size_t kDim = Rules::kDim;
+
+  size_t games = 0;
+  size_t wins = 0;
+  // moves_histogram[m] is the number of games the challenger finished in m moves
+  size_t moves_histogram[kDim * kDim + 1] = {};
+
+  void Add(const BasicPairStats & other){
+    games += other.games;
+    wins += other.wins;
+    for(size_t i = 0; i <= kDim * kDim; ++i){
+      moves_histogram[i] += other.moves_histogram[i];
+    }
+  }
+
+  double WinRate() const{
+    return games == 0 ? 0.0 : static_cast<double>(wins) / games;
+  }
+
+  // 95% Wilson score interval of the win rate
+  void WinRateInterval(double* low, double* high) const{
+    const double z = 1.96;
+    if(games == 0){
+      *low = 0.0;
+      *high = 0.0;
+      return;
+    }
+    double n = static_cast<double>(games);
+    double p = WinRate();
+    double denominator = 1.0 + z * z / n;
+    double center = (p + z * z / (2.0 * n)) / denominator;
+    double margin = z * std::sqrt(p * (1.0 - p) / n + z * z / (4.0 * n * n)) / denominator;
+    *low = center - margin;
+    *high = center + margin;
+  }
+
+  double MeanMoves() const{
+    if(games == 0) return 0.0;
+    double sum = 0.0;
+    for(size_t i = 0; i <= kDim * kDim; ++i){
+      sum += static_cast<double>(i) * moves_histogram[i];
+    }
+    return sum / games;
+  }
+
+  // 95% normal interval of the mean move number
+  void MeanMovesInterval(double* low, double* high) const{
+    double mean = MeanMoves();
+    if(games < 2){
+      *low = mean;
+      *high = mean;
+      return;
+    }
+    double squares = 0.0;
+    for(size_t i = 0; i <= kDim * kDim; ++i){
+      double diff = static_cast<double>(i) - mean;
+      squares += diff * diff * moves_histogram[i];
+    }
+    double margin = 1.96 * std::sqrt(squares / (games - 1)) / std::sqrt(static_cast<double>(games));
+    *low = mean - margin;
+    *high = mean + margin;
+  }
+
+  // smallest move number m such that at least `percentile` of the games finished within m moves
+  size_t MovesPercentile(double percentile) const{
+    double target = percentile * games;
+    size_t seen = 0;
+    for(size_t i = 0; i <= kDim * kDim; ++i){
+      seen += moves_histogram[i];
+      if(seen > 0 && seen >= target) return i;
+    }
+    return kDim * kDim;
+  }
+};
+
+template<typename Rules>
+struct BasicPairResult{
+  StrategyAttack attack;
+  StrategyPlaceShip place;
+  BasicPairStats<Rules> stats;
+};
+
+typedef BasicPairStats<ClassicRules> PairStats;
+typedef BasicPairResult<ClassicRules> PairResult;
+
+// The challenger attacks with `attack` and the defender hides its ships with `place`.
+// Everything a game touches lives on the stack of the worker playing it, and every task
+// writes its own PairStats slot, so workers share nothing until the final merge.
+template<typename Rules>
+class BasicTournament{
+public:
+  typedef BasicPairStats<Rules> PairStats;
+  typedef BasicPairResult<Rules> PairResult;
+  typedef BasicGameRecord<Rules> GameRecord;
+  typedef BasicGameRecordWriter<Rules> GameRecordWriter;
+
+  BasicTournament(const TournamentSetting & setting):
+    setting_(setting){
+  }
+
+  std::vector<PairResult> Run(){
+    std::vector<PairResult> results;
+    for(StrategyAttack attack : kTournamentAttackList){
+      for(StrategyPlaceShip place : kTournamentPlaceShipList){
+        PairResult result;
+        result.attack = attack;
+        result.place = place;
+        results.push_back(result);
+      }
+    }
+
+    // every game of the tournament has an id of its own
+    assert(results.size() * setting_.games_per_pair <= std::numeric_limits<GameId>::max());
+    size_t games_per_task = setting_.games_per_task > 0 ? setting_.games_per_task : 1;
+    size_t tasks_per_pair = (setting_.games_per_pair + games_per_task - 1) / games_per_task;
+    std::vector<PairStats> task_stats(results.size() * tasks_per_pair);
+    std::unique_ptr<GameRecordWriter> writer;
+    if(!setting_.record_prefix.empty()){
+      writer.reset(new GameRecordWriter(setting_.record_prefix, setting_.record_file_bytes));
+    }
+
+    {
+      ThreadPool pool(setting_.num_threads);
+      for(size_t pair = 0; pair < results.size(); ++pair){
+        for(size_t task = 0; task < tasks_per_pair; ++task){
+          size_t first_game = task * games_per_task;
+          size_t num_games = std::min(games_per_task, setting_.games_per_pair - first_game);
+          PairStats* slot = &task_stats[pair * tasks_per_pair + task];
+          StrategyAttack attack = results[pair].attack;
+          StrategyPlaceShip place = results[pair].place;
+          GameRecordWriter* task_writer = writer.get();
+          pool.Submit([this, slot, pair, attack, place, first_game, num_games, task_writer](){
+            PlayGames(pair, attack, place, first_game, num_games, slot, task_writer);
+          });
+        }
+      }
+      pool.Wait();
+    }
+    record_failed_ = false;
+    if(writer){
+      writer->Close();
+      record_failed_ = writer->IsFailed();
+    }
+
+    for(size_t pair = 0; pair < results.size(); ++pair){
+      for(size_t task = 0; task < tasks_per_pair; ++task){
+        results[pair].stats.Add(task_stats[pair * tasks_per_pair + task]);
+      }
+    }
+    return results;
+  }
+
+  // whether some records of the last Run could not be written
+  bool IsRecordFailed() const{
+    return record_failed_;
+  }
+
+  static void PrintResults(const std::vector<PairResult> & results){
+    // the table comes after whatever the games logged
+    FlushLog();
+    std::printf("attack,place,games,win_rate,win_rate_low,win_rate_high,"
+                "mean_moves,mean_moves_low,mean_moves_high,p50_moves,p90_moves,p99_moves\n");
+    for(const PairResult & result : results){
+      const PairStats & stats = result.stats;
+      double win_low, win_high, mean_low, mean_high;
+      stats.WinRateInterval(&win_low, &win_high);
+      stats.MeanMovesInterval(&mean_low, &mean_high);
+      std::printf("%s,%s,%zu,%.4f,%.4f,%.4f,%.2f,%.2f,%.2f,%zu,%zu,%zu\n",
+                  StrategyAttackToString(result.attack).c_str(),
+                  StrategyPlaceShipToString(result.place).c_str(),
+                  stats.games,
+                  stats.WinRate(), win_low, win_high,
+                  stats.MeanMoves(), mean_low, mean_high,
+                  stats.MovesPercentile(0.5), stats.MovesPercentile(0.9), stats.MovesPercentile(0.99));
+    }
+  }
+
+private:
+  TournamentSetting setting_;
+  bool record_failed_ = false;
+
+  // writer may be null, with one the games of the task go into a block of its own,
+  // pair is the index of the pair in the results, its games get the ids from pair * games_per_pair on
+  void PlayGames(size_t pair, StrategyAttack attack, StrategyPlaceShip place, size_t first_game, size_t num_games, PairStats* stats,
+                 GameRecordWriter* writer) const{
+    std::unique_ptr<BasicGameRecordBlock<Rules>> block;
+    GameRecord record;
+    if(writer) block.reset(new BasicGameRecordBlock<Rules>());
+    for(size_t i = 0; i < num_games; ++i){
+      size_t game = first_game + i;
+      // swap who fires first every other game, so the first move advantage cancels out
+      ClientId challenger_id = game % 2 == 0 ? 1 : 0;
+      PlayerSetting challenger(challenger_id, attack, setting_.challenger_place);
+      PlayerSetting defender(1 - challenger_id, setting_.defender_attack, place);
+
+      BasicHeadlessMatch<Rules> match(challenger, defender, static_cast<GameId>(pair * setting_.games_per_pair + game));
+      if(setting_.seeded){
+        // every pair plays its own games
+        size_t strategies = static_cast<size_t>(attack) * 16 + static_cast<size_t>(place);
+        match.SetSeed(RandomUnit::DeriveSeed(RandomUnit::DeriveSeed(setting_.seed, strategies), game));
+      }
+      if(writer) match.SetRecord(&record);
+      MatchResult res = match.Play();
+      if(writer) writer->Add(*block, record);
+
+      stats->games += 1;
+      if(res.does_win[0]) stats->wins += 1;
+      stats->moves_histogram[res.num_moves[0]] += 1;
+    }
+    if(writer) writer->Write(*block);
+  }
+};
+
+typedef BasicTournament<ClassicRules> Tournament;
+
+#endif //BATTLESHIP_GAME_TOURNAMENT_H
@@ -0,0 +1,239 @@
+//
+// Micro-benchmark harness: warm-up, timed samples, percentiles, instructions per operation and json output.
+//
+
+#ifndef UTILS_BENCHMARK_H_
+#define UTILS_BENCHMARK_H_
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// the compiler has to assume value is used, so the work making it stays
+template<typename T>
+static void KeepValue(const T & value){
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Retired user space instructions of the calling thread, from the perf counters of linux.
+// Not available elsewhere, nor where the kernel doesn't allow it (perf_event_paranoid, a vm without a pmu).
+class InstructionCounter{
+public:
+  InstructionCounter(){
+#ifdef __linux__
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+
+  ~InstructionCounter(){
+#ifdef __linux__
+    if(fd_ >= 0) close(fd_);
+#endif
+  }
+
+  InstructionCounter(const InstructionCounter &) = delete;
+  InstructionCounter & operator=(const InstructionCounter &) = delete;
+
+  bool IsAvailable() const{
+    return fd_ >= 0;
+  }
+
+  void Start(){
+#ifdef __linux__
+    if(fd_ < 0) return;
+    ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+  }
+
+  // instructions since Start, 0 if not available
+  std::uint64_t Stop(){
+    std::uint64_t count = 0;
+#ifdef __linux__
+    if(fd_ < 0) return 0;
+    ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+    if(read(fd_, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+    return count;
+  }
+
+private:
+  int fd_ = -1;
+};
+
+struct BenchmarkSetting{
+  // samples are taken and thrown away for this long first, to warm caches, predictors and the clock
+  size_t warm_up_ms = 100;
+  // timed samples
+  size_t samples = 100;
+};
+
+struct BenchmarkResult{
+  std::string name;
+  size_t warm_up_samples = 0;
+  double warm_up_seconds = 0;
+  size_t samples = 0;
+  size_t ops = 0;
+  // nanoseconds per operation, over the samples
+  double min_ns = 0;
+  double p50_ns = 0;
+  double p90_ns = 0;
+  double p99_ns = 0;
+  double max_ns = 0;
+  double mean_ns = 0;
+  // negative if the counters are not available
+  double instructions_per_op = -1;
+};
+
+// Runs benchmarks one after another and keeps their results.
+// A benchmark is a reset, run untimed before every sample, and a sample, timed, that makes some
+// operations and returns how many. Everything a sample needs is made by the reset, so setup is
+// never timed; a sample is long enough, thousands of nanoseconds, that reading the clock is noise.
+class BenchmarkRunner{
+public:
+  explicit BenchmarkRunner(const BenchmarkSetting & setting, const std::string & filter = ""):
+    setting_(setting),
+    filter_(filter){
+  }
+
+  // false if filtered out
+  template<typename Reset, typename Sample>
+  bool Run(const std::string & name, Reset reset, Sample sample){
+    if(!filter_.empty() && name.find(filter_) == std::string::npos) return false;
+    BenchmarkResult result;
+    result.name = name;
+
+    auto warm_up_start = std::chrono::steady_clock::now();
+    auto warm_up_end = warm_up_start + std::chrono::milliseconds(setting_.warm_up_ms);
+    do{
+      reset();
+      KeepValue(sample());
+      result.warm_up_samples += 1;
+    }while(std::chrono::steady_clock::now() < warm_up_end);
+    result.warm_up_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - warm_up_start).count();
+
+    std::vector<double> ns_per_op;
+    ns_per_op.reserve(setting_.samples);
+    std::uint64_t instructions = 0;
+    double total_ns = 0;
+    for(size_t i = 0; i < setting_.samples; ++i){
+      reset();
+      counter_.Start();
+      auto start = std::chrono::steady_clock::now();
+      size_t ops = sample();
+      auto end = std::chrono::steady_clock::now();
+      // a sample does something, or there is no time per op
+      assert(ops > 0);
+      instructions += counter_.Stop();
+      double ns = std::chrono::duration<double, std::nano>(end - start).count();
+      ns_per_op.push_back(ns / ops);
+      total_ns += ns;
+      result.ops += ops;
+    }
+    std::sort(ns_per_op.begin(), ns_per_op.end());
+    result.samples = ns_per_op.size();
+    result.min_ns = ns_per_op.front();
+    result.p50_ns = Percentile(ns_per_op, 0.5);
+    result.p90_ns = Percentile(ns_per_op, 0.9);
+    result.p99_ns = Percentile(ns_per_op, 0.99);
+    result.max_ns = ns_per_op.back();
+    result.mean_ns = total_ns / result.ops;
+    if(counter_.IsAvailable()) result.instructions_per_op = static_cast<double>(instructions) / result.ops;
+
+    std::printf("%s,%zu,%zu,%.1f,%.1f,%.1f,%.1f,", name.c_str(), result.samples, result.ops,
+                result.min_ns, result.p50_ns, result.p90_ns, result.p99_ns);
+    // an empty field without the counters
+    if(result.instructions_per_op >= 0) std::printf("%.1f", result.instructions_per_op);
+    std::printf("\n");
+    std::fflush(stdout);
+    results_.push_back(result);
+    return true;
+  }
+
+  static void PrintHeader(){
+    std::printf("name,samples,ops,min_ns,p50_ns,p90_ns,p99_ns,instructions_per_op\n");
+  }
+
+  const std::vector<BenchmarkResult> & GetResults() const{
+    return results_;
+  }
+
+  bool HasInstructionCounts() const{
+    return counter_.IsAvailable();
+  }
+
+  // one object, the setting and every result, for comparing runs of different commits
+  bool WriteJson(const std::string & path) const{
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if(file == nullptr) return false;
+    std::fprintf(file, "{\n  \"warm_up_ms\": %zu,\n  \"samples\": %zu,\n  \"instructions_available\": %s,\n  \"benchmarks\": [\n",
+                 setting_.warm_up_ms, setting_.samples, counter_.IsAvailable() ? "true" : "false");
+    for(size_t i = 0; i < results_.size(); ++i){
+      const BenchmarkResult & r = results_[i];
+      std::fprintf(file, "    {\"name\": \"%s\", \"warm_up_samples\": %zu, \"warm_up_seconds\": %.6f, \"samples\": %zu, \"ops\": %zu, "
+                         "\"min_ns\": %.3f, \"p50_ns\": %.3f, \"p90_ns\": %.3f, \"p99_ns\": %.3f, \"max_ns\": %.3f, \"mean_ns\": %.3f, ",
+                   JsonEscaped(r.name).c_str(), r.warm_up_samples, r.warm_up_seconds, r.samples, r.ops,
+                   r.min_ns, r.p50_ns, r.p90_ns, r.p99_ns, r.max_ns, r.mean_ns);
+      if(r.instructions_per_op < 0){
+        std::fprintf(file, "\"instructions_per_op\": null}");
+      }else{
+        std::fprintf(file, "\"instructions_per_op\": %.3f}", r.instructions_per_op);
+      }
+      std::fprintf(file, i + 1 < results_.size() ? ",\n" : "\n");
+    }
+    std::fprintf(file, "  ]\n}\n");
+    std::fclose(file);
+    return true;
+  }
+
+private:
+  BenchmarkSetting setting_;
+  std::string filter_;
+  InstructionCounter counter_;
+  std::vector<BenchmarkResult> results_;
+
+  // as a json string would have it
+  static std::string JsonEscaped(const std::string & text){
+    std::string out;
+    for(char c : text){
+      if(c == '"' || c == '\\'){
+        out += '\\';
+        out += c;
+      }else if(static_cast<unsigned char>(c) < 0x20){
+        char code[8];
+        std::snprintf(code, sizeof(code), "\\u%04x", c);
+        out += code;
+      }else{
+        out += c;
+      }
+    }
+    return out;
+  }
+
+  // nearest rank of sorted values
+  static double Percentile(const std::vector<double> & sorted, double fraction){
+    size_t rank = static_cast<size_t>(fraction * sorted.size());
+    return sorted[std::min(rank, sorted.size() - 1)];
+  }
+};
+
+#endif  // UTILS_BENCHMARK_H_
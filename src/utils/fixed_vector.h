@@ -0,0 +1,132 @@
+//
+// Vector with its capacity fixed at compile time and its elements stored inline.
+//
+
+#ifndef UTILS_FIXED_VECTOR_H_
+#define UTILS_FIXED_VECTOR_H_
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// never touches the heap, so it can be used where a move must not allocate.
+// elements never move while they are in the vector, pointers to them stay valid until they are removed.
+template<typename T, std::size_t N>
+class FixedVector{
+public:
+  typedef T value_type;
+  typedef T* iterator;
+  typedef const T* const_iterator;
+
+  FixedVector(){
+  }
+
+  FixedVector(const FixedVector & other){
+    for(const T & value : other){
+      push_back(value);
+    }
+  }
+
+  FixedVector & operator=(const FixedVector & other){
+    if(this != &other){
+      clear();
+      for(const T & value : other){
+        push_back(value);
+      }
+    }
+    return *this;
+  }
+
+  ~FixedVector(){
+    clear();
+  }
+
+  static constexpr std::size_t capacity(){
+    return N;
+  }
+
+  std::size_t size() const{
+    return size_;
+  }
+
+  bool empty() const{
+    return size_ == 0;
+  }
+
+  bool full() const{
+    return size_ == N;
+  }
+
+  void push_back(const T & value){
+    emplace_back(value);
+  }
+
+  template<typename... Args>
+  void emplace_back(Args&&... args){
+    assert(size_ < N);
+    new (&storage_[size_]) T(std::forward<Args>(args)...);
+    size_ += 1;
+  }
+
+  void pop_back(){
+    assert(size_ > 0);
+    size_ -= 1;
+    data()[size_].~T();
+  }
+
+  void clear(){
+    while(size_ > 0){
+      pop_back();
+    }
+  }
+
+  T & operator[](std::size_t i){
+    assert(i < size_);
+    return data()[i];
+  }
+
+  const T & operator[](std::size_t i) const{
+    assert(i < size_);
+    return data()[i];
+  }
+
+  T & back(){
+    return (*this)[size_ - 1];
+  }
+
+  const T & back() const{
+    return (*this)[size_ - 1];
+  }
+
+  T* data(){
+    return reinterpret_cast<T*>(storage_);
+  }
+
+  const T* data() const{
+    return reinterpret_cast<const T*>(storage_);
+  }
+
+  iterator begin(){
+    return data();
+  }
+
+  iterator end(){
+    return data() + size_;
+  }
+
+  const_iterator begin() const{
+    return data();
+  }
+
+  const_iterator end() const{
+    return data() + size_;
+  }
+
+private:
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type storage_[N];
+  std::size_t size_ = 0;
+};
+
+#endif  // UTILS_FIXED_VECTOR_H_
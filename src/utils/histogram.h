@@ -0,0 +1,149 @@
+//
+// Lock-free latency histograms in the way of HdrHistogram, and the scoped timers and counters feeding them.
+//
+
+#ifndef UTILS_HISTOGRAM_H_
+#define UTILS_HISTOGRAM_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+// -DBATTLESHIP_INSTRUMENT=0 compiles the timers and counters out, the histograms stay empty
+#ifndef BATTLESHIP_INSTRUMENT
+#define BATTLESHIP_INSTRUMENT 1
+#endif
+
+static const bool kInstrumented = BATTLESHIP_INSTRUMENT != 0;
+
+// Counts of values in buckets of about the same relative width: the values below kSubBuckets have
+// a bucket each, above that every power of two is split into kSubBuckets / 2 buckets, so a value
+// is known to within 1 / 16 of it. Any number of threads may record and read at once, a record
+// is a few relaxed atomic adds.
+class LatencyHistogram{
+public:
+  static const int kSubBucketBits = 5;
+  static const std::uint64_t kSubBuckets = 1 << kSubBucketBits;
+  static const std::uint64_t kHalfSubBuckets = kSubBuckets / 2;
+  // every power of two from kSubBuckets up to 2^63
+  static const std::size_t kBuckets = kSubBuckets + (64 - kSubBucketBits) * kHalfSubBuckets;
+
+  LatencyHistogram(){
+    for(std::atomic<std::uint64_t> & count : counts_){
+      count.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  LatencyHistogram(const LatencyHistogram &) = delete;
+  LatencyHistogram & operator=(const LatencyHistogram &) = delete;
+
+  void Record(std::uint64_t value){
+    counts_[BucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    std::uint64_t min = min_.load(std::memory_order_relaxed);
+    while(value < min && !min_.compare_exchange_weak(min, value, std::memory_order_relaxed)){}
+    std::uint64_t max = max_.load(std::memory_order_relaxed);
+    while(value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)){}
+  }
+
+  std::uint64_t GetCount() const{
+    return count_.load(std::memory_order_relaxed);
+  }
+
+  // 0 if nothing was recorded
+  std::uint64_t GetMin() const{
+    return GetCount() == 0 ? 0 : min_.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t GetMax() const{
+    return max_.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t GetMean() const{
+    std::uint64_t count = GetCount();
+    return count == 0 ? 0 : sum_.load(std::memory_order_relaxed) / count;
+  }
+
+  // the value that fraction of the values are at or below, as the highest value of its bucket
+  std::uint64_t GetValueAtFraction(double fraction) const{
+    std::uint64_t count = GetCount();
+    if(count == 0) return 0;
+    std::uint64_t rank = static_cast<std::uint64_t>(fraction * count + 0.5);
+    if(rank == 0) rank = 1;
+    std::uint64_t seen = 0;
+    std::uint64_t max = GetMax();
+    for(std::size_t i = 0; i < kBuckets; ++i){
+      seen += counts_[i].load(std::memory_order_relaxed);
+      if(seen >= rank) return BucketHighest(i) < max ? BucketHighest(i) : max;
+    }
+    // recorded to while read
+    return max;
+  }
+
+  static std::size_t BucketOf(std::uint64_t value){
+    if(value < kSubBuckets) return static_cast<std::size_t>(value);
+    int top_bit = 63 - __builtin_clzll(value);
+    int shift = top_bit - (kSubBucketBits - 1);
+    return static_cast<std::size_t>(kSubBuckets + (shift - 1) * kHalfSubBuckets + ((value >> shift) - kHalfSubBuckets));
+  }
+
+  static std::uint64_t BucketLowest(std::size_t bucket){
+    if(bucket < kSubBuckets) return bucket;
+    std::size_t above = bucket - kSubBuckets;
+    int shift = static_cast<int>(above / kHalfSubBuckets) + 1;
+    return (above % kHalfSubBuckets + kHalfSubBuckets) << shift;
+  }
+
+  static std::uint64_t BucketHighest(std::size_t bucket){
+    if(bucket < kSubBuckets) return bucket;
+    int shift = static_cast<int>((bucket - kSubBuckets) / kHalfSubBuckets) + 1;
+    return BucketLowest(bucket) + ((std::uint64_t(1) << shift) - 1);
+  }
+
+private:
+  std::atomic<std::uint64_t> counts_[kBuckets];
+  std::atomic<std::uint64_t> count_{0};
+  std::atomic<std::uint64_t> sum_{0};
+  std::atomic<std::uint64_t> min_{std::numeric_limits<std::uint64_t>::max()};
+  std::atomic<std::uint64_t> max_{0};
+};
+
+class EventCounter{
+public:
+  void Add(std::uint64_t n = 1){
+    if(kInstrumented) count_.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  std::uint64_t Get() const{
+    return count_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<std::uint64_t> count_{0};
+};
+
+// records the nanoseconds from its making to its end into the histogram
+class ScopedTimer{
+public:
+  explicit ScopedTimer(LatencyHistogram & histogram):
+    histogram_(histogram){
+    if(kInstrumented) start_ = std::chrono::steady_clock::now();
+  }
+
+  ~ScopedTimer(){
+    if(!kInstrumented) return;
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+    histogram_.Record(static_cast<std::uint64_t>(ns));
+  }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer & operator=(const ScopedTimer &) = delete;
+
+private:
+  LatencyHistogram & histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+#endif  // UTILS_HISTOGRAM_H_
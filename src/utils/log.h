@@ -0,0 +1,482 @@
+//
+// Buffered logging: a thread writes its records into a ring of its own, a background thread formats and writes them.
+//
+
+#ifndef UTILS_LOG_H_
+#define UTILS_LOG_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "client/client_common.h"
+
+enum class LogLevel : unsigned char{
+  kTrace,
+  kDebug,
+  kInfo,
+  kWarning,
+  kError
+};
+
+// records below this level are compiled out, -DBATTLESHIP_LOG_LEVEL=2 keeps info and up.
+// the default keeps everything, the probability trace included, the headless mains default to 2.
+#ifndef BATTLESHIP_LOG_LEVEL
+#define BATTLESHIP_LOG_LEVEL 0
+#endif
+
+static const LogLevel kCompiledLogLevel = static_cast<LogLevel>(BATTLESHIP_LOG_LEVEL);
+
+// a constant once inlined, a call below the compiled level goes away with its record
+static bool IsLogged(LogLevel level){
+  return level >= kCompiledLogLevel;
+}
+
+enum class LogFormat{
+  // the lines as they always were
+  kText,
+  // one json object a line
+  kJson
+};
+
+static std::string LogLevelToString(const LogLevel level){
+  switch(level){
+    case LogLevel::kTrace:{
+      return "trace";
+    }
+    case LogLevel::kDebug:{
+      return "debug";
+    }
+    case LogLevel::kInfo:{
+      return "info";
+    }
+    case LogLevel::kWarning:{
+      return "warning";
+    }
+    case LogLevel::kError:{
+      return "error";
+    }
+    default:{
+      return "unknown";
+    }
+  }
+}
+
+namespace logging{
+  enum class RecordKind : unsigned char{
+    kText,
+    kProbability,
+    kResult,
+    kLatency,
+    kCounter
+  };
+
+  // every record starts with it, the payload follows
+  struct RecordHeader{
+    RecordKind kind;
+    LogLevel level;
+    std::uint16_t length;
+  };
+
+  struct ProbabilityRecord{
+    std::uint64_t location;
+    std::uint64_t probability;
+  };
+
+  struct ResultRecord{
+    ClientId cli_id;
+    GameId game_id;
+    std::uint64_t num_moves;
+    bool does_win;
+  };
+
+  // the longest name of a histogram or counter, with its terminating zero
+  static const std::size_t kMetricNameLength = 40;
+
+  // a histogram of one game, in nanoseconds
+  struct LatencyRecord{
+    ClientId cli_id;
+    GameId game_id;
+    char name[kMetricNameLength];
+    std::uint64_t count;
+    std::uint64_t mean;
+    std::uint64_t min;
+    std::uint64_t p50;
+    std::uint64_t p90;
+    std::uint64_t p99;
+    std::uint64_t max;
+  };
+
+  struct CounterRecord{
+    ClientId cli_id;
+    GameId game_id;
+    char name[kMetricNameLength];
+    std::uint64_t value;
+  };
+
+  // Records of one thread, written by it and read by the flusher, nothing else touches it.
+  // tail_ is only moved by the writer and head_ by the reader, each publishing what it is done with.
+  class LogBuffer{
+  public:
+    static const std::size_t kCapacity = 1 << 16;
+
+    // false if the record doesn't fit now, the writer has to wait for the flusher
+    bool TryWrite(const RecordHeader & header, const void* payload){
+      std::size_t tail = tail_.load(std::memory_order_relaxed);
+      std::size_t length = sizeof(RecordHeader) + header.length;
+      if(kCapacity - (tail - head_.load(std::memory_order_acquire)) < length) return false;
+      Copy(tail, &header, sizeof(RecordHeader));
+      Copy(tail + sizeof(RecordHeader), payload, header.length);
+      tail_.store(tail + length, std::memory_order_release);
+      return true;
+    }
+
+    // handler(const RecordHeader &, const unsigned char* payload) for every record written so far
+    template<typename Handler>
+    void Drain(Handler handler){
+      std::size_t head = head_.load(std::memory_order_relaxed);
+      std::size_t tail = tail_.load(std::memory_order_acquire);
+      unsigned char payload[1 << 16];
+      while(head != tail){
+        RecordHeader header;
+        Read(head, &header, sizeof(RecordHeader));
+        Read(head + sizeof(RecordHeader), payload, header.length);
+        handler(header, payload);
+        head += sizeof(RecordHeader) + header.length;
+      }
+      head_.store(head, std::memory_order_release);
+    }
+
+    bool IsEmpty() const{
+      return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    // the thread is gone, the buffer goes once drained
+    void Retire(){
+      retired_.store(true, std::memory_order_release);
+    }
+
+    bool IsRetired() const{
+      return retired_.load(std::memory_order_acquire);
+    }
+
+  private:
+    static const std::size_t kMask = kCapacity - 1;
+
+    unsigned char ring_[kCapacity];
+    std::atomic<std::size_t> head_{0};
+    std::atomic<std::size_t> tail_{0};
+    std::atomic<bool> retired_{false};
+
+    void Copy(std::size_t at, const void* data, std::size_t length){
+      std::size_t start = at & kMask;
+      std::size_t first = std::min(length, kCapacity - start);
+      std::memcpy(ring_ + start, data, first);
+      std::memcpy(ring_, static_cast<const unsigned char*>(data) + first, length - first);
+    }
+
+    void Read(std::size_t at, void* data, std::size_t length) const{
+      std::size_t start = at & kMask;
+      std::size_t first = std::min(length, kCapacity - start);
+      std::memcpy(data, ring_ + start, first);
+      std::memcpy(static_cast<unsigned char*>(data) + first, ring_, length - first);
+    }
+  };
+
+  // Owns the buffers of all threads and the thread flushing them. Writing a record only copies it
+  // into the buffer of the calling thread, formatting and the write to stdout happen on the flusher,
+  // a batch at a time. Only a thread logging for the first time takes the lock, to add its buffer.
+  class LogSink{
+  public:
+    static LogSink & Get(){
+      static LogSink sink;
+      return sink;
+    }
+
+    ~LogSink(){
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+      }
+      wake_.notify_one();
+      flusher_.join();
+      FlushAll();
+    }
+
+    void Write(const RecordHeader & header, const void* payload){
+      LogBuffer* buffer = GetThreadBuffer();
+      while(!buffer->TryWrite(header, payload)){
+        // full, the flusher makes room
+        wake_.notify_one();
+        std::this_thread::yield();
+      }
+    }
+
+    void SetFormat(LogFormat format){
+      format_.store(format, std::memory_order_relaxed);
+    }
+
+    void SetOutput(std::FILE* output){
+      std::lock_guard<std::mutex> lock(flush_mutex_);
+      output_ = output;
+    }
+
+    // everything logged so far by any thread is written once this returns
+    void Flush(){
+      std::lock_guard<std::mutex> lock(flush_mutex_);
+      FlushAll();
+    }
+
+  private:
+    // how long the flusher sleeps between batches, unless a full buffer wakes it
+    static const int kFlushIntervalMs = 5;
+    // formatted lines are written out in pieces of about this many bytes
+    static const std::size_t kWriteLength = 1 << 16;
+    // a thread or two more than the threads of a simulation, before flushing_ grows
+    static const std::size_t kExpectedThreads = 64;
+
+    // marks the buffer of a thread retired when the thread ends
+    struct ThreadBuffer{
+      LogBuffer* buffer = nullptr;
+
+      ~ThreadBuffer(){
+        if(buffer) buffer->Retire();
+      }
+    };
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopped_ = false;
+    std::vector<std::unique_ptr<LogBuffer>> buffers_;
+    std::atomic<LogFormat> format_{LogFormat::kText};
+    // one flush at a time, the flusher's or a caller's, the output only changes between them
+    std::mutex flush_mutex_;
+    std::FILE* output_ = stdout;
+    // kept between flushes, a flush allocates nothing once they are grown
+    std::vector<LogBuffer*> flushing_;
+    std::string out_;
+    std::thread flusher_;
+
+    LogSink(){
+      flushing_.reserve(kExpectedThreads);
+      // a piece and the longest record, json escaped
+      out_.reserve(kWriteLength + 6 * (1 << 16));
+      flusher_ = std::thread([this](){
+        // a copy, a reference to the constant would need a definition of it
+        const int interval_ms = kFlushIntervalMs;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while(!stopped_){
+          wake_.wait_for(lock, std::chrono::milliseconds(interval_ms));
+          lock.unlock();
+          Flush();
+          lock.lock();
+        }
+      });
+    }
+
+    LogBuffer* GetThreadBuffer(){
+      thread_local ThreadBuffer thread_buffer;
+      if(!thread_buffer.buffer){
+        std::unique_ptr<LogBuffer> buffer(new LogBuffer());
+        thread_buffer.buffer = buffer.get();
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffers_.push_back(std::move(buffer));
+      }
+      return thread_buffer.buffer;
+    }
+
+    void FlushAll(){
+      flushing_.clear();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // a retired buffer was drained the last time if it is empty now, its thread writes no more
+        for(auto it = buffers_.begin(); it != buffers_.end();){
+          if((*it)->IsRetired() && (*it)->IsEmpty()){
+            it = buffers_.erase(it);
+            continue;
+          }
+          flushing_.push_back(it->get());
+          ++it;
+        }
+      }
+      LogFormat format = format_.load(std::memory_order_relaxed);
+      for(LogBuffer* buffer : flushing_){
+        buffer->Drain([this, format](const RecordHeader & header, const unsigned char* payload){
+          Format(format, header, payload);
+          if(out_.size() >= kWriteLength) WriteOut();
+        });
+      }
+      if(out_.empty()) return;
+      WriteOut();
+      std::fflush(output_);
+    }
+
+    void WriteOut(){
+      std::fwrite(out_.data(), 1, out_.size(), output_);
+      out_.clear();
+    }
+
+    void Format(LogFormat format, const RecordHeader & header, const unsigned char* payload){
+      bool json = format == LogFormat::kJson;
+      if(json){
+        out_ += "{\"level\":\"";
+        out_ += LogLevelToString(header.level);
+        out_ += "\",";
+      }
+      switch(header.kind){
+        case RecordKind::kText:{
+          const char* text = reinterpret_cast<const char*>(payload);
+          if(json){
+            out_ += "\"message\":\"";
+            AppendEscaped(text, header.length);
+            out_ += "\"";
+          }else{
+            out_.append(text, header.length);
+          }
+          break;
+        }
+        case RecordKind::kProbability:{
+          ProbabilityRecord record;
+          std::memcpy(&record, payload, sizeof(record));
+          out_ += json ? "\"location\":" : "";
+          AppendNumber(record.location);
+          out_ += json ? ",\"probability\":" : ",";
+          AppendNumber(record.probability);
+          break;
+        }
+        case RecordKind::kResult:{
+          ResultRecord record;
+          std::memcpy(&record, payload, sizeof(record));
+          out_ += json ? "\"client\":" : "";
+          AppendNumber(record.cli_id);
+          out_ += json ? ",\"game\":" : ",";
+          AppendNumber(record.game_id);
+          if(json){
+            out_ += record.does_win ? ",\"win\":true,\"moves\":" : ",\"win\":false,\"moves\":";
+          }else{
+            out_ += record.does_win ? ",win," : ",lose,";
+          }
+          AppendNumber(record.num_moves);
+          break;
+        }
+        case RecordKind::kLatency:{
+          LatencyRecord record;
+          std::memcpy(&record, payload, sizeof(record));
+          AppendMetricName(json, record.cli_id, record.game_id, "latency", record.name);
+          const std::uint64_t values[] = {record.count, record.mean, record.min, record.p50, record.p90, record.p99, record.max};
+          const char* const names[] = {"count", "mean_ns", "min_ns", "p50_ns", "p90_ns", "p99_ns", "max_ns"};
+          for(std::size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i){
+            if(json){
+              out_ += ",\"";
+              out_ += names[i];
+              out_ += "\":";
+            }else{
+              out_ += ',';
+            }
+            AppendNumber(values[i]);
+          }
+          break;
+        }
+        case RecordKind::kCounter:{
+          CounterRecord record;
+          std::memcpy(&record, payload, sizeof(record));
+          AppendMetricName(json, record.cli_id, record.game_id, "counter", record.name);
+          out_ += json ? ",\"value\":" : ",";
+          AppendNumber(record.value);
+          break;
+        }
+        default:{
+          assert(false);
+        }
+      }
+      out_ += json ? "}\n" : "\n";
+    }
+
+    void AppendNumber(std::uint64_t number){
+      char digits[20];
+      std::size_t n = 0;
+      do{
+        digits[n++] = static_cast<char>('0' + number % 10);
+        number /= 10;
+      }while(number > 0);
+      while(n > 0){
+        out_ += digits[--n];
+      }
+    }
+
+    // the client, the game and what it is, as "1,2,latency,name" or "client":1,"game":2,"latency":"name"
+    void AppendMetricName(bool json, ClientId cli_id, GameId game_id, const char* kind, const char* name){
+      out_ += json ? "\"client\":" : "";
+      AppendNumber(cli_id);
+      out_ += json ? ",\"game\":" : ",";
+      AppendNumber(game_id);
+      out_ += json ? ",\"" : ",";
+      out_ += kind;
+      std::size_t length = strnlen(name, kMetricNameLength);
+      if(json){
+        out_ += "\":\"";
+        AppendEscaped(name, length);
+        out_ += "\"";
+      }else{
+        out_ += ',';
+        out_.append(name, length);
+      }
+    }
+
+    // as a json string would have it
+    void AppendEscaped(const char* text, std::size_t length){
+      for(std::size_t i = 0; i < length; ++i){
+        char c = text[i];
+        if(c == '"' || c == '\\'){
+          out_ += '\\';
+          out_ += c;
+        }else if(static_cast<unsigned char>(c) < 0x20){
+          char code[8];
+          std::snprintf(code, sizeof(code), "\\u%04x", c);
+          out_ += code;
+        }else{
+          out_ += c;
+        }
+      }
+    }
+  };
+
+  template<typename Record>
+  static void WriteRecord(RecordKind kind, LogLevel level, const Record & record){
+    RecordHeader header{kind, level, static_cast<std::uint16_t>(sizeof(Record))};
+    LogSink::Get().Write(header, &record);
+  }
+}
+
+static void LogText(LogLevel level, const std::string & what){
+  if(!IsLogged(level)) return;
+  std::size_t length = std::min<std::size_t>(what.size(), 0xFFFF - sizeof(logging::RecordHeader));
+  logging::RecordHeader header{logging::RecordKind::kText, level, static_cast<std::uint16_t>(length)};
+  logging::LogSink::Get().Write(header, what.data());
+}
+
+static void SetLogFormat(LogFormat format){
+  logging::LogSink::Get().SetFormat(format);
+}
+
+// stdout unless set, what was logged before goes to the output of then
+static void SetLogOutput(std::FILE* output){
+  logging::LogSink::Get().Flush();
+  logging::LogSink::Get().SetOutput(output);
+}
+
+// wait until everything logged so far is written, before writing to stdout past the logger
+static void FlushLog(){
+  logging::LogSink::Get().Flush();
+}
+
+#endif  // UTILS_LOG_H_
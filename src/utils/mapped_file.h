@@ -0,0 +1,83 @@
+//
+// A file mapped read only into memory, read in place without copying it.
+//
+
+#ifndef UTILS_MAPPED_FILE_H_
+#define UTILS_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// The pages are read from the file as they are touched, so the file may be much bigger than memory.
+// Once a range was read, Release lets the kernel drop its pages first, before the ones still to come.
+class MappedFile{
+public:
+  MappedFile(){}
+
+  ~MappedFile(){
+    Close();
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile & operator=(const MappedFile &) = delete;
+
+  // false if the file can't be opened or mapped, an empty file maps to nothing but opens
+  bool Open(const std::string & path){
+    Close();
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+    struct stat info;
+    if(fstat(fd, &info) != 0){
+      close(fd);
+      return false;
+    }
+    length_ = static_cast<std::size_t>(info.st_size);
+    if(length_ > 0){
+      void* data = mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(data == MAP_FAILED){
+        close(fd);
+        length_ = 0;
+        return false;
+      }
+      data_ = static_cast<const unsigned char*>(data);
+      // read ahead more than usual
+      madvise(const_cast<unsigned char*>(data_), length_, MADV_SEQUENTIAL);
+    }
+    // the mapping keeps the file
+    close(fd);
+    return true;
+  }
+
+  void Close(){
+    if(data_ != nullptr) munmap(const_cast<unsigned char*>(data_), length_);
+    data_ = nullptr;
+    length_ = 0;
+  }
+
+  const unsigned char* GetData() const{
+    return data_;
+  }
+
+  std::size_t GetLength() const{
+    return length_;
+  }
+
+  // the whole pages in [offset, offset + length) are not needed for now, touching them again reads them again
+  void Release(std::size_t offset, std::size_t length) const{
+    std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::size_t begin = (offset + page - 1) / page * page;
+    std::size_t end = (offset + length) / page * page;
+    if(data_ == nullptr || begin >= end) return;
+    madvise(const_cast<unsigned char*>(data_) + begin, end - begin, MADV_DONTNEED);
+  }
+
+private:
+  const unsigned char* data_ = nullptr;
+  std::size_t length_ = 0;
+};
+
+#endif  // UTILS_MAPPED_FILE_H_
@@ -0,0 +1,246 @@
+//
+// Work-stealing thread pool.
+//
+
+#ifndef UTILS_THREAD_POOL_H_
+#define UTILS_THREAD_POOL_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// every worker owns a deque of tasks. a worker pops its own deque from the back
+// and, when that is empty, steals from the front of the other deques, so the
+// only contention is between a thief and its victim.
+class ThreadPool{
+public:
+  typedef std::function<void()> Task;
+
+  // num_threads == 0 means one worker per hardware thread
+  explicit ThreadPool(size_t num_threads = 0){
+    if(num_threads == 0) num_threads = std::thread::hardware_concurrency();
+    if(num_threads == 0) num_threads = 1;
+
+    for(size_t i = 0; i < num_threads; ++i){
+      queues_.emplace_back(new WorkQueue());
+    }
+    for(size_t i = 0; i < num_threads; ++i){
+      threads_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+  }
+
+  ~ThreadPool(){
+    {
+      std::lock_guard<std::mutex> lock(wake_mutex_);
+      stop_ = true;
+    }
+    wake_cv_.notify_all();
+    for(auto & thread : threads_){
+      thread.join();
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool & operator=(const ThreadPool &) = delete;
+
+  // a worker submits to its own deque, any other thread spreads tasks round robin
+  void Submit(Task task){
+    size_t index = CurrentWorkerIndex();
+    if(index >= queues_.size()){
+      index = next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    }
+
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    queued_.fetch_add(1, std::memory_order_release);
+    {
+      std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+      queues_[index]->tasks.push_back(std::move(task));
+    }
+    {
+      // an empty critical section, so a worker can't miss the notify between
+      // checking queued_ and going to sleep
+      std::lock_guard<std::mutex> lock(wake_mutex_);
+    }
+    wake_cv_.notify_one();
+  }
+
+  // block until every submitted task has finished,
+  // the calling thread runs queued tasks while it waits.
+  void Wait(){
+    while(pending_.load(std::memory_order_acquire) > 0){
+      if(!RunOneTask()){
+        std::unique_lock<std::mutex> lock(done_mutex_);
+        done_cv_.wait_for(lock, std::chrono::milliseconds(1), [this]{
+          return pending_.load(std::memory_order_acquire) == 0;
+        });
+      }
+    }
+  }
+
+  // run one queued task on the calling thread, false if there was none
+  bool RunOneTask(){
+    return TryRunOne(CurrentWorkerIndex());
+  }
+
+  size_t GetThreadNum() const{
+    return threads_.size();
+  }
+
+private:
+  struct WorkQueue{
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  static const size_t kNotAWorker = static_cast<size_t>(-1);
+
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  std::vector<std::thread> threads_;
+
+  std::atomic<size_t> next_queue_{0};
+  // submitted but not finished
+  std::atomic<size_t> pending_{0};
+
+  // submitted but not started
+  std::atomic<size_t> queued_{0};
+  // guarded by wake_mutex_
+  bool stop_ = false;
+  std::mutex wake_mutex_;
+  std::condition_variable wake_cv_;
+
+  std::mutex done_mutex_;
+  std::condition_variable done_cv_;
+
+  // the pool and worker index of this thread, a worker of one pool is an outsider to the others
+  struct WorkerSlot{
+    const ThreadPool* pool;
+    size_t index;
+  };
+
+  static WorkerSlot & CurrentWorker(){
+    thread_local WorkerSlot slot = {nullptr, kNotAWorker};
+    return slot;
+  }
+
+  // index of the worker running on this thread, kNotAWorker for outsiders
+  size_t CurrentWorkerIndex() const{
+    const WorkerSlot & slot = CurrentWorker();
+    return slot.pool == this ? slot.index : kNotAWorker;
+  }
+
+  void WorkerLoop(size_t index){
+    CurrentWorker().pool = this;
+    CurrentWorker().index = index;
+    while(true){
+      if(TryRunOne(index)) continue;
+
+      std::unique_lock<std::mutex> lock(wake_mutex_);
+      wake_cv_.wait(lock, [this]{ return stop_ || queued_.load(std::memory_order_acquire) > 0; });
+      if(stop_ && queued_.load(std::memory_order_acquire) == 0) return;
+    }
+  }
+
+  // pop from the back of our own deque first, then steal from the front of the others
+  bool TryRunOne(size_t index){
+    Task task;
+    if(index < queues_.size() && PopBack(*queues_[index], &task)){
+      Run(task);
+      return true;
+    }
+
+    size_t start = index < queues_.size() ? index + 1 : 0;
+    for(size_t i = 0; i < queues_.size(); ++i){
+      WorkQueue & victim = *queues_[(start + i) % queues_.size()];
+      if(PopFront(victim, &task)){
+        Run(task);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool PopBack(WorkQueue & queue, Task* task){
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(queue.tasks.empty()) return false;
+    *task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+  }
+
+  bool PopFront(WorkQueue & queue, Task* task){
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(queue.tasks.empty()) return false;
+    *task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+  }
+
+  void Run(Task & task){
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    if(pending_.fetch_sub(1, std::memory_order_acq_rel) == 1){
+      std::lock_guard<std::mutex> lock(done_mutex_);
+      done_cv_.notify_all();
+    }
+  }
+};
+
+// a set of tasks on a shared pool that can be waited for on its own,
+// while other users keep submitting to the same pool
+class TaskGroup{
+public:
+  explicit TaskGroup(ThreadPool & pool):
+    pool_(pool){
+  }
+
+  ~TaskGroup(){
+    Wait();
+  }
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup & operator=(const TaskGroup &) = delete;
+
+  void Submit(ThreadPool::Task task){
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_ += 1;
+    }
+    pool_.Submit([this, task](){
+      task();
+      // the group may be gone as soon as the lock is released
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_ -= 1;
+      if(pending_ == 0) done_cv_.notify_all();
+    });
+  }
+
+  // block until every task of the group has finished,
+  // the calling thread runs queued tasks of the pool while it waits.
+  void Wait(){
+    while(true){
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(pending_ == 0) return;
+      }
+      if(!pool_.RunOneTask()){
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait_for(lock, std::chrono::milliseconds(1), [this]{ return pending_ == 0; });
+      }
+    }
+  }
+
+private:
+  ThreadPool & pool_;
+  // guarded by mutex_
+  size_t pending_ = 0;
+  std::mutex mutex_;
+  std::condition_variable done_cv_;
+};
+
+#endif  // UTILS_THREAD_POOL_H_
@@ -0,0 +1,65 @@
+//
+// Triple buffer: one thread publishes values, another reads the latest of them, neither waits.
+//
+
+#ifndef UTILS_TRIPLE_BUFFER_H_
+#define UTILS_TRIPLE_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+
+// Three slots: the writer fills its back slot, the reader reads its front slot, and the third is
+// the one published last. Publishing swaps the back with the middle, taking the latest swaps the
+// front with the middle, each an atomic exchange of one index. A slot is never touched by both
+// threads at once, so T needs no synchronization of its own, and neither side ever blocks: the
+// writer overwrites what the reader didn't take in time, the reader keeps its front until there
+// is a newer one.
+template<typename T>
+class TripleBuffer{
+public:
+  TripleBuffer():
+    middle_(kMiddle){
+  }
+
+  // writer only, the slot to fill before Publish. it holds what was published two times ago
+  T & GetBack(){
+    return slots_[back_].value;
+  }
+
+  // writer only, hands the back slot over to the reader
+  void Publish(){
+    back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndexMask;
+  }
+
+  // reader only, makes the latest published value the front one. false if there is none newer
+  bool Update(){
+    if(!(middle_.load(std::memory_order_relaxed) & kFresh)) return false;
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+    return true;
+  }
+
+  // reader only, stays the same until the next Update
+  const T & GetFront() const{
+    return slots_[front_].value;
+  }
+
+private:
+  static const unsigned kFront = 0;
+  static const unsigned kMiddle = 1;
+  static const unsigned kBack = 2;
+  static const unsigned kIndexMask = 3;
+  // the middle slot was published and not yet taken
+  static const unsigned kFresh = 4;
+
+  // each on a cache line of its own, the two threads don't share lines while copying
+  struct alignas(64) Slot{
+    T value;
+  };
+
+  Slot slots_[3];
+  alignas(64) std::atomic<unsigned> middle_;
+  alignas(64) unsigned back_ = kBack;
+  alignas(64) unsigned front_ = kFront;
+};
+
+#endif  // UTILS_TRIPLE_BUFFER_H_
@@ -6,19 +6,56 @@
 #include <iostream>
 #include <string>
 #include <cassert>
+#include "client/client_common.h"
+#include "utils/histogram.h"
+#include "utils/log.h"
 
 // uncomment to disable assert()
 // #define NDEBUG
 
 static void Logger(const std::string & what){
-  std::cout << what << std::endl;
+  LogText(LogLevel::kInfo, what);
+}
+
+static void LogDebug(const std::string & what){
+  LogText(LogLevel::kDebug, what);
+}
+
+// a few words copied into the buffer of the thread, formatted on the flusher
+static void LogProbability(size_t location, size_t probability){
+  if(!IsLogged(LogLevel::kTrace)) return;
+  logging::WriteRecord(logging::RecordKind::kProbability, LogLevel::kTrace, logging::ProbabilityRecord{location, probability});
 }
 
 static void LogResult(ClientId cli_id, GameId game_id, bool does_win, size_t num_moves){
-  std::cout << cli_id << ","
-            << game_id << ","
-            << (does_win ? "win" : "lose") << ","
-            << num_moves << std::endl;
+  if(!IsLogged(LogLevel::kInfo)) return;
+  logging::WriteRecord(logging::RecordKind::kResult, LogLevel::kInfo, logging::ResultRecord{cli_id, game_id, num_moves, does_win});
+}
+
+// names longer than logging::kMetricNameLength - 1 are cut
+static void LogLatency(ClientId cli_id, GameId game_id, const std::string & name, const LatencyHistogram & histogram){
+  if(!IsLogged(LogLevel::kInfo)) return;
+  logging::LatencyRecord record{};
+  record.cli_id = cli_id;
+  record.game_id = game_id;
+  name.copy(record.name, logging::kMetricNameLength - 1);
+  record.count = histogram.GetCount();
+  record.mean = histogram.GetMean();
+  record.min = histogram.GetMin();
+  record.p50 = histogram.GetValueAtFraction(0.5);
+  record.p90 = histogram.GetValueAtFraction(0.9);
+  record.p99 = histogram.GetValueAtFraction(0.99);
+  record.max = histogram.GetMax();
+  logging::WriteRecord(logging::RecordKind::kLatency, LogLevel::kInfo, record);
+}
 
+static void LogCounter(ClientId cli_id, GameId game_id, const std::string & name, std::uint64_t value){
+  if(!IsLogged(LogLevel::kInfo)) return;
+  logging::CounterRecord record{};
+  record.cli_id = cli_id;
+  record.game_id = game_id;
+  name.copy(record.name, logging::kMetricNameLength - 1);
+  record.value = value;
+  logging::WriteRecord(logging::RecordKind::kCounter, LogLevel::kInfo, record);
 }
 #endif  // UTILS_UTILS_H_
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include "client/client_brain.h"
+#include "core/game/board.h"
+
+// every heap allocation of the program goes through here
+static std::atomic<size_t> allocation_num(0);
+
+void* operator new(std::size_t size){
+  allocation_num.fetch_add(1, std::memory_order_relaxed);
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if(p == nullptr) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept{
+  std::free(p);
+}
+
+struct MoveStats{
+  size_t games = 0;
+  size_t moves = 0;
+  size_t placing_allocations = 0;
+  size_t move_allocations = 0;
+  double seconds = 0;
+};
+
+// one game of the AI against a randomly placed fleet, counting the allocations of
+// placing its own ships and of deciding on and digesting every shot
+void play_one_game(StrategyAttack strategy, MoveStats* stats){
+  Board enemy_fleet;
+  ShipPlacementUnit placement_unit;
+  for(auto placement : placement_unit.ShipPlacingPlan(StrategyPlaceShip::kRandom)){
+    bool success = enemy_fleet.PlaceAShip(placement.type, placement.head_location, placement.direction);
+    assert(success);
+  }
+
+  Board my_board;
+  ClientBrain brain(my_board);
+
+  size_t before = allocation_num.load();
+  ShipPlacingPlanList plan = brain.GenerateShipPlacingPlan(StrategyPlaceShip::kRandom);
+  stats->placing_allocations += allocation_num.load() - before;
+  for(auto placement : plan){
+    bool success = my_board.PlaceAShip(placement.type, placement.head_location, placement.direction);
+    assert(success);
+  }
+
+  while(true){
+    auto start = std::chrono::high_resolution_clock::now();
+    before = allocation_num.load();
+    size_t location = brain.GenerateNextAttackLocation(strategy);
+    AttackResult res = enemy_fleet.Attack(location);
+    brain.DigestAttackResult(res);
+    stats->move_allocations += allocation_num.load() - before;
+    stats->seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    stats->moves += 1;
+    if(res.attacker_win) break;
+  }
+  stats->games += 1;
+}
+
+// Monte Carlo hands its batches to the pool, which queues std::function tasks, so it is left out
+void test_ai_moves_do_not_allocate(){
+  std::cout << "test_ai_moves_do_not_allocate" << std::endl;
+  const StrategyAttack strategies[] = {StrategyAttack::kRandom, StrategyAttack::kDFS,
+                                       StrategyAttack::kProbabilitySimple, StrategyAttack::kDFSProbability};
+  // the first game grows the workspaces of the thread
+  MoveStats warm_up;
+  play_one_game(StrategyAttack::kProbabilitySimple, &warm_up);
+
+  for(StrategyAttack strategy : strategies){
+    MoveStats stats;
+    for(size_t g = 0; g < 50; ++g){
+      play_one_game(strategy, &stats);
+    }
+    std::cerr << StrategyAttackToString(strategy) << ": " << stats.games << " games, " << stats.moves << " moves, "
+              << stats.move_allocations << " allocations in moves, " << stats.placing_allocations
+              << " in placing ships, " << stats.seconds / stats.moves * 1e6 << "us per move" << std::endl;
+    assert(stats.move_allocations == 0);
+    assert(stats.placing_allocations == 0);
+  }
+}
+
+int main(int argc, char** argv){
+  test_ai_moves_do_not_allocate();
+  return 0;
+}
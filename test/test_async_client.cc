@@ -0,0 +1,134 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include "client/async_game_host.h"
+
+// a listener and an initiator in one process play games over loopback,
+// all of them at once over the connections on a two thread io_service.
+// returns the result of the initiator.
+AsyncHostResult play_over_loopback(size_t games, size_t connections, size_t batch, StrategyAttack attack){
+  asio::io_service io_service;
+
+  AsyncHostSetting listener_setting;
+  listener_setting.type = ClientType::kListener;
+  listener_setting.cli_id = 0;
+  listener_setting.connections = connections;
+  listener_setting.batch = batch;
+  listener_setting.attack = attack;
+  AsyncGameHost listener(io_service, listener_setting);
+  listener.Start();
+
+  AsyncHostSetting initiator_setting;
+  initiator_setting.type = ClientType::kInitiator;
+  initiator_setting.port = listener.GetPort();
+  initiator_setting.cli_id = 1;
+  initiator_setting.first_game_id = 100;
+  initiator_setting.games = games;
+  initiator_setting.connections = connections;
+  initiator_setting.batch = batch;
+  initiator_setting.attack = attack;
+  AsyncGameHost initiator(io_service, initiator_setting);
+  initiator.Start();
+
+  auto start = std::chrono::steady_clock::now();
+  AsyncGameHost::Run(io_service, 2);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  AsyncHostResult listener_res = listener.GetResult();
+  AsyncHostResult initiator_res = initiator.GetResult();
+  assert(listener_res.broken_off == 0 && initiator_res.broken_off == 0);
+  assert(listener_res.finished == games && initiator_res.finished == games);
+  // exactly one side wins every game
+  assert(listener_res.wins + initiator_res.wins == games);
+  // the initiator has the higher client id, so it fires first and fires once more than the listener when it wins
+  assert(initiator_res.moves == listener_res.moves + initiator_res.wins);
+  // every message written is one read by the other side
+  assert(initiator_res.written_frames + listener_res.written_frames == 2 * (games * 3 + listener_res.moves + initiator_res.moves));
+  assert(initiator_res.read_frames == listener_res.written_frames && listener_res.read_frames == initiator_res.written_frames);
+  std::cerr << games << " games in " << seconds << "s, " << initiator_res.wins << " won by the initiator, "
+            << static_cast<double>(initiator_res.written_frames) / initiator_res.writes << " messages per write, "
+            << static_cast<double>(initiator_res.read_frames) / initiator_res.reads << " messages per read" << std::endl;
+  return initiator_res;
+}
+
+void test_async_games_over_loopback(size_t games, size_t connections){
+  std::cout << "test_async_games_over_loopback " << games << " games over " << connections << " connections" << std::endl;
+  play_over_loopback(games, connections, AsyncConnection::kDefaultMaxBatch, StrategyAttack::kDFSProbability);
+}
+
+// Messages sent before the io_service runs are all in the outbox when the first write starts, so
+// they go out in one write. Messages the peer wrote before the connection reads come in with one read.
+void test_async_batched_writes(size_t frames){
+  std::cout << "test_async_batched_writes " << frames << std::endl;
+  assert(frames <= AsyncConnection::kDefaultMaxBatch && frames * kMaxBufferLength <= FrameDecoder::kCapacity);
+  std::vector<unsigned char> stream;
+  for(size_t i = 0; i < frames; ++i){
+    Frame frame;
+    MakeInfoReady(frame.data, &frame.length, 1, static_cast<GameId>(i));
+    stream.insert(stream.end(), frame.data, frame.data + frame.length);
+  }
+
+  {
+    asio::io_service io_service;
+    tcp::acceptor acceptor(io_service, tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    tcp::socket peer(io_service);
+    peer.connect(acceptor.local_endpoint());
+    auto connection = std::make_shared<AsyncConnection>(io_service);
+    acceptor.accept(connection->GetRefSocket());
+    connection->Start(nullptr);
+    size_t written = 0;
+    for(size_t i = 0; i < frames; ++i){
+      Frame frame;
+      MakeInfoReady(frame.data, &frame.length, 1, static_cast<GameId>(i));
+      connection->AsyncSend(frame, [&written](const asio::error_code & ec){
+        assert(!ec);
+        written += 1;
+      });
+    }
+    connection->CloseWhenIdle();
+    io_service.run();
+    assert(written == frames);
+    assert(connection->GetWriteNum() == 1 && connection->GetWrittenFrameNum() == frames);
+
+    std::vector<unsigned char> received(stream.size());
+    asio::read(peer, asio::buffer(received));
+    assert(received == stream);
+  }
+
+  {
+    asio::io_service io_service;
+    tcp::acceptor acceptor(io_service, tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    tcp::socket peer(io_service);
+    peer.connect(acceptor.local_endpoint());
+    auto connection = std::make_shared<AsyncConnection>(io_service);
+    acceptor.accept(connection->GetRefSocket());
+    // over loopback the whole stream is in the socket once the write returns
+    asio::write(peer, asio::buffer(stream));
+    peer.shutdown(tcp::socket::shutdown_send);
+    for(size_t i = 0; i < frames; ++i){
+      connection->Open(static_cast<GameId>(i));
+    }
+    connection->Start(nullptr);
+    io_service.run();
+    assert(connection->GetReadNum() == 1 && connection->GetReadFrameNum() == frames);
+  }
+}
+
+// with cheap moves the games wait on the wire and their messages pile up meanwhile, how many share
+// a write depends on the scheduling, so it is only reported
+void test_async_batched_games(size_t games){
+  std::cout << "test_async_batched_games " << games << std::endl;
+  AsyncHostResult one_by_one = play_over_loopback(games, 1, 1, StrategyAttack::kRandom);
+  assert(one_by_one.writes == one_by_one.written_frames);
+  play_over_loopback(games, 1, AsyncConnection::kDefaultMaxBatch, StrategyAttack::kRandom);
+}
+
+int main(int argc, char** argv){
+  test_async_games_over_loopback(1, 1);
+  test_async_games_over_loopback(200, 1);
+  test_async_games_over_loopback(200, 8);
+  test_async_games_over_loopback(200, 200);
+  test_async_batched_writes(32);
+  test_async_batched_games(500);
+  return 0;
+}
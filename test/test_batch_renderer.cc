@@ -0,0 +1,62 @@
+#include <iostream>
+#include <set>
+#include <string>
+#include <utility>
+#include "graphic/batch_renderer.h"
+
+// the atlas holds every glyph exactly as its points cover the screen when drawn one by one
+void test_glyph_atlas(){
+  std::cout << "test_glyph_atlas" << std::endl;
+  GlyphAtlas atlas;
+  const std::string chars = "abcdefghijklmnopqrstuvwxyz0123456789.,";
+  for(char c : chars){
+    std::set<std::pair<int, int>> covered;
+    PlotGlyph(c, 0, 0, [&covered](int x, int y){
+      for(int i = x - 2; i < x + 2; ++i){
+        for(int j = y - 2; j < y + 2; ++j){
+          covered.insert(std::make_pair(i, j));
+        }
+      }
+    });
+    assert(!covered.empty());
+    for(int i = 0; i < GlyphAtlas::kCellSize; ++i){
+      for(int j = 0; j < GlyphAtlas::kCellSize; ++j){
+        bool in_glyph = covered.count(std::make_pair(i - GlyphAtlas::kPadding, j - GlyphAtlas::kPadding)) > 0;
+        assert((atlas.GetAlpha(atlas.CellX(c) + i, atlas.CellY(c) + j) == 0xFF) == in_glyph);
+      }
+    }
+    assert(atlas.GetAdvance(c) == PlotGlyph(c, 0, 0, [](int, int){}));
+  }
+  assert(atlas.GetAdvance(' ') == 10);
+}
+
+// a frame is three batches whatever is drawn, later shapes in front of earlier ones
+void test_batch_renderer_frame(){
+  std::cout << "test_batch_renderer_frame" << std::endl;
+  BatchRenderer renderer;
+  renderer.BeginFrame();
+  renderer.FillRect(50, 50, 20, 10, 1, 1, 1);
+  renderer.StrokeRect(50, 50, 20, 10, 0, 0, 0);
+  renderer.Text("ab c", 100, 100, 1, 0, 0);
+  assert(renderer.GetFills().size() == 6);
+  assert(renderer.GetLines().size() == 8);
+  // the space is only an advance
+  assert(renderer.GetGlyphs().size() == 3 * 6);
+  assert(renderer.GetFills()[0].z < renderer.GetLines()[0].z);
+  assert(renderer.GetLines()[0].z < renderer.GetGlyphs()[0].z);
+  // where DrawString puts the first point of the text, less the padding of the point
+  assert(renderer.GetGlyphs()[0].x == 100 - 5 * 4 - GlyphAtlas::kPadding);
+  assert(renderer.GetGlyphs()[0].y == 100 - 3 - GlyphAtlas::kPadding);
+
+  // the next frame of the same size reuses the arrays
+  const BatchRenderer::Vertex* fills = renderer.GetFills().data();
+  renderer.BeginFrame();
+  renderer.FillRect(50, 50, 20, 10, 1, 1, 1);
+  assert(renderer.GetFills().data() == fills && renderer.GetGlyphs().empty());
+}
+
+int main(int argc, char** argv){
+  test_glyph_atlas();
+  test_batch_renderer_frame();
+  return 0;
+}
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include "ai/endgame_solver.h"
+#include "ai/probability_board.h"
+#include "ai/ship_placement_unit.h"
+#include "core/game/board.h"
+#include "test_games.h"
+
+// every layout one by one, ships of a type at increasing placement indexes, cells_left the cells of
+// the ships from cursor on
+void enumerate_layouts(const FleetConstraint & constraint, const std::vector<ShipType> & order, size_t cursor,
+                       size_t last, const BitBoard & taken, size_t cells_left, size_t* on_hits_num,
+                       double* layouts, double* total){
+  // the ships left can't cover the hits
+  if(constraint.hits.AndNot(taken).Count() > cells_left) return;
+  if(cursor == order.size()){
+    for(ShipType type : GetShipTypeList()){
+      if(on_hits_num[type] != constraint.sunk_num[type]) return;
+    }
+    *total += 1;
+    taken.ForEach([layouts](size_t location){
+      layouts[location] += 1;
+    });
+    return;
+  }
+
+  const PlacementMasks & masks = PlacementMasks::Get();
+  ShipType type = order[cursor];
+  bool same_as_last = cursor > 0 && order[cursor - 1] == type;
+  // this ship and the ones of its type after it
+  size_t type_left = std::count(order.begin() + cursor, order.end(), type);
+  for(size_t index = same_as_last ? last + 1 : 0; index < kDim * kDim * 2; ++index){
+    size_t head = index / 2;
+    Direction direction = index % 2 == 0 ? kVertical : kHorisontal;
+    if(!masks.InBound(type, head, direction)) continue;
+    const BitBoard & mask = masks.Mask(type, head, direction);
+    if(mask.Intersects(constraint.missed) || mask.Intersects(taken)) continue;
+    bool on_hits = !mask.AndNot(constraint.hits).Any();
+    // one more ship of the type fully on hits than sunk, or too few left to lie on the sunk ones
+    if(on_hits && on_hits_num[type] == constraint.sunk_num[type]) continue;
+    if(!on_hits && on_hits_num[type] + type_left == constraint.sunk_num[type]) continue;
+    if(on_hits) on_hits_num[type] += 1;
+    enumerate_layouts(constraint, order, cursor + 1, index, taken | mask, cells_left - GetSizeFromType(type),
+                      on_hits_num, layouts, total);
+    if(on_hits) on_hits_num[type] -= 1;
+  }
+}
+
+// positions of random games with at most `alive_left` ships alive
+template<typename F>
+void play_until_endgame(size_t games, size_t alive_left, F check){
+  play_random_games(games, [](ImagineBoard &){}, [alive_left, &check](ImagineBoard & enemy_board){
+    size_t alive_num = 0;
+    for(ShipType type : GetShipTypeList()) alive_num += enemy_board.GetAliveShipNumber(type);
+    if(alive_num <= alive_left) check(enemy_board);
+  });
+}
+
+// positions enumerated, the rest of the games is played but not checked
+const size_t kMaxEnumerated = 40;
+
+// the transposition table has to count exactly what going through every layout counts
+void test_endgame_solver_matches_enumeration(){
+  std::cout << "test_endgame_solver_matches_enumeration" << std::endl;
+  std::vector<ShipType> order;
+  for(ShipType type : GetShipTypeList()){
+    for(size_t i = 0; i < GetNumFromType(type); ++i) order.push_back(type);
+  }
+
+  size_t cells = 0;
+  for(ShipType type : order) cells += GetSizeFromType(type);
+
+  RandomUnit::Seed(7);
+  size_t checked = 0;
+  EndgameSolver solver;
+  play_until_endgame(30, 2, [&](ImagineBoard & enemy_board){
+    if(checked == kMaxEnumerated) return;
+    FleetConstraint constraint = FleetConstraint::FromEnemyBoard(enemy_board);
+    size_t solved[kDim * kDim];
+    double solved_total = 0;
+    if(!solver.Solve(constraint, solved, &solved_total)) return;
+
+    double layouts[kDim * kDim] = {};
+    double total = 0;
+    size_t on_hits_num[kShipTypeNum] = {};
+    enumerate_layouts(constraint, order, 0, 0, BitBoard(), cells, on_hits_num, layouts, &total);
+    assert(solved_total == total);
+    for(size_t i = 0; i < kDim * kDim; ++i){
+      assert(solved[i] == static_cast<size_t>(layouts[i]));
+    }
+    checked += 1;
+  });
+  std::cout << checked << " positions identical" << std::endl;
+  assert(checked > 0);
+}
+
+// with the solver on, the incremental update still ends up where a full recalculation does
+void test_endgame_incremental_update(){
+  std::cout << "test_endgame_incremental_update" << std::endl;
+  RandomUnit::Seed(11);
+  size_t checked = 0;
+  std::unique_ptr<ProbabilityBoard> up_incremental;
+  play_random_games(30, [&up_incremental](ImagineBoard & enemy_board){
+    up_incremental.reset(new ProbabilityBoard(enemy_board));
+    up_incremental->EnableEndgameSolver(EndgameSetting());
+  }, [&up_incremental, &checked](ImagineBoard & enemy_board){
+    up_incremental->UpdateProbabilityByLastAttackLocation();
+    ProbabilityBoard full_board(enemy_board);
+    full_board.EnableEndgameSolver(EndgameSetting());
+    full_board.RecalculateProbability();
+    for(size_t i = 0; i < kDim * kDim; ++i){
+      assert(up_incremental->GetProbability(i) == full_board.GetProbability(i));
+    }
+    checked += 1;
+  });
+  std::cout << checked << " positions identical" << std::endl;
+}
+
+void test_endgame_solver_speed(){
+  std::cout << "test_endgame_solver_speed" << std::endl;
+  size_t solved = 0;
+  size_t positions = 0;
+  double seconds = 0;
+  RandomUnit::Seed(13);
+  EndgameSolver solver;
+  play_until_endgame(30, 4, [&](ImagineBoard & enemy_board){
+    FleetConstraint constraint = FleetConstraint::FromEnemyBoard(enemy_board);
+    size_t layouts[kDim * kDim];
+    auto start = std::chrono::high_resolution_clock::now();
+    if(solver.Solve(constraint, layouts)) solved += 1;
+    seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    positions += 1;
+  });
+  std::cout << solved << " of " << positions << " positions with at most 4 ships alive solved, "
+            << seconds / positions * 1e6 << "us per position" << std::endl;
+}
+
+int main(int argc, char** argv){
+  test_endgame_solver_matches_enumeration();
+  test_endgame_incremental_update();
+  test_endgame_solver_speed();
+  return 0;
+}
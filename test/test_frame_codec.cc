@@ -0,0 +1,136 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include "core/networking/frame_codec.h"
+
+// a random message of a random type, as the talkers make them
+static void make_random_message(std::mt19937 & rng, unsigned char* buffer, std::size_t* length, GameId game_id){
+  ClientId cli_id = rng() % 100;
+  switch(rng() % 5){
+    case 0:{
+      MakeRequestAttack(buffer, length, cli_id, game_id, rng() % 100);
+      break;
+    }
+    case 1:{
+      MakeReplyAttack(buffer, length, game_id, rng() % 2 == 0, static_cast<ShipType>(rng() % 5), rng() % 2 == 0);
+      break;
+    }
+    case 2:{
+      MakeInfoGameId(buffer, length, cli_id, game_id);
+      break;
+    }
+    case 3:{
+      MakeInfoReady(buffer, length, cli_id, game_id);
+      break;
+    }
+    case 4:{
+      MakeInfoRoll(buffer, length, cli_id, game_id, rng());
+      break;
+    }
+    default:{
+      assert(false);
+    }
+  }
+}
+
+// copy bytes into what PrepareRead gave, as a scatter read would
+static std::size_t fake_read(FrameDecoder & decoder, const unsigned char* bytes, std::size_t length){
+  std::size_t copied = 0;
+  for(const asio::mutable_buffer & buffer : decoder.PrepareRead()){
+    std::size_t n = std::min(length - copied, asio::buffer_size(buffer));
+    std::memcpy(asio::buffer_cast<unsigned char*>(buffer), bytes + copied, n);
+    copied += n;
+  }
+  decoder.CommitRead(copied);
+  return copied;
+}
+
+// a stream of random messages arrives in random pieces, split anywhere and wrapping around
+// the ring many times, and comes out of the decoder message by message as it went in
+void test_frame_codec_stream(size_t messages){
+  std::cout << "test_frame_codec_stream " << messages << std::endl;
+  std::mt19937 rng(7);
+  std::vector<unsigned char> stream;
+  std::vector<std::size_t> lengths;
+  for(size_t i = 0; i < messages; ++i){
+    unsigned char buffer[kMaxBufferLength];
+    std::size_t length = 0;
+    make_random_message(rng, buffer, &length, static_cast<GameId>(i));
+    stream.insert(stream.end(), buffer, buffer + length);
+    lengths.push_back(length);
+  }
+
+  FrameDecoder decoder;
+  std::size_t sent = 0;
+  std::size_t offset = 0;
+  size_t received = 0;
+  size_t reads = 0;
+  while(received < messages){
+    std::size_t piece = std::min<std::size_t>(stream.size() - sent, 1 + rng() % (3 * kMaxBufferLength));
+    sent += fake_read(decoder, stream.data() + sent, piece);
+    reads += 1;
+    decoder.ParseFrames([&](const FrameView & frame){
+      assert(frame.length == lengths[received]);
+      assert(std::memcmp(frame.data, stream.data() + offset, frame.length) == 0);
+      assert(frame.type == static_cast<MessageType>(stream[offset]));
+      assert(frame.game_id == static_cast<GameId>(received));
+      offset += frame.length;
+      received += 1;
+    });
+  }
+  assert(sent == stream.size() && offset == stream.size());
+  assert(decoder.GetBufferedLength() == 0 && !decoder.IsBroken());
+  std::cerr << messages << " messages in " << reads << " reads, "
+            << static_cast<double>(messages) / reads << " messages per read" << std::endl;
+  // one read takes in many messages, where reading header and body apart took two reads each
+  assert(reads < messages);
+}
+
+// what a message says survives a trip through the decoder
+void test_frame_codec_round_trip(){
+  std::cout << "test_frame_codec_round_trip" << std::endl;
+  unsigned char buffer[kMaxBufferLength];
+  std::size_t length = 0;
+  MakeReplyAttack(buffer, &length, 42, true, kCruiser, false);
+  FrameDecoder decoder;
+  fake_read(decoder, buffer, length);
+  FrameView frame;
+  bool next = decoder.NextFrame(&frame);
+  assert(next);
+  assert(frame.type == MessageType::kReplyAttack && frame.game_id == 42);
+  bool success = false;
+  ShipType type = kNotAShip;
+  bool attacker_win = true;
+  ResolveReplyAttack(frame.GetBody(), frame.GetBodyLength(), &success, &type, &attacker_win);
+  assert(success && type == kCruiser && !attacker_win);
+  next = decoder.NextFrame(&frame);
+  assert(!next);
+
+  // kept past the decoder
+  Frame kept(frame);
+  assert(kept.GetType() == MessageType::kReplyAttack && kept.GetBodyLength() == frame.GetBodyLength());
+}
+
+// a message of no known type or longer than any buffer breaks the stream
+void test_frame_codec_malformed(){
+  std::cout << "test_frame_codec_malformed" << std::endl;
+  unsigned char unknown_type[kHeaderLength] = {200, 0, 0, 0, 0, 0};
+  FrameDecoder decoder;
+  fake_read(decoder, unknown_type, kHeaderLength);
+  FrameView frame;
+  bool next = decoder.NextFrame(&frame);
+  assert(!next && decoder.IsBroken());
+
+  unsigned char too_long[kHeaderLength] = {static_cast<unsigned char>(MessageType::kInfoRoll), 255, 0, 0, 0, 0};
+  FrameDecoder decoder_too_long;
+  fake_read(decoder_too_long, too_long, kHeaderLength);
+  next = decoder_too_long.NextFrame(&frame);
+  assert(!next && decoder_too_long.IsBroken());
+}
+
+int main(int argc, char** argv){
+  test_frame_codec_round_trip();
+  test_frame_codec_malformed();
+  test_frame_codec_stream(100000);
+  return 0;
+}
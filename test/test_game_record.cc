@@ -0,0 +1,213 @@
+// the probability of every cell on every move is not what is tested
+#define BATTLESHIP_LOG_LEVEL 2
+
+#include <algorithm>
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "simulation/game_record_writer.h"
+#include "simulation/headless_match.h"
+#include "simulation/tournament.h"
+#include "test_records.h"
+
+std::vector<unsigned char> read_file(const std::string & name){
+  std::vector<unsigned char> bytes;
+  std::FILE* file = std::fopen(name.c_str(), "rb");
+  assert(file != nullptr);
+  int c;
+  while((c = std::fgetc(file)) != EOF){
+    bytes.push_back(static_cast<unsigned char>(c));
+  }
+  std::fclose(file);
+  return bytes;
+}
+
+// the moves fired at the fleets of the record give the same game, the winner's move last
+template<typename Rules>
+void check_replays(const BasicGameRecord<Rules> & record){
+  BasicBoard<Rules> boards[2];
+  for(size_t i = 0; i < 2; ++i){
+    for(const ShipPlacementInfo & placement : record.players[i].fleet){
+      bool success = boards[i].PlaceAShip(placement.type, placement.head_location, placement.direction);
+      assert(success);
+    }
+  }
+  for(size_t move = 0; move < record.moves.size(); ++move){
+    AttackResult res = boards[1 - record.Mover(move)].Attack(record.moves[move]);
+    assert(res.attacker_win == (move + 1 == record.moves.size()));
+  }
+  assert(record.Mover(record.moves.size() - 1) == record.winner);
+}
+
+template<typename Rules>
+void check_same(const BasicGameRecord<Rules> & a, const BasicGameRecord<Rules> & b){
+  assert(a.game_id == b.game_id && a.seeded == b.seeded && a.seed == b.seed && a.duration_ns == b.duration_ns);
+  assert(a.first == b.first && a.winner == b.winner);
+  for(size_t i = 0; i < 2; ++i){
+    assert(a.players[i].cli_id == b.players[i].cli_id);
+    assert(a.players[i].attack == b.players[i].attack && a.players[i].place == b.players[i].place);
+    assert(a.players[i].fleet.size() == b.players[i].fleet.size());
+    for(size_t j = 0; j < a.players[i].fleet.size(); ++j){
+      assert(a.players[i].fleet[j].type == b.players[i].fleet[j].type);
+      assert(a.players[i].fleet[j].head_location == b.players[i].fleet[j].head_location);
+      assert(a.players[i].fleet[j].direction == b.players[i].fleet[j].direction);
+    }
+  }
+  assert(a.moves.size() == b.moves.size());
+  for(size_t i = 0; i < a.moves.size(); ++i){
+    assert(a.moves[i] == b.moves[i]);
+  }
+}
+
+// a block reads back the games that went in, a classic move a byte
+template<typename Rules>
+void test_game_record_block(const std::string & rules){
+  std::cout << "test_game_record_block " << rules << std::endl;
+  BasicGameRecordBlock<Rules> block;
+  std::vector<BasicGameRecord<Rules>> records;
+  const StrategyAttack strategies[] = {StrategyAttack::kRandom, StrategyAttack::kDFS, StrategyAttack::kDFSProbability};
+  size_t moves = 0;
+  for(GameId game_id = 100; game_id > 90; --game_id){
+    records.push_back(play_recorded<Rules>(game_id, PlayerSetting(1, strategies[game_id % 3], StrategyPlaceShip::kRandom),
+                                           PlayerSetting(0, StrategyAttack::kDFS, StrategyPlaceShip::kFixed), true, game_id * 7));
+    check_replays(records.back());
+    bool added = block.Add(records.back());
+    assert(added);
+    moves += records.back().moves.size();
+  }
+  if(Rules::kCellNum <= 128){
+    std::cerr << block.GetLength() << " bytes for " << moves << " moves" << std::endl;
+    assert(block.GetLength() < moves + records.size() * 64);
+  }
+
+  BasicGameRecordBlockReader<Rules> reader(block.GetRecords(), block.GetLength(), block.GetGameNum());
+  BasicGameRecord<Rules> record;
+  for(const BasicGameRecord<Rules> & expected : records){
+    bool next = reader.Next(&record);
+    assert(next);
+    check_same(expected, record);
+  }
+  bool next = reader.Next(&record);
+  assert(!next && reader.IsDone());
+
+  // a cut block doesn't read
+  BasicGameRecordBlockReader<Rules> cut(block.GetRecords(), block.GetLength() - 1, block.GetGameNum());
+  size_t read = 0;
+  while(cut.Next(&record)) read += 1;
+  assert(read == records.size() - 1 && !cut.IsDone());
+}
+
+// files fill up to their size and the next one is started, every game is in exactly one of them
+void test_game_record_writer_rotation(){
+  std::cout << "test_game_record_writer_rotation" << std::endl;
+  const std::string prefix = "test_game_record";
+  const size_t games = 1000;
+  std::vector<std::string> names;
+  {
+    GameRecordWriter writer(prefix, 20 * 1000);
+    GameRecordBlock block;
+    for(size_t i = 0; i < games; ++i){
+      GameRecord record = play_recorded<ClassicRules>(static_cast<GameId>(i), PlayerSetting(1, StrategyAttack::kDFS, StrategyPlaceShip::kRandom),
+                                                      PlayerSetting(0, StrategyAttack::kDFS, StrategyPlaceShip::kFixed), true, i * 7);
+      bool added = writer.Add(block, record);
+      assert(added);
+    }
+    bool written = writer.Write(block);
+    assert(written);
+    writer.Close();
+    assert(!writer.IsFailed() && writer.GetGameNum() == games);
+    names = writer.GetFileNames();
+  }
+  assert(names.size() > 1 && names[0] == prefix + ".000000.bsgr");
+
+  GameId next_game_id = 0;
+  for(const std::string & name : names){
+    std::vector<unsigned char> bytes = read_file(name);
+    assert(CheckGameRecordFileHeader<ClassicRules>(bytes.data(), bytes.size()));
+    assert(!CheckGameRecordFileHeader<LargeRules>(bytes.data(), bytes.size()));
+    // the index at the end names every block before it
+    std::vector<size_t> block_offsets;
+    size_t index_offset = 0;
+    bool indexed = ReadGameRecordIndex(bytes.data(), bytes.size(), &block_offsets, &index_offset);
+    assert(indexed && !block_offsets.empty());
+    size_t offset = kGameRecordFileHeaderLength;
+    size_t block = 0;
+    while(offset < index_offset){
+      assert(block < block_offsets.size() && block_offsets[block] == offset);
+      block += 1;
+      size_t length = 0;
+      size_t game_num = 0;
+      bool header = ReadGameRecordBlockHeader(bytes.data(), bytes.size(), &offset, &length, &game_num);
+      assert(header);
+      GameRecordBlockReader reader(bytes.data() + offset, length, game_num);
+      GameRecord record;
+      while(reader.Next(&record)){
+        assert(record.game_id == next_game_id);
+        next_game_id += 1;
+      }
+      assert(reader.IsDone());
+      offset += length;
+    }
+    assert(offset == index_offset && block == block_offsets.size());
+
+    // a file cut short has no index
+    indexed = ReadGameRecordIndex(bytes.data(), bytes.size() - 1, &block_offsets, &index_offset);
+    assert(!indexed);
+    std::remove(name.c_str());
+  }
+  assert(next_game_id == games);
+}
+
+// the games of a tournament have ids of their own over all pairs, and the id finds the game of its pair
+void test_game_record_tournament_ids(){
+  std::cout << "test_game_record_tournament_ids" << std::endl;
+  TournamentSetting setting;
+  setting.games_per_pair = 5;
+  setting.games_per_task = 2;
+  setting.num_threads = 2;
+  setting.seeded = true;
+  setting.seed = 3;
+  setting.record_prefix = "test_game_record_tournament";
+  std::vector<PairResult> results = Tournament(setting).Run();
+
+  std::vector<unsigned char> bytes = read_file(setting.record_prefix + ".000000.bsgr");
+  std::remove((setting.record_prefix + ".000000.bsgr").c_str());
+  const size_t games = results.size() * setting.games_per_pair;
+  std::vector<bool> seen(games, false);
+  size_t offset = kGameRecordFileHeaderLength;
+  while(offset < bytes.size()){
+    size_t length = 0;
+    size_t game_num = 0;
+    bool header = ReadGameRecordBlockHeader(bytes.data(), bytes.size(), &offset, &length, &game_num);
+    assert(header);
+    GameRecordBlockReader reader(bytes.data() + offset, length, game_num);
+    GameRecord record;
+    while(reader.Next(&record)){
+      assert(record.game_id < games && !seen[record.game_id]);
+      seen[record.game_id] = true;
+    }
+    offset += length;
+  }
+  assert(std::count(seen.begin(), seen.end(), true) == static_cast<long>(games));
+
+  for(GameId game_id = 0; game_id < games; ++game_id){
+    GameRecord record;
+    bool found = FindGameRecord<ClassicRules>(bytes.data(), bytes.size(), game_id, &record);
+    assert(found);
+    assert(record.game_id == game_id);
+    const PairResult & result = results[game_id / setting.games_per_pair];
+    assert(record.players[0].attack == result.attack && record.players[1].place == result.place);
+    // the seeds are still those of the strategies and the game of the pair
+    size_t strategies = static_cast<size_t>(result.attack) * 16 + static_cast<size_t>(result.place);
+    assert(record.seed == RandomUnit::DeriveSeed(RandomUnit::DeriveSeed(setting.seed, strategies), game_id % setting.games_per_pair));
+  }
+}
+
+int main(int argc, char** argv){
+  test_game_record_block<ClassicRules>("classic");
+  test_game_record_block<HugeRules>("huge");
+  test_game_record_writer_rotation();
+  test_game_record_tournament_ids();
+  return 0;
+}
@@ -0,0 +1,201 @@
+// the probability of every cell on every move is not what is tested
+#define BATTLESHIP_LOG_LEVEL 2
+
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "simulation/game_record_analysis.h"
+#include "simulation/game_record_writer.h"
+#include "simulation/headless_match.h"
+#include "test_records.h"
+
+const std::string kPrefix = "test_game_record_analysis";
+// ship cells of a classic fleet, all of them are hit by the winner
+const size_t kFleetCells = 5 * 1 + 4 * 2 + 3 * 3 + 2 * 4;
+
+struct Played{
+  size_t games = 0;
+  size_t moves = 0;
+  size_t wins[kStrategyAttackNum] = {};
+};
+
+// random against dfs, both fast, into files of a block or two each
+std::vector<std::string> write_games(size_t games, Played* played){
+  GameRecordWriter writer(kPrefix, GameRecordBlock::kCapacity);
+  GameRecordBlock block;
+  for(size_t i = 0; i < games; ++i){
+    StrategyAttack attack = i % 2 == 0 ? StrategyAttack::kRandom : StrategyAttack::kDFS;
+    GameRecord record = play_recorded<ClassicRules>(static_cast<GameId>(i), PlayerSetting(1, attack, StrategyPlaceShip::kRandom),
+                                                    PlayerSetting(0, StrategyAttack::kDFS, StrategyPlaceShip::kRandom), true, i * 13 + 1);
+    bool added = writer.Add(block, record);
+    assert(added);
+    played->games += 1;
+    played->moves += record.moves.size();
+    played->wins[static_cast<size_t>(record.players[record.winner].attack)] += 1;
+  }
+  bool written = writer.Write(block);
+  assert(written);
+  writer.Close();
+  assert(!writer.IsFailed());
+  return writer.GetFileNames();
+}
+
+template<size_t N>
+uint64_t sum(const uint64_t (&values)[N]){
+  uint64_t total = 0;
+  for(size_t i = 0; i < N; ++i){
+    total += values[i];
+  }
+  return total;
+}
+
+// every shot and win is counted once, whatever the threads and chunks
+void check_stats(const GameRecordStats & stats, const Played & played){
+  assert(stats.games == played.games && stats.broken == 0);
+  uint64_t players = 0;
+  uint64_t shots = 0;
+  uint64_t move_shots = 0;
+  uint64_t hits = 0;
+  uint64_t winner_hits = 0;
+  for(size_t i = 0; i < kStrategyAttackNum; ++i){
+    const BasicStrategyStats<ClassicRules> & strategy = stats.strategies[i];
+    assert(strategy.wins == played.wins[i]);
+    assert(sum(strategy.wins_in) == strategy.wins);
+    assert(sum(strategy.hits) == sum(strategy.move_hits));
+    assert(sum(strategy.first_sink) <= strategy.players);
+    players += strategy.players;
+    shots += sum(strategy.shots);
+    move_shots += sum(strategy.move_shots);
+    hits += sum(strategy.hits);
+    winner_hits += strategy.wins * kFleetCells;
+  }
+  assert(players == 2 * played.games);
+  assert(shots == played.moves && move_shots == played.moves);
+  assert(hits >= winner_hits && hits < winner_hits + played.games * kFleetCells);
+}
+
+void test_game_record_analysis(){
+  std::cout << "test_game_record_analysis" << std::endl;
+  Played played;
+  std::vector<std::string> names = write_games(1200, &played);
+  assert(names.size() > 1);
+
+  // a chunk a block, then a few blocks a chunk, on one thread and on many
+  GameRecordStats reference;
+  for(size_t chunk_length : {size_t(1), 2 * GameRecordBlock::kCapacity, GameRecordAnalysis::kChunkLength}){
+    for(size_t threads : {size_t(1), size_t(4)}){
+      GameRecordAnalysis analysis(threads, chunk_length);
+      for(const std::string & name : names){
+        bool added = analysis.AddFile(name);
+        assert(added);
+      }
+      GameRecordStats stats = analysis.Run();
+      check_stats(stats, played);
+      if(reference.games == 0){
+        reference = stats;
+        continue;
+      }
+      for(size_t i = 0; i < kStrategyAttackNum; ++i){
+        for(size_t location = 0; location < ClassicRules::kCellNum; ++location){
+          assert(stats.strategies[i].shots[location] == reference.strategies[i].shots[location]);
+          assert(stats.strategies[i].move_hits[location] == reference.strategies[i].move_hits[location]);
+        }
+      }
+    }
+  }
+
+  // dfs hunts around its hits, so it hits more often and wins more than random shots
+  const BasicStrategyStats<ClassicRules> & random = reference.strategies[static_cast<size_t>(StrategyAttack::kRandom)];
+  const BasicStrategyStats<ClassicRules> & dfs = reference.strategies[static_cast<size_t>(StrategyAttack::kDFS)];
+  assert(random.wins < dfs.wins);
+  assert(sum(random.hits) * sum(dfs.shots) < sum(dfs.hits) * sum(random.shots));
+
+  // a chunk a block, as the index says where they start
+  {
+    GameRecordAnalysis analysis(1, 1);
+    size_t blocks = 0;
+    for(const std::string & name : names){
+      bool added = analysis.AddFile(name);
+      assert(added);
+      MappedFile file;
+      bool opened = file.Open(name);
+      assert(opened);
+      std::vector<size_t> block_offsets;
+      size_t index_offset = 0;
+      bool indexed = ReadGameRecordIndex(file.GetData(), file.GetLength(), &block_offsets, &index_offset);
+      assert(indexed);
+      blocks += block_offsets.size();
+    }
+    assert(analysis.GetChunkNum() == blocks);
+  }
+
+  // a file cut in the middle of its last block, and so without an index, reads up to the block
+  {
+    size_t index_offset = 0;
+    {
+      MappedFile file;
+      bool opened = file.Open(names.back());
+      assert(opened);
+      std::vector<size_t> block_offsets;
+      bool indexed = ReadGameRecordIndex(file.GetData(), file.GetLength(), &block_offsets, &index_offset);
+      assert(indexed);
+    }
+    int truncated = truncate(names.back().c_str(), index_offset - 10);
+    assert(truncated == 0);
+
+    GameRecordAnalysis analysis(2);
+    for(const std::string & name : names){
+      bool added = analysis.AddFile(name);
+      assert(added);
+    }
+    GameRecordStats stats = analysis.Run();
+    assert(stats.broken == 1 && stats.games < played.games && stats.games > 0);
+  }
+
+  // a block of whole games with bytes left over is broken once
+  {
+    GameRecordBlock block;
+    GameRecord record = play_recorded<ClassicRules>(0, PlayerSetting(1, StrategyAttack::kDFS, StrategyPlaceShip::kRandom),
+                                                    PlayerSetting(0, StrategyAttack::kDFS, StrategyPlaceShip::kRandom), true, 1);
+    bool added = block.Add(record);
+    assert(added);
+    std::vector<unsigned char> bytes(kGameRecordFileHeaderLength + kGameRecordBlockHeaderLength);
+    WriteGameRecordFileHeader<ClassicRules>(bytes.data());
+    size_t offset = kGameRecordFileHeaderLength;
+    serialization::FixedField<4>::Write(bytes.data(), &offset, block.GetLength() + 1);
+    serialization::FixedField<4>::Write(bytes.data(), &offset, block.GetGameNum());
+    bytes.insert(bytes.end(), block.GetRecords(), block.GetRecords() + block.GetLength());
+    bytes.push_back(0);
+    const std::string name = kPrefix + ".left_over";
+    std::FILE* file = std::fopen(name.c_str(), "wb");
+    assert(file != nullptr);
+    size_t written = std::fwrite(bytes.data(), 1, bytes.size(), file);
+    assert(written == bytes.size());
+    std::fclose(file);
+
+    GameRecordAnalysis analysis(1);
+    added = analysis.AddFile(name);
+    assert(added);
+    GameRecordStats stats = analysis.Run();
+    assert(stats.games == 1 && stats.broken == 1);
+    std::remove(name.c_str());
+  }
+
+  // other rules or no records at all don't add
+  BasicGameRecordAnalysis<LargeRules> large;
+  bool added = large.AddFile(names[0]);
+  assert(!added);
+  GameRecordAnalysis missing;
+  added = missing.AddFile(kPrefix + ".missing");
+  assert(!added);
+
+  for(const std::string & name : names){
+    std::remove(name.c_str());
+  }
+}
+
+int main(int argc, char** argv){
+  test_game_record_analysis();
+  return 0;
+}
@@ -0,0 +1,159 @@
+// the probability of every cell on every move is not what is tested
+#define BATTLESHIP_LOG_LEVEL 2
+
+#include <iostream>
+#include <vector>
+#include "simulation/game_record_analysis.h"
+#include "simulation/game_replay.h"
+#include "simulation/headless_match.h"
+#include "test_records.h"
+
+// what both players have and know at a position
+struct Position{
+  std::vector<unsigned char> states;
+  std::vector<size_t> probabilities;
+  size_t moves[2];
+};
+
+Position capture(GameReplay & replay){
+  Position position;
+  for(size_t i = 0; i < 2; ++i){
+    GameReplay::HeadlessPlayer & player = replay.GetPlayer(i);
+    for(size_t location = 0; location < ClassicRules::kCellNum; ++location){
+      position.states.push_back(player.board.GetState(location));
+      position.states.push_back(player.brain.GetRefEnemyBoard().GetState(location));
+      position.probabilities.push_back(player.brain.GetRefProbBoard().GetProbability(location));
+    }
+    position.moves[i] = player.board.GetNumMoves();
+  }
+  return position;
+}
+
+void check_same(const Position & a, const Position & b){
+  assert(a.states == b.states && a.probabilities == b.probabilities);
+  assert(a.moves[0] == b.moves[0] && a.moves[1] == b.moves[1]);
+}
+
+// the brains of a seeded game fire every recorded move again, the boards end as the game did
+void test_game_replay_seeded(){
+  std::cout << "test_game_replay_seeded" << std::endl;
+  const StrategyAttack strategies[] = {StrategyAttack::kRandom, StrategyAttack::kDFS,
+                                       StrategyAttack::kProbabilitySimple, StrategyAttack::kDFSProbability};
+  for(GameId game_id = 0; game_id < 8; ++game_id){
+    GameRecord record = play_recorded<ClassicRules>(game_id, PlayerSetting(1, strategies[game_id % 4], StrategyPlaceShip::kRandom),
+                                                    PlayerSetting(0, strategies[(game_id / 2) % 4], StrategyPlaceShip::kRandom), true, game_id * 31 + 5);
+    GameReplay replay(record);
+    while(replay.StepForward()){}
+    assert(replay.GetPosition() == record.moves.size());
+    assert(replay.GetDivergence() == GameReplay::kNoDivergence);
+    assert(replay.GetPlayer(record.winner).is_winner_me && !replay.GetPlayer(1 - record.winner).is_winner_me);
+    for(size_t location = 0; location < ClassicRules::kCellNum; ++location){
+      // every ship cell of the loser is hit
+      unsigned char state = replay.GetPlayer(1 - record.winner).board.GetState(location);
+      assert(state != 1);
+    }
+  }
+}
+
+// going back restores a checkpoint and plays on from it, to the same state as playing forward
+void test_game_replay_seek(){
+  std::cout << "test_game_replay_seek" << std::endl;
+  GameRecord record = play_recorded<ClassicRules>(42, PlayerSetting(1, StrategyAttack::kDFSProbability, StrategyPlaceShip::kRandom),
+                                                  PlayerSetting(0, StrategyAttack::kDFSProbability, StrategyPlaceShip::kRandom), true, 1307);
+  std::vector<Position> forward;
+  {
+    GameReplay replay(record, 7);
+    forward.push_back(capture(replay));
+    while(replay.StepForward()){
+      forward.push_back(capture(replay));
+    }
+    assert(forward.size() == record.moves.size() + 1);
+  }
+
+  GameReplay replay(record, 7);
+  replay.Seek(record.moves.size());
+  check_same(capture(replay), forward.back());
+  while(replay.StepBackward()){
+    check_same(capture(replay), forward[replay.GetPosition()]);
+  }
+  assert(replay.GetPosition() == 0);
+  const size_t jumps[] = {30, 3, 50, 49, 21, 0, 14, 15};
+  for(size_t position : jumps){
+    replay.Seek(position);
+    assert(replay.GetPosition() == position);
+    check_same(capture(replay), forward[position]);
+  }
+  assert(replay.GetDivergence() == GameReplay::kNoDivergence);
+}
+
+// a play out from a position is a whole game that starts with the recorded moves and leaves the replay as it was
+void test_game_replay_play_out(){
+  std::cout << "test_game_replay_play_out" << std::endl;
+  GameRecord record = play_recorded<ClassicRules>(7, PlayerSetting(1, StrategyAttack::kRandom, StrategyPlaceShip::kRandom),
+                                                  PlayerSetting(0, StrategyAttack::kRandom, StrategyPlaceShip::kRandom), true, 222);
+  GameReplay replay(record);
+  replay.Seek(40);
+  Position before = capture(replay);
+
+  GameRecord branch;
+  MatchResult res = replay.PlayOut(StrategyAttack::kDFSProbability, StrategyAttack::kDFS, 99, &branch);
+  check_same(capture(replay), before);
+  assert(res.does_win[0] != res.does_win[1]);
+  assert(branch.moves.size() == res.num_moves[0] + res.num_moves[1]);
+  assert(branch.players[0].attack == StrategyAttack::kDFSProbability && !branch.seeded);
+  for(size_t move = 0; move < 40; ++move){
+    assert(branch.moves[move] == record.moves[move]);
+  }
+  GameRecordStats stats;
+  bool added = stats.AddGame(branch);
+  assert(added);
+
+  // the same seed plays the same, at the end there is nothing left to play
+  GameRecord again;
+  replay.PlayOut(StrategyAttack::kDFSProbability, StrategyAttack::kDFS, 99, &again);
+  assert(again.moves.size() == branch.moves.size());
+  for(size_t move = 0; move < branch.moves.size(); ++move){
+    assert(again.moves[move] == branch.moves[move]);
+  }
+  replay.Seek(record.moves.size());
+  res = replay.PlayOut(StrategyAttack::kDFS, StrategyAttack::kDFS, 1);
+  assert(res.does_win[record.winner] && res.num_moves[0] + res.num_moves[1] == record.moves.size());
+}
+
+// a record the brains can't have played is found out at the first move they don't fire
+void test_game_replay_divergence(){
+  std::cout << "test_game_replay_divergence" << std::endl;
+  GameRecord unseeded = play_recorded<ClassicRules>(3, PlayerSetting(1, StrategyAttack::kDFS, StrategyPlaceShip::kRandom),
+                                                    PlayerSetting(0, StrategyAttack::kDFS, StrategyPlaceShip::kRandom), false, 0);
+  assert(GameReplay(unseeded).GetDivergence() == 0);
+
+  GameRecord record = play_recorded<ClassicRules>(3, PlayerSetting(1, StrategyAttack::kDFSProbability, StrategyPlaceShip::kRandom),
+                                                  PlayerSetting(0, StrategyAttack::kDFSProbability, StrategyPlaceShip::kRandom), true, 98);
+  GameRecord other_fleet = record;
+  std::swap(other_fleet.players[1].fleet[0], other_fleet.players[1].fleet[1]);
+  GameReplay fleet_replay(other_fleet);
+  assert(fleet_replay.FleetsDiverged() && fleet_replay.GetDivergence() == 0);
+  assert(!GameReplay(record).FleetsDiverged());
+
+  GameRecord tampered = record;
+  size_t changed = 20;
+  for(size_t move = changed + 2; move + 1 < tampered.moves.size(); move += 2){
+    if(tampered.moves[move] == tampered.moves[changed]) continue;
+    // two moves of the same player swapped, not the winning one
+    std::swap(tampered.moves[changed], tampered.moves[move]);
+    break;
+  }
+  GameReplay replay(tampered);
+  replay.Seek(changed);
+  assert(replay.GetDivergence() == GameReplay::kNoDivergence);
+  replay.StepForward();
+  assert(replay.GetDivergence() == changed);
+}
+
+int main(int argc, char** argv){
+  test_game_replay_seeded();
+  test_game_replay_seek();
+  test_game_replay_play_out();
+  test_game_replay_divergence();
+  return 0;
+}
@@ -0,0 +1,46 @@
+//
+// Random games for the tests of what a brain knows about the enemy board.
+//
+
+#ifndef BATTLESHIP_TEST_GAMES_H
+#define BATTLESHIP_TEST_GAMES_H
+
+#include "ai/ship_placement_unit.h"
+#include "core/game/board.h"
+
+// play `games` random games, call start(enemy_board) before the first shot of a game
+// and check(enemy_board) after every shot
+template<typename S, typename F>
+void play_random_games(size_t games, S start, F check){
+  for(size_t g = 0; g < games; ++g){
+    Board board;
+    ShipPlacementUnit placement_unit;
+    for(auto placement : placement_unit.ShipPlacingPlan(StrategyPlaceShip::kRandom)){
+      bool success = board.PlaceAShip(placement.type, placement.head_location, placement.direction);
+      assert(success);
+    }
+
+    ImagineBoard enemy_board;
+    start(enemy_board);
+    size_t order[kDim * kDim];
+    RandomUnit::FillRandomSequence(order, kDim * kDim);
+    for(size_t i = 0; i < kDim * kDim; ++i){
+      AttackResult res = board.Attack(order[i]);
+      enemy_board.MarkAttack(res.location);
+      if(res.success){
+        enemy_board.MarkOccupied(res.location);
+        enemy_board.DestroyOneOnBoard(res.sink_ship_type);
+      }
+      enemy_board.UpdateLastAttackInfo(res);
+      check(enemy_board);
+      if(res.attacker_win) break;
+    }
+  }
+}
+
+template<typename F>
+void play_random_games(size_t games, F check){
+  play_random_games(games, [](ImagineBoard &){}, check);
+}
+
+#endif //BATTLESHIP_TEST_GAMES_H
@@ -6,39 +6,33 @@
 #include <iostream>
 #include "graphic/game_ui.h"
 
-void attack_my_board(Board & my_board){
-  for(size_t i = 0; i < 100; i++){
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    my_board.Attack(i);
-  }
-}
-
-void attack_enemy_board(ImagineBoard & enemy_board){
+// one thread plays, as the game thread of a client does, and the ui only sees its snapshots
+void play(Board & my_board, ImagineBoard & enemy_board, ProbabilityBoard & probability_board, GameSnapshotBuffer & snapshots){
+  my_board.PlaceAShip(ShipType::kBattleShip, 0, Direction::kVertical);
+  my_board.PlaceAShip(ShipType::kCruiser, 3, Direction::kHorisontal);
   bool toggle = true;
   for(size_t i = 0; i < 100; i++){
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    my_board.Attack(i);
     if(toggle) enemy_board.MarkAttack(i);
     else enemy_board.MarkOccupied(i);
     toggle = !toggle;
+    snapshots.GetBack().Capture(my_board, enemy_board, probability_board);
+    snapshots.Publish();
   }
 }
 
-void place_ship(Board& my_board){
-  my_board.PlaceAShip(ShipType::kBattleShip, 0, Direction::kVertical);
-  my_board.PlaceAShip(ShipType::kCruiser, 3, Direction::kHorisontal);
-
-}
-
 int main(void)
 {
   Board my_board;
   ImagineBoard enemy_board;
-  GameUi ui(my_board, enemy_board);
+  ProbabilityBoard probability_board(enemy_board);
+  GameSnapshotBuffer snapshots;
+  GameUi ui(snapshots);
 
-  std::thread thread1(attack_my_board, std::ref(my_board));
-  std::thread thread2(attack_enemy_board, std::ref(enemy_board));
-  std::thread thread3(place_ship, std::ref(my_board));
+  std::thread game_thread(play, std::ref(my_board), std::ref(enemy_board), std::ref(probability_board), std::ref(snapshots));
 
   ui.run();
+  game_thread.join();
   return 0;
-}
\ No newline at end of file
+}
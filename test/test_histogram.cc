@@ -0,0 +1,99 @@
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+#include "client/game_metrics.h"
+#include "utils/histogram.h"
+
+// the buckets follow one another with no gap, each within 1 / 16 of its values
+void test_histogram_buckets(){
+  std::cout << "test_histogram_buckets" << std::endl;
+  for(std::size_t bucket = 0; bucket + 1 < LatencyHistogram::kBuckets; ++bucket){
+    std::uint64_t lowest = LatencyHistogram::BucketLowest(bucket);
+    std::uint64_t highest = LatencyHistogram::BucketHighest(bucket);
+    assert(LatencyHistogram::BucketOf(lowest) == bucket);
+    assert(LatencyHistogram::BucketOf(highest) == bucket);
+    assert(LatencyHistogram::BucketLowest(bucket + 1) == highest + 1);
+    assert(highest - lowest <= lowest / 16);
+  }
+  assert(LatencyHistogram::BucketOf(~std::uint64_t(0)) == LatencyHistogram::kBuckets - 1);
+  assert(LatencyHistogram::BucketHighest(LatencyHistogram::kBuckets - 1) == ~std::uint64_t(0));
+}
+
+// the percentiles of the histogram are those of the values, to the width of a bucket
+void test_histogram_percentiles(){
+  std::cout << "test_histogram_percentiles" << std::endl;
+  std::mt19937 rng(1);
+  std::lognormal_distribution<double> latency(10, 1);
+  std::vector<std::uint64_t> values;
+  LatencyHistogram histogram;
+  for(size_t i = 0; i < 100000; ++i){
+    values.push_back(static_cast<std::uint64_t>(latency(rng)));
+    histogram.Record(values.back());
+  }
+  std::sort(values.begin(), values.end());
+  assert(histogram.GetCount() == values.size());
+  assert(histogram.GetMin() == values.front() && histogram.GetMax() == values.back());
+  const double fractions[] = {0.5, 0.9, 0.99, 0.999};
+  for(double fraction : fractions){
+    std::uint64_t exact = values[static_cast<size_t>(fraction * values.size()) - 1];
+    std::uint64_t value = histogram.GetValueAtFraction(fraction);
+    assert(value >= exact && value - exact <= exact / 16);
+  }
+}
+
+// threads recording at once lose no value
+void test_histogram_threads(size_t threads, size_t records){
+  std::cout << "test_histogram_threads " << threads << " threads, " << records << " records each" << std::endl;
+  LatencyHistogram histogram;
+  std::vector<std::thread> workers;
+  for(size_t t = 0; t < threads; ++t){
+    workers.emplace_back([&histogram, t, records](){
+      for(size_t i = 0; i < records; ++i){
+        histogram.Record(t * records + i);
+      }
+    });
+  }
+  for(std::thread & worker : workers){
+    worker.join();
+  }
+  assert(histogram.GetCount() == threads * records);
+  assert(histogram.GetMin() == 0 && histogram.GetMax() == threads * records - 1);
+  assert(histogram.GetMean() == (threads * records - 1) / 2);
+}
+
+// only what was timed shows, states under their names, nothing without instrumentation
+void test_game_metrics(){
+  std::cout << "test_game_metrics" << std::endl;
+  GameMetrics metrics;
+  {
+    ScopedTimer timer(metrics.GenerateAttack(StrategyAttack::kDFSProbability));
+  }
+  metrics.ChangeState(ClientState::kConnected);
+  metrics.Counter(GameCounter::kSocketReads).Add(3);
+
+  std::vector<std::string> names;
+  metrics.ForEachHistogram([&names](const std::string & name, const LatencyHistogram & histogram){
+    assert(histogram.GetCount() == 1);
+    names.push_back(name);
+  });
+  if(!kInstrumented){
+    // nothing recorded and no histograms held
+    assert(names.empty() && sizeof(GameMetrics) < sizeof(LatencyHistogram));
+    return;
+  }
+  assert(names.size() == 2);
+  assert(names[0] == "generate_attack/dfs_probability" && names[1] == "state/kStarted");
+  metrics.ForEachCounter([](const std::string & name, std::uint64_t value){
+    assert(name == "socket_reads" && value == 3);
+  });
+}
+
+int main(int argc, char** argv){
+  test_histogram_buckets();
+  test_histogram_percentiles();
+  test_histogram_threads(4, 100000);
+  test_game_metrics();
+  return 0;
+}
@@ -0,0 +1,136 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "utils/utils.h"
+
+// read everything written to file from the start, one string a line
+std::vector<std::string> read_lines(std::FILE* file){
+  std::vector<std::string> lines;
+  std::rewind(file);
+  std::string line;
+  int c;
+  while((c = std::fgetc(file)) != EOF){
+    if(c == '\n'){
+      lines.push_back(line);
+      line.clear();
+    }else{
+      line += static_cast<char>(c);
+    }
+  }
+  return lines;
+}
+
+// threads logging at once lose no record, and the records of one thread stay in order
+void test_log_threads(size_t threads, size_t records){
+  std::cout << "test_log_threads " << threads << " threads, " << records << " records each" << std::endl;
+  std::FILE* file = std::tmpfile();
+  SetLogOutput(file);
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for(size_t t = 0; t < threads; ++t){
+    workers.emplace_back([t, records](){
+      for(size_t i = 0; i < records; ++i){
+        LogProbability(t, i);
+      }
+    });
+  }
+  for(std::thread & worker : workers){
+    worker.join();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  FlushLog();
+  SetLogOutput(stdout);
+
+  std::vector<std::string> lines = read_lines(file);
+  assert(lines.size() == threads * records);
+  std::vector<size_t> next(threads, 0);
+  for(const std::string & line : lines){
+    size_t t = 0;
+    size_t i = 0;
+    int matched = std::sscanf(line.c_str(), "%zu,%zu", &t, &i);
+    assert(matched == 2 && t < threads);
+    assert(i == next[t]);
+    next[t] += 1;
+  }
+  std::fclose(file);
+  std::cerr << seconds * 1e9 / (threads * records) << " ns per record while logging" << std::endl;
+}
+
+// the same records as json lines, text escaped
+void test_log_json(){
+  std::cout << "test_log_json" << std::endl;
+  std::FILE* file = std::tmpfile();
+  SetLogOutput(file);
+  SetLogFormat(LogFormat::kJson);
+  Logger("say \"hi\"");
+  LogResult(3, 7, true, 42);
+  FlushLog();
+  SetLogFormat(LogFormat::kText);
+  SetLogOutput(stdout);
+
+  std::vector<std::string> lines = read_lines(file);
+  assert(lines.size() == 2);
+  assert(lines[0] == "{\"level\":\"info\",\"message\":\"say \\\"hi\\\"\"}");
+  assert(lines[1] == "{\"level\":\"info\",\"client\":3,\"game\":7,\"win\":true,\"moves\":42}");
+  std::fclose(file);
+}
+
+// the histograms and counters of a game, a line each in either format
+void test_log_metrics(){
+  std::cout << "test_log_metrics" << std::endl;
+  std::FILE* file = std::tmpfile();
+  SetLogOutput(file);
+  LatencyHistogram histogram;
+  histogram.Record(10);
+  histogram.Record(20);
+  LogLatency(3, 7, "attack_wait", histogram);
+  LogCounter(3, 7, "socket_reads", 5);
+  // the format is the one of the flush
+  FlushLog();
+  SetLogFormat(LogFormat::kJson);
+  LogLatency(3, 7, "attack_wait", histogram);
+  LogCounter(3, 7, "socket_reads", 5);
+  FlushLog();
+  SetLogFormat(LogFormat::kText);
+  SetLogOutput(stdout);
+
+  std::vector<std::string> lines = read_lines(file);
+  assert(lines.size() == 4);
+  assert(lines[0] == "3,7,latency,attack_wait,2,15,10,10,20,20,20");
+  assert(lines[1] == "3,7,counter,socket_reads,5");
+  assert(lines[2] == "{\"level\":\"info\",\"client\":3,\"game\":7,\"latency\":\"attack_wait\",\"count\":2,\"mean_ns\":15,"
+                     "\"min_ns\":10,\"p50_ns\":10,\"p90_ns\":20,\"p99_ns\":20,\"max_ns\":20}");
+  assert(lines[3] == "{\"level\":\"info\",\"client\":3,\"game\":7,\"counter\":\"socket_reads\",\"value\":5}");
+  std::fclose(file);
+}
+
+// what logging costs the thread logging, as long as its buffer has room
+void test_log_burst(size_t records){
+  std::cout << "test_log_burst " << records << std::endl;
+  std::FILE* file = std::tmpfile();
+  SetLogOutput(file);
+  FlushLog();
+  auto start = std::chrono::steady_clock::now();
+  for(size_t i = 0; i < records; ++i){
+    LogProbability(i, i);
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  FlushLog();
+  SetLogOutput(stdout);
+  assert(read_lines(file).size() == records);
+  std::fclose(file);
+  std::cerr << seconds * 1e9 / records << " ns per record in a burst" << std::endl;
+}
+
+int main(int argc, char** argv){
+  test_log_json();
+  test_log_metrics();
+  test_log_burst(2000);
+  test_log_threads(1, 1000000);
+  test_log_threads(4, 200000);
+  return 0;
+}
@@ -0,0 +1,234 @@
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "client/async_game_host.h"
+#include "server/match_server.h"
+
+// matched clients in one process ask a server for their games over loopback,
+// everything on one two thread io_service. returns the result of the server.
+ServerResult play_through_server(ServerMode mode, size_t clients, size_t games, size_t connections){
+  asio::io_service io_service;
+
+  ServerSetting server_setting;
+  server_setting.mode = mode;
+  // a relayed game is played by two of the clients
+  server_setting.max_games = mode == ServerMode::kRelay ? clients * games / 2 : clients * games;
+  MatchServer server(io_service, server_setting);
+  server.Start();
+
+  std::vector<std::unique_ptr<AsyncGameHost>> hosts;
+  for(size_t c = 0; c < clients; ++c){
+    AsyncHostSetting setting;
+    setting.type = ClientType::kMatched;
+    setting.port = server.GetPort();
+    setting.cli_id = static_cast<ClientId>(c);
+    setting.games = games;
+    setting.connections = connections;
+    setting.attack = StrategyAttack::kRandom;
+    hosts.emplace_back(new AsyncGameHost(io_service, setting));
+    hosts.back()->Start();
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  AsyncGameHost::Run(io_service, 2);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  ServerResult res = server.GetResult();
+  size_t finished = 0;
+  size_t wins = 0;
+  for(const std::unique_ptr<AsyncGameHost> & host : hosts){
+    AsyncHostResult host_res = host->GetResult();
+    assert(host_res.broken_off == 0 && host_res.finished == games);
+    finished += host_res.finished;
+    wins += host_res.wins;
+  }
+  assert(res.broken_off == 0 && res.finished == server_setting.max_games && res.matched == res.finished);
+  // exactly one side wins every game, the server is one side of every game it plays
+  if(mode == ServerMode::kRelay){
+    assert(finished == 2 * res.finished && wins == res.finished);
+  }else{
+    assert(finished == res.finished && wins <= res.finished);
+  }
+  std::cerr << res.finished << " games through the server in " << seconds << "s" << std::endl;
+  return res;
+}
+
+// two clients asking for as many games are paired with each other for all of them.
+// with more connections a request is left over if the ones waiting are all of its own connection.
+void test_match_server_relay(size_t games){
+  std::cout << "test_match_server_relay " << games << std::endl;
+  play_through_server(ServerMode::kRelay, 2, games, 1);
+}
+
+void test_match_server_play(size_t clients, size_t games){
+  std::cout << "test_match_server_play " << clients << " clients, " << games << " games each" << std::endl;
+  play_through_server(ServerMode::kPlay, clients, games, 1);
+}
+
+// a request cut short is dropped, the server goes on serving the others
+void test_match_server_malformed(){
+  std::cout << "test_match_server_malformed" << std::endl;
+  asio::io_service io_service;
+  ServerSetting server_setting;
+  server_setting.mode = ServerMode::kPlay;
+  server_setting.max_games = 1;
+  MatchServer server(io_service, server_setting);
+  server.Start();
+
+  // a REQUEST_MATCH with nothing after the header, then the client hangs up
+  asio::io_service raw_service;
+  tcp::socket raw(raw_service);
+  raw.connect(tcp::endpoint(asio::ip::address_v4::loopback(), server.GetPort()));
+  unsigned char buffer[kMaxBufferLength];
+  std::size_t length = 0;
+  MakeRequestMatch(buffer, &length, 7, static_cast<unsigned char>(StrategyAttack::kRandom));
+  buffer[1] = 0;
+  asio::write(raw, asio::buffer(buffer, kHeaderLength));
+  raw.shutdown(tcp::socket::shutdown_send);
+
+  AsyncHostSetting setting;
+  setting.type = ClientType::kMatched;
+  setting.port = server.GetPort();
+  setting.cli_id = 1;
+  setting.games = 1;
+  setting.attack = StrategyAttack::kRandom;
+  AsyncGameHost host(io_service, setting);
+  host.Start();
+  AsyncGameHost::Run(io_service, 2);
+
+  ServerResult res = server.GetResult();
+  assert(res.matched == 1 && res.finished == 1 && res.broken_off == 0);
+  assert(host.GetResult().finished == 1);
+}
+
+// the next message on a blocking socket, of the type expected
+Frame read_frame(tcp::socket & socket, MessageType type){
+  Frame frame;
+  asio::read(socket, asio::buffer(frame.data, kHeaderLength));
+  frame.length = kHeaderLength + frame.data[1];
+  asio::read(socket, asio::buffer(frame.data + kHeaderLength, frame.length - kHeaderLength));
+  assert(frame.GetType() == type);
+  return frame;
+}
+
+void write_frame(tcp::socket & socket, const Frame & frame){
+  asio::write(socket, asio::buffer(frame.data, frame.length));
+}
+
+// a client on a blocking socket asks the server to play a game and talks up to its first move,
+// with roll as its roll. returns the game id.
+GameId start_raw_game(tcp::socket & socket, unsigned long roll){
+  Frame frame;
+  MakeRequestMatch(frame.data, &frame.length, 9, static_cast<unsigned char>(StrategyAttack::kRandom));
+  write_frame(socket, frame);
+  Frame match = read_frame(socket, MessageType::kInfoMatch);
+  GameId game_id = 0;
+  MessageType type;
+  std::size_t length = 0;
+  ResolveHeader(match.data, &type, &length, &game_id);
+
+  read_frame(socket, MessageType::kInfoGameId);
+  MakeInfoGameId(frame.data, &frame.length, MatchServer::kSecondClientId, game_id);
+  write_frame(socket, frame);
+  read_frame(socket, MessageType::kInfoReady);
+  MakeInfoReady(frame.data, &frame.length, MatchServer::kSecondClientId, game_id);
+  write_frame(socket, frame);
+  read_frame(socket, MessageType::kInfoRoll);
+  MakeInfoRoll(frame.data, &frame.length, MatchServer::kSecondClientId, game_id, roll);
+  write_frame(socket, frame);
+  return game_id;
+}
+
+// a client firing off the board, at a location twice or rolling the roll of the server breaks off
+// its game alone, the server goes on playing the next one on the connection
+void test_match_server_bad_peer(){
+  std::cout << "test_match_server_bad_peer" << std::endl;
+  asio::io_service io_service;
+  ServerSetting server_setting;
+  server_setting.mode = ServerMode::kPlay;
+  server_setting.max_games = 3;
+  MatchServer server(io_service, server_setting);
+  server.Start();
+  tcp::socket socket(io_service);
+  socket.connect(tcp::endpoint(asio::ip::address_v4::loopback(), server.GetPort()));
+  std::thread server_thread([&io_service](){
+    AsyncGameHost::Run(io_service, 2);
+  });
+
+  Frame frame;
+  GameId game_id = start_raw_game(socket, MatchServer::kSecondClientId);
+  MakeRequestAttack(frame.data, &frame.length, MatchServer::kSecondClientId, game_id, ClassicRules::kCellNum);
+  write_frame(socket, frame);
+
+  game_id = start_raw_game(socket, MatchServer::kSecondClientId);
+  MakeRequestAttack(frame.data, &frame.length, MatchServer::kSecondClientId, game_id, 5);
+  write_frame(socket, frame);
+  read_frame(socket, MessageType::kReplyAttack);
+  read_frame(socket, MessageType::kRequestAttack);
+  MakeReplyAttack(frame.data, &frame.length, game_id, false, kNotAShip, false);
+  write_frame(socket, frame);
+  MakeRequestAttack(frame.data, &frame.length, MatchServer::kSecondClientId, game_id, 5);
+  write_frame(socket, frame);
+
+  start_raw_game(socket, MatchServer::kFirstClientId);
+
+  // the server stops after the third game, the connection ends with the client leaving
+  while(server.GetResult().broken_off < 3){
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  socket.close();
+  server_thread.join();
+  ServerResult res = server.GetResult();
+  assert(res.matched == 3 && res.finished == 0 && res.broken_off == 3);
+}
+
+// a relayed client leaving breaks off the game of the other, which hears of it, and the game counts as over
+void test_match_server_relay_peer_gone(){
+  std::cout << "test_match_server_relay_peer_gone" << std::endl;
+  asio::io_service io_service;
+  ServerSetting server_setting;
+  server_setting.mode = ServerMode::kRelay;
+  server_setting.max_games = 1;
+  MatchServer server(io_service, server_setting);
+  server.Start();
+
+  tcp::socket socket(io_service);
+  socket.connect(tcp::endpoint(asio::ip::address_v4::loopback(), server.GetPort()));
+  Frame frame;
+  MakeRequestMatch(frame.data, &frame.length, 9, static_cast<unsigned char>(StrategyAttack::kRandom));
+  write_frame(socket, frame);
+
+  AsyncHostSetting setting;
+  setting.type = ClientType::kMatched;
+  setting.port = server.GetPort();
+  setting.cli_id = 1;
+  setting.games = 1;
+  setting.attack = StrategyAttack::kRandom;
+  AsyncGameHost host(io_service, setting);
+  host.Start();
+  std::thread server_thread([&io_service](){
+    AsyncGameHost::Run(io_service, 2);
+  });
+
+  read_frame(socket, MessageType::kInfoMatch);
+  socket.close();
+  server_thread.join();
+
+  ServerResult res = server.GetResult();
+  assert(res.matched == 1 && res.finished == 0 && res.broken_off == 1);
+  AsyncHostResult host_res = host.GetResult();
+  assert(host_res.finished == 0 && host_res.broken_off == 1);
+}
+
+int main(int argc, char** argv){
+  test_match_server_relay(1);
+  test_match_server_relay(300);
+  test_match_server_play(1, 1);
+  test_match_server_play(10, 20);
+  test_match_server_malformed();
+  test_match_server_bad_peer();
+  test_match_server_relay_peer_gone();
+  return 0;
+}
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <random>
+#include "ai/monte_carlo_sampler.h"
+#include "ai/attack_location_unit.h"
+#include "ai/ship_placement_unit.h"
+#include "core/game/board.h"
+
+// every sampled layout has to agree with the enemy board it was drawn for
+void check_layout(const FleetConstraint & constraint, const SampledLayout & layout){
+  assert(layout.ship_num == kShipNum);
+  size_t type_num[kShipTypeNum] = {};
+  size_t on_hits_num[kShipTypeNum] = {};
+  BitBoard occupied;
+  for(size_t s = 0; s < layout.ship_num; ++s){
+    assert(layout.masks[s].Count() == GetSizeFromType(layout.types[s]));
+    assert(!layout.masks[s].Intersects(occupied));
+    occupied |= layout.masks[s];
+    type_num[layout.types[s]] += 1;
+    if(!layout.masks[s].AndNot(constraint.hits).Any()) on_hits_num[layout.types[s]] += 1;
+  }
+  assert(occupied == layout.occupied);
+  assert(!occupied.Intersects(constraint.missed));
+  assert(!constraint.hits.AndNot(occupied).Any());
+  for(ShipType type : GetShipTypeList()){
+    assert(type_num[type] == GetNumFromType(type));
+    assert(on_hits_num[type] == constraint.sunk_num[type]);
+  }
+}
+
+void test_sampled_layouts_consistent(){
+  std::cout << "test_sampled_layouts_consistent" << std::endl;
+  std::mt19937 engine(20180601);
+  size_t positions = 0;
+  size_t accepted = 0;
+  size_t drawn = 0;
+  for(size_t g = 0; g < 20; ++g){
+    Board board;
+    ShipPlacementUnit placement_unit;
+    for(auto placement : placement_unit.ShipPlacingPlan(StrategyPlaceShip::kRandom)){
+      bool success = board.PlaceAShip(placement.type, placement.head_location, placement.direction);
+      assert(success);
+    }
+
+    ImagineBoard enemy_board;
+    size_t order[kDim * kDim];
+    RandomUnit::FillRandomSequence(order, kDim * kDim);
+    for(size_t i = 0; i < kDim * kDim; ++i){
+      AttackResult res = board.Attack(order[i]);
+      enemy_board.MarkAttack(res.location);
+      if(res.success){
+        enemy_board.MarkOccupied(res.location);
+        enemy_board.DestroyOneOnBoard(res.sink_ship_type);
+      }
+      enemy_board.UpdateLastAttackInfo(res);
+      if(res.attacker_win) break;
+
+      FleetConstraint constraint = FleetConstraint::FromEnemyBoard(enemy_board);
+      SampledLayout layout;
+      for(size_t k = 0; k < 20; ++k){
+        drawn += 1;
+        if(!MonteCarloSampler::SampleLayout(constraint, engine, &layout)) continue;
+        check_layout(constraint, layout);
+        accepted += 1;
+      }
+      positions += 1;
+    }
+  }
+  std::cout << positions << " positions, " << accepted << " of " << drawn << " draws accepted" << std::endl;
+  assert(accepted > 0);
+}
+
+// a Monte Carlo attacker only ever fires at un-attacked locations and always finishes a game
+void test_monte_carlo_attack_finishes(){
+  std::cout << "test_monte_carlo_attack_finishes" << std::endl;
+  for(size_t g = 0; g < 5; ++g){
+    Board board;
+    ShipPlacementUnit placement_unit;
+    for(auto placement : placement_unit.ShipPlacingPlan(StrategyPlaceShip::kRandom)){
+      bool success = board.PlaceAShip(placement.type, placement.head_location, placement.direction);
+      assert(success);
+    }
+
+    ImagineBoard enemy_board;
+    AttackLocationUnit attack_unit(enemy_board);
+    size_t moves = 0;
+    while(true){
+      size_t location = attack_unit.NextAttackLocation(StrategyAttack::kMonteCarlo);
+      assert(location < kDim * kDim);
+      assert(!enemy_board.LocationAttacked(location));
+      AttackResult res = board.Attack(location);
+      enemy_board.MarkAttack(res.location);
+      if(res.success){
+        enemy_board.MarkOccupied(res.location);
+        enemy_board.DestroyOneOnBoard(res.sink_ship_type);
+      }
+      enemy_board.UpdateLastAttackInfo(res);
+      attack_unit.UpdateProbabilityBoard();
+      moves += 1;
+      if(res.attacker_win) break;
+    }
+    std::cout << "won in " << moves << " moves" << std::endl;
+  }
+}
+
+int main(int argc, char** argv){
+  test_sampled_layouts_consistent();
+  test_monte_carlo_attack_finishes();
+  return 0;
+}
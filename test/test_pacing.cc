@@ -0,0 +1,62 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "client/pacing.h"
+
+static double time_turns(Pacer & pacer, size_t turns){
+  auto start = std::chrono::steady_clock::now();
+  for(size_t i = 0; i < turns; ++i){
+    pacer.WaitForTurn();
+  }
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// an unpaced client doesn't wait, a fixed one waits its delay every move
+void test_pacing_unpaced_and_fixed(){
+  std::cout << "test_pacing_unpaced_and_fixed" << std::endl;
+  PacingSetting setting;
+  setting.mode = PacingMode::kUnpaced;
+  Pacer unpaced(setting);
+  double unpaced_ms = time_turns(unpaced, 100000);
+  std::cerr << "100000 unpaced turns in " << unpaced_ms << "ms" << std::endl;
+  assert(unpaced_ms < 100);
+
+  setting.mode = PacingMode::kFixed;
+  setting.delay_ms = 10;
+  Pacer fixed(setting);
+  double fixed_ms = time_turns(fixed, 5);
+  assert(fixed_ms >= 50);
+}
+
+// a vsync client moves on every frame presented, and on its own if no frame comes
+void test_pacing_vsync(){
+  std::cout << "test_pacing_vsync" << std::endl;
+  PacingSetting setting;
+  setting.mode = PacingMode::kVsync;
+  Pacer pacer(setting);
+
+  // no ui, every turn waits the timeout out
+  double alone_ms = time_turns(pacer, 2);
+  assert(alone_ms >= 2 * Pacer::kFrameTimeoutMs);
+
+  // a fast ui, every turn takes about a frame
+  std::atomic<bool> stop(false);
+  std::thread ui([&pacer, &stop](){
+    while(!stop){
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      pacer.OnFrame();
+    }
+  });
+  double framed_ms = time_turns(pacer, 50);
+  stop = true;
+  ui.join();
+  std::cerr << "50 turns at a frame every 2ms in " << framed_ms << "ms" << std::endl;
+  assert(framed_ms < 50 * Pacer::kFrameTimeoutMs / 2);
+}
+
+int main(int argc, char** argv){
+  test_pacing_unpaced_and_fixed();
+  test_pacing_vsync();
+  return 0;
+}
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <cstring>
+#include <chrono>
+#include <memory>
+#include "ai/probability_board.h"
+#include "ai/ship_placement_unit.h"
+#include "core/game/board.h"
+#include "test_games.h"
+
+// the table kernel (simd and scalar) has to give exactly what the one-by-one loop gives
+void test_recalculate_probability_bit_identical(){
+  std::cout << "test_recalculate_probability_bit_identical" << std::endl;
+  size_t checked = 0;
+  play_random_games(50, [&checked](ImagineBoard & enemy_board){
+    ProbabilityBoard kernel_board(enemy_board);
+    ProbabilityBoard naive_board(enemy_board);
+    kernel_board.RecalculateProbability();
+    naive_board.RecalculateProbabilityNaive();
+
+    size_t alive_num[kShipTypeNum];
+    for(ShipType type : GetShipTypeList()){
+      alive_num[type] = enemy_board.GetAliveShipNumber(type);
+    }
+    size_t scalar[kDim * kDim];
+    size_t simd[kDim * kDim];
+    ProbabilityKernel::AccumulateScalar(enemy_board.GetMissedMask(), alive_num, scalar);
+    ProbabilityKernel::AccumulateSimd(enemy_board.GetMissedMask(), alive_num, simd);
+
+    for(size_t i = 0; i < kDim * kDim; ++i){
+      assert(kernel_board.GetProbability(i) == naive_board.GetProbability(i));
+      assert(scalar[i] == simd[i]);
+      if(!enemy_board.LocationAttacked(i)){
+        assert(scalar[i] == naive_board.GetProbability(i));
+      }
+    }
+    checked += 1;
+  });
+  std::cout << checked << " positions identical" << std::endl;
+}
+
+// what AI_DEBUG used to check in AttackLocationUnit: one board only ever updated
+// incrementally, shot after shot, has to match a full recalculation of every position
+void test_incremental_update_matches_recalculation(){
+  std::cout << "test_incremental_update_matches_recalculation" << std::endl;
+  size_t checked = 0;
+  std::unique_ptr<ProbabilityBoard> up_incremental;
+  play_random_games(50, [&up_incremental](ImagineBoard & enemy_board){
+    up_incremental.reset(new ProbabilityBoard(enemy_board));
+  }, [&up_incremental, &checked](ImagineBoard & enemy_board){
+    up_incremental->UpdateProbabilityByLastAttackLocation();
+    ProbabilityBoard full_board(enemy_board);
+    for(size_t i = 0; i < kDim * kDim; ++i){
+      assert(up_incremental->GetProbability(i) == full_board.GetProbability(i));
+    }
+    checked += 1;
+  });
+  std::cout << checked << " positions identical" << std::endl;
+}
+
+// the placement-by-placement loop RecalculateProbabilityNaive() runs
+void accumulate_naive(ImagineBoard & enemy_board, size_t* probability){
+  std::memset(probability, 0, sizeof(size_t) * kDim * kDim);
+  for(ShipType type : GetShipTypeList()){
+    size_t alive_num = enemy_board.GetAliveShipNumber(type);
+    if(alive_num == 0) continue;
+    for(size_t i = 0; i < kDim * kDim; ++i){
+      if(enemy_board.DoesShipFit(type, i, Direction::kVertical)){
+        for(size_t j = 0; j < GetSizeFromType(type); ++j) probability[i + j * kDim] += alive_num;
+      }
+      if(enemy_board.DoesShipFit(type, i, Direction::kHorisontal)){
+        for(size_t j = 0; j < GetSizeFromType(type); ++j) probability[i + j] += alive_num;
+      }
+    }
+  }
+}
+
+template<typename F>
+double time_accumulate(std::vector<ImagineBoard> & positions, size_t* checksum, F accumulate){
+  const size_t kRounds = 50;
+  size_t probability[kDim * kDim];
+  auto start = std::chrono::high_resolution_clock::now();
+  for(size_t r = 0; r < kRounds; ++r){
+    for(ImagineBoard & position : positions){
+      accumulate(position, probability);
+      *checksum += probability[r % (kDim * kDim)];
+    }
+  }
+  auto time_elapsed = std::chrono::high_resolution_clock::now() - start;
+  return std::chrono::duration_cast<std::chrono::duration<double>>(time_elapsed).count();
+}
+
+void test_recalculate_probability_speed(){
+  std::cout << "test_recalculate_probability_speed" << std::endl;
+  std::vector<ImagineBoard> positions;
+  play_random_games(20, [&positions](ImagineBoard & enemy_board){
+    positions.push_back(enemy_board);
+  });
+
+  size_t naive_sum = 0;
+  size_t scalar_sum = 0;
+  size_t simd_sum = 0;
+  double naive_s = time_accumulate(positions, &naive_sum, accumulate_naive);
+  double scalar_s = time_accumulate(positions, &scalar_sum, [](ImagineBoard & position, size_t* probability){
+    size_t alive_num[kShipTypeNum];
+    for(ShipType type : GetShipTypeList()) alive_num[type] = position.GetAliveShipNumber(type);
+    ProbabilityKernel::AccumulateScalar(position.GetMissedMask(), alive_num, probability);
+  });
+  double simd_s = time_accumulate(positions, &simd_sum, [](ImagineBoard & position, size_t* probability){
+    size_t alive_num[kShipTypeNum];
+    for(ShipType type : GetShipTypeList()) alive_num[type] = position.GetAliveShipNumber(type);
+    ProbabilityKernel::AccumulateSimd(position.GetMissedMask(), alive_num, probability);
+  });
+  assert(naive_sum == scalar_sum && naive_sum == simd_sum);
+
+  std::cout << positions.size() << " positions x 50 rounds" << std::endl
+            << "naive  completed in " << naive_s << "s." << std::endl
+            << "scalar completed in " << scalar_s << "s. (" << naive_s / scalar_s << "x)" << std::endl
+            << "simd   completed in " << simd_s << "s. (" << naive_s / simd_s << "x)" << std::endl;
+}
+
+int main(int argc, char** argv){
+  test_recalculate_probability_bit_identical();
+  test_incremental_update_matches_recalculation();
+  test_recalculate_probability_speed();
+  return 0;
+}
@@ -0,0 +1,25 @@
+//
+// Recorded headless games for the tests of the records and their replays.
+//
+
+#ifndef BATTLESHIP_TEST_RECORDS_H
+#define BATTLESHIP_TEST_RECORDS_H
+
+#include <cstdint>
+#include "simulation/headless_match.h"
+
+// play a game of player a against player b, seeded with seed if seeded, and return its record
+template<typename Rules>
+BasicGameRecord<Rules> play_recorded(GameId game_id, const PlayerSetting & a, const PlayerSetting & b,
+                                     bool seeded, std::uint64_t seed){
+  BasicGameRecord<Rules> record;
+  BasicHeadlessMatch<Rules> match(a, b, game_id);
+  if(seeded) match.SetSeed(seed);
+  match.SetRecord(&record);
+  MatchResult res = match.Play();
+  assert(record.winner == (res.does_win[0] ? 0 : 1));
+  assert(record.moves.size() == res.num_moves[0] + res.num_moves[1]);
+  return record;
+}
+
+#endif //BATTLESHIP_TEST_RECORDS_H
@@ -0,0 +1,101 @@
+#include <iostream>
+#include "ai/probability_board.h"
+#include "ai/ship_placement_unit.h"
+#include "core/game/board.h"
+#include "simulation/headless_match.h"
+#include "simulation/tournament.h"
+
+// on random games of the rules, the kernel matches the naive count and
+// the incremental update (endgame solver on) matches a full recalculation
+template<typename Rules>
+void test_rules_probability(const char* name, size_t games){
+  std::cout << "test_rules_probability " << name << std::endl;
+  size_t checked = 0;
+  for(size_t g = 0; g < games; ++g){
+    BasicBoard<Rules> board;
+    BasicShipPlacementUnit<Rules> placement_unit;
+    for(auto placement : placement_unit.ShipPlacingPlan(StrategyPlaceShip::kRandom)){
+      bool success = board.PlaceAShip(placement.type, placement.head_location, placement.direction);
+      assert(success);
+    }
+
+    BasicImagineBoard<Rules> enemy_board;
+    BasicProbabilityBoard<Rules> incremental(enemy_board);
+    incremental.EnableEndgameSolver(EndgameSetting());
+    size_t order[Rules::kCellNum];
+    RandomUnit::FillRandomSequence(order, Rules::kCellNum);
+    for(size_t i = 0; i < Rules::kCellNum; ++i){
+      AttackResult res = board.Attack(order[i]);
+      enemy_board.MarkAttack(res.location);
+      if(res.success){
+        enemy_board.MarkOccupied(res.location);
+        enemy_board.DestroyOneOnBoard(res.sink_ship_type);
+      }
+      enemy_board.UpdateLastAttackInfo(res);
+      if(res.attacker_win) break;
+
+      BasicProbabilityBoard<Rules> naive(enemy_board);
+      naive.RecalculateProbabilityNaive();
+      BasicProbabilityBoard<Rules> full(enemy_board);
+      full.RecalculateProbability();
+      for(size_t j = 0; j < Rules::kCellNum; ++j){
+        assert(naive.GetProbability(j) == full.GetProbability(j));
+      }
+
+      incremental.UpdateProbabilityByLastAttackLocation();
+      full.EnableEndgameSolver(EndgameSetting());
+      full.RecalculateProbability();
+      for(size_t j = 0; j < Rules::kCellNum; ++j){
+        assert(incremental.GetProbability(j) == full.GetProbability(j));
+      }
+      checked += 1;
+    }
+  }
+  std::cout << checked << " positions identical" << std::endl;
+}
+
+// every attack strategy finishes its games on the rules
+template<typename Rules>
+void test_rules_matches(const char* name, size_t games){
+  std::cout << "test_rules_matches " << name << std::endl;
+  for(StrategyAttack attack : kTournamentAttackList){
+    size_t moves = 0;
+    for(size_t g = 0; g < games; ++g){
+      PlayerSetting challenger(1, attack, StrategyPlaceShip::kRandom);
+      PlayerSetting defender(0, StrategyAttack::kRandom, StrategyPlaceShip::kRandom);
+      BasicHeadlessMatch<Rules> match(challenger, defender, static_cast<GameId>(g));
+      MatchResult res = match.Play();
+      assert(res.does_win[0] != res.does_win[1]);
+      assert(res.num_moves[0] <= Rules::kCellNum);
+      moves += res.num_moves[0];
+    }
+    std::cout << StrategyAttackToString(attack) << ": " << static_cast<double>(moves) / games
+              << " moves per game" << std::endl;
+  }
+}
+
+// the neighbours dfs stacks come left, right, up, down, none off the board or from another row
+template<typename Rules>
+void test_rules_neighbours(const char* name){
+  std::cout << "test_rules_neighbours " << name << std::endl;
+  const size_t dim = Rules::kDim;
+  BasicImagineBoard<Rules> enemy_board;
+  FixedVector<size_t, 4> inside = enemy_board.GetSurroundingFourUnAttacked(dim + 1);
+  assert(inside.size() == 4 && inside[0] == dim && inside[1] == dim + 2 && inside[2] == 1 && inside[3] == 2 * dim + 1);
+  FixedVector<size_t, 4> corner = enemy_board.GetSurroundingFourUnAttacked(dim);
+  assert(corner.size() == 3 && corner[0] == dim + 1 && corner[1] == 0 && corner[2] == 2 * dim);
+  enemy_board.MarkAttack(dim + 2);
+  FixedVector<size_t, 4> attacked = enemy_board.GetSurroundingFourUnAttacked(dim + 1);
+  assert(attacked.size() == 3 && attacked[0] == dim && attacked[1] == 1 && attacked[2] == 2 * dim + 1);
+}
+
+int main(int argc, char** argv){
+  test_rules_neighbours<ClassicRules>("classic");
+  test_rules_neighbours<HugeRules>("huge");
+  test_rules_probability<ClassicRules>("classic", 5);
+  test_rules_probability<LargeRules>("large", 5);
+  test_rules_probability<HugeRules>("huge", 3);
+  test_rules_matches<LargeRules>("large", 5);
+  test_rules_matches<HugeRules>("huge", 3);
+  return 0;
+}
@@ -1,5 +1,7 @@
+#include <bitset>
+#include <cstdint>
 #include <iostream>
-#include "core/networking.h"
+#include "core/networking/messages.h"
 #include "test_timer.h"
 
 void test_serialization_general(){
@@ -7,19 +9,140 @@ void test_serialization_general(){
   GameId game_id = 654321;
   unsigned char request[kMaxBufferLength];
   std::size_t length;
-  MakeRequestJoinGame(request, &length, cli_id, game_id);
+  MakeInfoGameId(request, &length, cli_id, game_id);
 
   ClientId new_cli_id = 0;
   GameId new_game_id = 0;
-  ResolveRequestJoinGame(request + 2, length - 2, &new_cli_id, &new_game_id);
+  unsigned char version = 0;
+  ResolveInfoGameId(request + kHeaderLength, length - kHeaderLength, &new_cli_id, &new_game_id, &version);
 
   std::cout << "cli_id: " << cli_id << " >> " << new_cli_id << std::endl
             << "game_id: " << game_id << " >> " << new_game_id << std::endl;
 
   assert(cli_id == new_cli_id);
   assert(game_id == new_game_id);
+  assert(version == kWireVersion);
+}
+
+// the bytes on the wire are the same on every host: little endian, a location as a varint
+void test_serialization_wire_format(){
+  unsigned char buffer[kMaxBufferLength];
+  std::size_t length = 0;
+  MakeRequestAttack(buffer, &length, 0x01020304, 0x0A0B0C0D, 300);
+  const unsigned char expected[] = {
+    static_cast<unsigned char>(MessageType::kRequestAttack), 10, 0x0D, 0x0C, 0x0B, 0x0A,
+    0x04, 0x03, 0x02, 0x01,
+    0x0D, 0x0C, 0x0B, 0x0A,
+    0xAC, 0x02
+  };
+  assert(length == sizeof(expected));
+  assert(std::memcmp(buffer, expected, length) == 0);
+
+  MessageType type;
+  std::size_t body_length = 0;
+  GameId game_id = 0;
+  ResolveHeader(buffer, &type, &body_length, &game_id);
+  assert(type == MessageType::kRequestAttack && body_length == length - kHeaderLength && game_id == 0x0A0B0C0D);
+
+  ClientId cli_id = 0;
+  std::size_t location = 0;
+  ResolveRequestAttack(buffer + kHeaderLength, body_length, &cli_id, &game_id, &location);
+  assert(cli_id == 0x01020304 && game_id == 0x0A0B0C0D && location == 300);
+
+  // the varint round trips at the edges of its bytes
+  const std::uint64_t values[] = {0, 1, 127, 128, 16383, 16384, 0xFFFFFFFF, 0xFFFFFFFFFFFFFFFF};
+  for(std::uint64_t value : values){
+    ByteWriter writer(buffer, 0);
+    writer.Put<VarintField>(value);
+    std::uint64_t read = 0;
+    ByteReader reader(buffer, writer.GetOffset());
+    reader.Get<VarintField>(&read);
+    assert(read == value);
+  }
+
+  unsigned long roll = 0;
+  MakeInfoRoll(buffer, &length, 1, 2, 99);
+  ResolveInfoRoll(buffer + kHeaderLength, length - kHeaderLength, &cli_id, &game_id, &roll);
+  assert(roll == 99);
+
+  bool success = false;
+  ShipType ship = kNotAShip;
+  bool attacker_win = false;
+  MakeReplyAttack(buffer, &length, 2, true, kDestroyer, true);
+  assert(length == kHeaderLength + 3);
+  ResolveReplyAttack(buffer + kHeaderLength, length - kHeaderLength, &success, &ship, &attacker_win);
+  assert(success && ship == kDestroyer && attacker_win);
+}
+
+// a message cut anywhere doesn't resolve, it comes from the peer and may be anything
+void test_serialization_malformed(){
+  unsigned char buffer[kMaxBufferLength];
+  std::size_t length = 0;
+  ClientId cli_id = 0;
+  GameId game_id = 0;
+  std::size_t location = 0;
+  MakeRequestAttack(buffer, &length, 1, 2, 300);
+  for(std::size_t cut = 0; cut < length - kHeaderLength; ++cut){
+    bool resolved = ResolveRequestAttack(buffer + kHeaderLength, cut, &cli_id, &game_id, &location);
+    assert(!resolved);
+  }
+  bool resolved = ResolveRequestAttack(buffer + kHeaderLength, length - kHeaderLength, &cli_id, &game_id, &location);
+  assert(resolved && cli_id == 1 && game_id == 2 && location == 300);
+
+  unsigned char strategy = 0;
+  MakeRequestMatch(buffer, &length, 1, 3);
+  resolved = ResolveRequestMatch(buffer + kHeaderLength, 0, &cli_id, &strategy);
+  assert(!resolved);
+  resolved = ResolveRequestMatch(buffer + kHeaderLength, length - kHeaderLength - 1, &cli_id, &strategy);
+  assert(!resolved);
+
+  // a varint never ending, or running past 64 bits
+  std::uint64_t value = 0;
+  const unsigned char unterminated[] = {0x80, 0x80, 0x80};
+  ByteReader unterminated_reader(unterminated, sizeof(unterminated));
+  bool got = unterminated_reader.Get<VarintField>(&value);
+  assert(!got);
+  const unsigned char too_long[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02};
+  ByteReader too_long_reader(too_long, sizeof(too_long));
+  got = too_long_reader.Get<VarintField>(&value);
+  assert(!got);
+  const unsigned char eleven[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x81, 0x00};
+  ByteReader eleven_reader(eleven, sizeof(eleven));
+  got = eleven_reader.Get<VarintField>(&value);
+  assert(!got);
+}
 
+// whole messages through the schemas, to hold against the raw timings below
+void test_serialization_messages(){
+  std::size_t times = 1000000;
+  unsigned char buf[kMaxBufferLength];
+  std::size_t length = 0;
+  std::size_t sum = 0;
+
+  {
+    std::string name = "MakeRequestAttack";
+    TestTimer timer(name);
+    for(std::size_t t = 0; t < times; t++){
+      MakeRequestAttack(buf, &length, 1, static_cast<GameId>(t), t % 100);
+      sum += buf[length - 1];
+    }
+  }
+  std::cout << "request attack is " << length << " bytes, " << kHeaderLength + 4 + 4 + sizeof(std::size_t) << " with a size_t location" << std::endl;
 
+  {
+    std::string name = "ResolveRequestAttack";
+    TestTimer timer(name);
+    for(std::size_t t = 0; t < times; t++){
+      ClientId cli_id = 0;
+      GameId game_id = 0;
+      std::size_t location = 0;
+      buf[kHeaderLength + 8] = static_cast<unsigned char>(t % 100);
+      ResolveRequestAttack(buf + kHeaderLength, length - kHeaderLength, &cli_id, &game_id, &location);
+      sum += location;
+    }
+  }
+  // keeps the loops from being optimized away
+  std::cout << "checksum " << sum << std::endl;
 }
 
 // memcpy implementation 5x faster than bit manipulation implementation for both
@@ -102,6 +225,9 @@ void test_serialization_impl(){
 
 int main(int argc, char** argv){
   test_serialization_general();
+  test_serialization_wire_format();
+  test_serialization_malformed();
+  test_serialization_messages();
   //test_serialization_impl();
   return 0;
 }
@@ -21,6 +21,6 @@ public:
       << std::endl;
   }
 private:
-  const std::string & name_;
+  const std::string name_;
   const std::chrono::time_point<std::chrono::high_resolution_clock> start_;
 };
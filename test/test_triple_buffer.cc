@@ -0,0 +1,96 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "client/game_snapshot.h"
+#include "utils/triple_buffer.h"
+
+// big enough that a torn copy would show
+struct Numbered{
+  size_t values[64] = {};
+};
+
+// the reader only ever sees whole values, each newer than the one before
+void test_triple_buffer_threads(size_t publishes){
+  std::cout << "test_triple_buffer_threads " << publishes << std::endl;
+  TripleBuffer<Numbered> buffer;
+  std::atomic<bool> done(false);
+
+  std::thread writer([&buffer, &done, publishes](){
+    for(size_t n = 1; n <= publishes; ++n){
+      Numbered & back = buffer.GetBack();
+      for(size_t & value : back.values){
+        value = n;
+      }
+      buffer.Publish();
+    }
+    done = true;
+  });
+
+  size_t last = 0;
+  size_t updates = 0;
+  while(true){
+    bool was_done = done;
+    if(buffer.Update()){
+      const Numbered & front = buffer.GetFront();
+      for(size_t value : front.values){
+        assert(value == front.values[0]);
+      }
+      assert(front.values[0] > last);
+      last = front.values[0];
+      updates += 1;
+    }
+    // everything published before done is taken by the update after it
+    if(was_done) break;
+  }
+  writer.join();
+  assert(last == publishes);
+  std::cerr << updates << " of " << publishes << " values seen" << std::endl;
+}
+
+// the ui keeps what it has until the game publishes again
+void test_triple_buffer_no_update(){
+  std::cout << "test_triple_buffer_no_update" << std::endl;
+  TripleBuffer<Numbered> buffer;
+  bool updated = buffer.Update();
+  assert(!updated);
+  buffer.GetBack().values[0] = 1;
+  buffer.Publish();
+  buffer.GetBack().values[0] = 2;
+  buffer.Publish();
+  updated = buffer.Update();
+  assert(updated && buffer.GetFront().values[0] == 2);
+  updated = buffer.Update();
+  assert(!updated && buffer.GetFront().values[0] == 2);
+}
+
+// a snapshot taken from the boards says what they say
+void test_game_snapshot_capture(){
+  std::cout << "test_game_snapshot_capture" << std::endl;
+  Board my_board;
+  ImagineBoard enemy_board;
+  ProbabilityBoard probability_board(enemy_board);
+  my_board.PlaceAShip(ShipType::kCruiser, 0, Direction::kHorisontal);
+  my_board.Attack(0);
+  my_board.IncrementOneMove();
+  enemy_board.MarkAttack(5);
+
+  GameSnapshotBuffer snapshots;
+  snapshots.GetBack().Capture(my_board, enemy_board, probability_board);
+  snapshots.Publish();
+  bool updated = snapshots.Update();
+  assert(updated);
+  const GameSnapshot & snapshot = snapshots.GetFront();
+  assert(snapshot.my.states[0] == (GameSnapshot::kOccupied | GameSnapshot::kAttacked));
+  assert(snapshot.my.states[1] == GameSnapshot::kOccupied);
+  assert(snapshot.enemy.states[5] == GameSnapshot::kAttacked);
+  assert(snapshot.my.ships.size() == 1 && snapshot.my.cruiser_num == 1 && snapshot.my.move_num == 1);
+  assert(snapshot.enemy.carrier_num == ClassicRules::kCarrierNum);
+}
+
+int main(int argc, char** argv){
+  test_triple_buffer_no_update();
+  test_game_snapshot_capture();
+  test_triple_buffer_threads(1000000);
+  return 0;
+}